@@ -6,33 +6,90 @@
 */
 
 
+#include <avr/pgmspace.h>
 #include "system.h"
-#include "ir_uart.h"
 #include "tinygl.h"
 #include "paddle.h"
+#include "fixed.h"
+#include "packet.h"
+#include "link.h"
+#include "render.h"
+#include "geometry.h"
+#include "ball.h"
+
+
+// Speeds in pixels per second, converted to fixed-point pixels per update.
+// The bounce rules can be overridden to try them in host/monte_carlo.c.
+#ifndef BALL_INITIAL_PPS
+#define BALL_INITIAL_PPS 3
+#endif
+#ifndef BALL_MAX_PPS
+#define BALL_MAX_PPS 12
+#endif
+#ifndef BALL_SPEED_UP_SHIFT
+#define BALL_SPEED_UP_SHIFT 3 // Each paddle hit adds 1/8 to the speed
+#endif
+#define BALL_INITIAL_SPEED FIXED_PER_TICK(BALL_INITIAL_PPS, BALL_UPDATE_RATE)
+#define BALL_MAX_SPEED FIXED_PER_TICK(BALL_MAX_PPS, BALL_UPDATE_RATE)
+
+// Updates a hand-off takes to arrive: an 11 byte frame at 2400 baud is
+// 2.3 updates, and the receiving game task moves the ball on again at
+// its next update
+#define BALL_TRANSIT_UPDATES 2
+
+
+
+// Limits of the ball's centre in fixed-point
+#define CONTACT_X FIXED_FROM_INT(ONE_FROM_GOAL)
+#define SCORED_X FIXED_FROM_INT(GOAL_X)
+#define CROSSING_X (FIXED_FROM_INT(BORDER_X) - FIXED_HALF)
+#define FAR_CROSSING_X (FIXED_FROM_INT(GOAL_X) + FIXED_HALF) // Of the far border, see ball_far_border_set()
+#define GRID_LENGTH FIXED_FROM_INT(GRID_WIDTH) // Distance a ball moves on to the next board in a ring
+#define TOP_Y FIXED_FROM_INT(TOP_WALL_Y)
+#define BOTTOM_Y FIXED_FROM_INT(BOTTOM_WALL_Y)
+
+// Distance over which bouncing between the walls repeats, and its
+// reciprocal scaled by 2^16, so a flight can be folded back between the
+// walls without dividing; the AVR has no divide instruction
+#define WALL_PERIOD (2 * (TOP_Y - BOTTOM_Y))
+#define WALL_PERIOD_RECIPROCAL (65536L / WALL_PERIOD)
+
+#if BALL_MAX_PPS * FIXED_ONE / BALL_UPDATE_RATE >= BALL_SPEED_BACK
+#error "BALL_MAX_SPEED is too fast to send beside BALL_SPEED_BACK"
+#endif
+
+// Reciprocals of the speeds, 65535 / speed, worked out by the compiler
+// for ball_intercept() and kept in flash. Every speed is below
+// BALL_SPEED_BACK, so 128 of them cover any BALL_MAX_PPS.
+#define SPEED_RECIPROCALS_NUM 128
+#define SPEED_RECIPROCAL(SPEED) ((SPEED) ? UINT16_MAX / (SPEED) : 0)
+#define SPEED_RECIPROCALS_4(SPEED) SPEED_RECIPROCAL(SPEED), SPEED_RECIPROCAL((SPEED) + 1), \
+    SPEED_RECIPROCAL((SPEED) + 2), SPEED_RECIPROCAL((SPEED) + 3)
+#define SPEED_RECIPROCALS_16(SPEED) SPEED_RECIPROCALS_4(SPEED), SPEED_RECIPROCALS_4((SPEED) + 4), \
+    SPEED_RECIPROCALS_4((SPEED) + 8), SPEED_RECIPROCALS_4((SPEED) + 12)
+#define SPEED_RECIPROCALS_64(SPEED) SPEED_RECIPROCALS_16(SPEED), SPEED_RECIPROCALS_16((SPEED) + 16), \
+    SPEED_RECIPROCALS_16((SPEED) + 32), SPEED_RECIPROCALS_16((SPEED) + 48)
+
+#if SPEED_RECIPROCALS_NUM < BALL_SPEED_BACK
+#error "The table of speed reciprocals doesn't cover every speed"
+#endif
+
+
+// The balls in play, a struct of arrays indexed by ball id so the balls
+// can be updated in one pass over each array
+static fixed_t ball_x[BALL_POOL_SIZE]; // Fixed-point x position, increasing towards the paddle
+static fixed_t ball_y[BALL_POOL_SIZE]; // Fixed-point y position, increasing towards the top
+static fixed_t ball_vel_x[BALL_POOL_SIZE]; // Fixed-point x velocity in pixels per update
+static fixed_t ball_vel_y[BALL_POOL_SIZE]; // Fixed-point y velocity in pixels per update
+static uint8_t far_border; // True if balls pass the goal to another board, see ball_far_border_set()
+
+static const uint16_t speed_reciprocals[SPEED_RECIPROCALS_NUM] PROGMEM =
+{
+    SPEED_RECIPROCALS_64(0), SPEED_RECIPROCALS_64(64)
+};
 
 
-#define INITIAL_BALL_X_POS 0
-#define INITIAL_BALL_Y_POS 3
-
-#define X_TOWARDS_PADDLE -1
-#define X_AWAY_FROM_PADDLE 1
-#define Y_TOWARDS_TOP 1
-#define Y_STRAIGHT 0
-#define Y_TOWARDS_BOTTOM -1
-
-
-#define GOAL_X 4
-#define ONE_FROM_GOAL 3
-
-#define BORDER_X 0
-#define TOP_WALL_Y 6
-#define BOTTOM_WALL_Y 0
-
-
-static int ball_dir_x; // Int for the balls x direction
-static int ball_dir_y; // Int for the balls y direction
-static tinygl_point_t ball; // Tinygl_point_t for the ball (its x and y co-ords)
+static int ball_arriving(uint8_t id);
 
 
 /*
@@ -40,32 +97,82 @@ static tinygl_point_t ball; // Tinygl_point_t for the ball (its x and y co-ords)
  * --------------------
  * Initialization of the balls position and directon
  *
+ * uint8_t id: Ball to set
  * int x: x-coordinate to be set
  * int y: y-coordinate to be set
  *
 */
-void set_ball_position(int x, int y)
+void set_ball_position(uint8_t id, int x, int y)
 {
-    ball.x = x;
-    ball.y = y;
-    //The balls x direction is initially towards the starting player
-    ball_dir_x = X_TOWARDS_PADDLE;
+    ball_x[id] = FIXED_FROM_INT(x);
+    ball_y[id] = FIXED_FROM_INT(y);
+    //The ball initially travels towards the starting player
+    ball_vel_x[id] = BALL_INITIAL_SPEED;
     //The ball is initially travelling a straight line
-    ball_dir_y = Y_STRAIGHT;
+    ball_vel_y[id] = 0;
+    render_ball(id, get_ball(id));
+}
+
+
+/*
+ * Function: get_ball_state
+ * --------------------
+ * Getter for the exact position and velocity of a ball
+ *
+ * uint8_t id: Ball to get
+ * ball_state_t *state: Filled in with the ball's state
+ *
+*/
+void get_ball_state(uint8_t id, ball_state_t *state)
+{
+    state->x = ball_x[id];
+    state->y = ball_y[id];
+    state->vel_x = ball_vel_x[id];
+    state->vel_y = ball_vel_y[id];
+}
+
+
+/*
+ * Function: set_ball_state
+ * --------------------
+ * Puts a ball back to a state from get_ball_state()
+ *
+ * uint8_t id: Ball to set
+ * const ball_state_t *state: State to restore
+ *
+*/
+void set_ball_state(uint8_t id, const ball_state_t *state)
+{
+    ball_x[id] = state->x;
+    ball_y[id] = state->y;
+    ball_vel_x[id] = state->vel_x;
+    ball_vel_y[id] = state->vel_y;
+    render_ball(id, get_ball(id));
 }
 
 
 /*
  * Function: get_ball
  * --------------------
- * Getter for the ball
+ * Getter for a ball, rasterising its sub-pixel position onto the
+ * nearest LED of the grid
+ *
+ * uint8_t id: Ball to get
  *
  * Returns: a tinygl_point struct for the ball, holding the balls x
  * and y co-ordinates
  *
 */
-struct tinygl_point get_ball(void)
+struct tinygl_point get_ball(uint8_t id)
 {
+    tinygl_point_t ball;
+    int x = FIXED_TO_INT(ball_x[id]);
+    int y = FIXED_TO_INT(ball_y[id]);
+
+    // The ball can be up to half a pixel past the edge of the grid
+    // before it crosses the border or scores, so keep it on the grid
+    ball.x = x < BORDER_X ? BORDER_X : (x > GOAL_X ? GOAL_X : x);
+    ball.y = y < BOTTOM_WALL_Y ? BOTTOM_WALL_Y : (y > TOP_WALL_Y ? TOP_WALL_Y : y);
     return ball;
 }
 
@@ -73,111 +180,400 @@ struct tinygl_point get_ball(void)
 /*
  * Function: send_ball_position
  * --------------------
- * Sends the position of the ball to the other player when the border
- * has been crossed via ir_uart serial communications
+ * Sends the trajectory of a ball to the other player as soon as it
+ * has been hit back, as a PACKET_BALL packet. The position is given in
+ * the other player's co-ordinates, where the ball is still behind the
+ * border, so they can follow it in from their own clock.
+ *
+ * uint8_t id: Ball to send
+ * int their_score: The score for the other player to be sent
+ */
+void send_ball_position(uint8_t id, int their_score)
+{
+    ball_state_t state;
+    uint8_t payload[BALL_PAYLOAD_MAX];
+    uint8_t length;
+
+    get_ball_state(id, &state);
+    length = ball_pack(&state, id, their_score, payload);
+    link_send(PACKET_BALL, payload, length);
+}
+
+
+/*
+ * Function: send_ball_to
+ * --------------------
+ * Sends the trajectory of a ball to a board in a ring, as
+ * send_ball_position() does, in that board's co-ordinates
  *
- * uint8_t their_score: The score for the other player to be sent
+ * uint8_t id: Ball to send
+ * int their_score: The score to be sent with it
+ * uint8_t handoff: BALL_FACING, BALL_BEHIND or BALL_AHEAD
+ * uint8_t address: PACKET_ADDRESS() of this board and the board to
+ * send to
  */
-void send_ball_position(uint8_t their_score)
+void send_ball_to(uint8_t id, int their_score, uint8_t handoff, uint8_t address)
 {
-    int dir_y_to_send = -ball_dir_y;
-    // Compresses y_pos and score into a single transmission, to reduce
-    // the load on the ir transmitter using bitshifting
-    uint8_t y_pos_and_score_to_send = (TOP_WALL_Y - ball.y ) << 4;
-    y_pos_and_score_to_send = (0b00001111 & their_score) | y_pos_and_score_to_send;
-    //Send 8bit number representing y_pos and score
-    ir_uart_putc(y_pos_and_score_to_send);
-    //Send y direction to other player
-    ir_uart_putc(dir_y_to_send);
+    ball_state_t state;
+    uint8_t payload[BALL_PAYLOAD_MAX];
+    uint8_t length;
+
+    get_ball_state(id, &state);
+    length = ball_pack_to(&state, id, their_score, handoff, payload);
+    link_send_to(address, PACKET_BALL, payload, length);
 }
 
 
 /*
  * Function: get_ball_position
  * --------------------
- * Gets the position and directon for the ball along with this players
- * score from the opposing player via ir_uart serial communications.
- * The balls x co-ordinates, y co-ordinates, x direction are y direction
- * are then set.
+ * Gets the trajectory for a ball along with this players score from a
+ * PACKET_BALL packet sent by the opposing player. The ball starts out
+ * behind the border, already moved on by the time the packet took to
+ * arrive; balls_arriving() then follows it in.
+ *
+ * const packet_t *packet: The PACKET_BALL packet received
+ * uint8_t *id: Set to the ball the packet was for
  *
  * Returns: an int my_score representing this players score
 */
-int get_ball_position(void)
+int get_ball_position(const packet_t *packet, uint8_t *id)
+{
+    ball_state_t state;
+    int score = ball_unpack(packet, &state, id);
+    uint8_t i;
+
+    ball_x[*id] = state.x;
+    ball_y[*id] = state.y;
+    ball_vel_x[*id] = state.vel_x;
+    ball_vel_y[*id] = state.vel_y;
+    for (i = 0; i < BALL_TRANSIT_UPDATES; i++) {
+        ball_arriving(*id);
+    }
+    render_ball(*id, get_ball(*id));
+    return score;
+}
+
+
+/*
+ * Function: ball_pack
+ * --------------------
+ * Packs the trajectory of a ball and a score into a PACKET_BALL payload.
+ * The position is given in the other player's co-ordinates, where the
+ * ball is still behind the border.
+ *
+ * const ball_state_t *state: Ball just hit back, on this player's screen
+ * uint8_t id: Which of the balls in play it is
+ * int their_score: The score for the other player to be sent
+ * uint8_t *payload: Filled in with up to BALL_PAYLOAD_MAX bytes
+ *
+ * Returns: the length of the payload, BALL_PAYLOAD_SIZE for the first
+ * ball and a byte more for the id of any other
+*/
+uint8_t ball_pack(const ball_state_t *state, uint8_t id, int their_score, uint8_t *payload)
+{
+    return ball_pack_to(state, id, their_score, BALL_FACING, payload);
+}
+
+
+/*
+ * Function: ball_pack_to
+ * --------------------
+ * Packs a ball as ball_pack() does, for a board that may not be facing
+ * this one. A board in a ring facing the same way carries straight on
+ * from this one's border or goal, so the ball is only moved along by
+ * the width of the grid.
+ *
+ * const ball_state_t *state: Ball to send
+ * uint8_t id: Which of the balls in play it is
+ * int their_score: The score to be sent with it
+ * uint8_t handoff: BALL_FACING, BALL_BEHIND or BALL_AHEAD
+ * uint8_t *payload: Filled in with up to BALL_PAYLOAD_MAX bytes
+ *
+ * Returns: the length of the payload, as for ball_pack()
+*/
+uint8_t ball_pack_to(const ball_state_t *state, uint8_t id, int their_score, uint8_t handoff,
+                     uint8_t *payload)
+{
+    fixed_t x_to_send = state->x;
+    fixed_t y_to_send = state->y;
+    int vel_y_to_send = state->vel_y;
+    int speed_to_send = state->vel_x < 0 ? -state->vel_x : state->vel_x;
+
+    if (handoff == BALL_FACING) {
+        // The other player's grid is mirrored in x and upside down
+        x_to_send = 2 * CROSSING_X - state->x;
+        y_to_send = TOP_Y - state->y;
+        vel_y_to_send = -state->vel_y;
+    } else if (handoff == BALL_BEHIND) {
+        // Still heading away from the goal, which is the other board's too
+        x_to_send += GRID_LENGTH;
+        speed_to_send |= BALL_SPEED_BACK;
+    } else {
+        x_to_send -= GRID_LENGTH;
+    }
+    // Compresses the whole y_pos and score into a single byte using
+    // bitshifting, with the fraction of a pixel in the next
+    payload[0] = (BALL_SCORE_MASK & their_score) | ((y_to_send >> FIXED_FRAC_BITS) << BALL_SCORE_BITS);
+    payload[1] = (uint8_t) y_to_send;
+    // Velocities are kept within a byte by BALL_MAX_SPEED
+    if (vel_y_to_send > INT8_MAX) {
+        vel_y_to_send = INT8_MAX;
+    } else if (vel_y_to_send < INT8_MIN) {
+        vel_y_to_send = INT8_MIN;
+    }
+    payload[2] = (int8_t) vel_y_to_send;
+    payload[3] = (uint8_t) speed_to_send;
+    payload[4] = (uint16_t) x_to_send >> 8;
+    payload[5] = (uint8_t) x_to_send;
+    // Games with one ball send the same packets as before there could be more
+    if (id) {
+        payload[BALL_PAYLOAD_SIZE] = id;
+        return BALL_PAYLOAD_SIZE + 1;
+    }
+    return BALL_PAYLOAD_SIZE;
+}
+
+
+/*
+ * Function: ball_unpack
+ * --------------------
+ * Unpacks the trajectory of a ball and a score from a PACKET_BALL packet,
+ * leaving the ball behind the border as it was sent
+ *
+ * const packet_t *packet: The PACKET_BALL packet received
+ * ball_state_t *state: Filled in with the ball's trajectory
+ * uint8_t *id: Set to which of the balls in play it is
+ *
+ * Returns: the score sent, this player's score
+*/
+int ball_unpack(const packet_t *packet, ball_state_t *state, uint8_t *id)
+{
+    uint8_t y_pos_and_score = packet->payload[0];
+    // Performing reverse bitshifting operations to get score and y_pos
+    state->y = (fixed_t) (((y_pos_and_score >> BALL_SCORE_BITS) << FIXED_FRAC_BITS) | packet->payload[1]);
+    state->vel_y = (int8_t) packet->payload[2];
+    state->vel_x = packet->payload[3] & ~BALL_SPEED_BACK;
+    state->x = (fixed_t) ((packet->payload[4] << 8) | packet->payload[5]);
+    if (state->vel_x == 0) {
+        state->vel_x = BALL_INITIAL_SPEED;
+    }
+    if (packet->payload[3] & BALL_SPEED_BACK) {
+        state->vel_x = -state->vel_x;
+    }
+    *id = ball_packet_id(packet);
+    return y_pos_and_score & BALL_SCORE_MASK;
+}
+
+
+/*
+ * Function: ball_packet_id
+ * --------------------
+ * Gives which of the balls in play a PACKET_BALL packet is for, without
+ * unpacking the rest of it
+ *
+ * const packet_t *packet: The PACKET_BALL packet received
+ *
+ * Returns: the id of the ball, 0 for packets without one
+*/
+uint8_t ball_packet_id(const packet_t *packet)
+{
+    if (packet->length > BALL_PAYLOAD_SIZE) {
+        return packet->payload[BALL_PAYLOAD_SIZE] % BALL_POOL_SIZE;
+    }
+    return 0;
+}
+
+
+/*
+ * Function: ball_row_mask
+ * --------------------
+ * Gives the row of the playing grid a ball is drawn in as a bitmask, so
+ * it can be tested against a whole column at once
+ *
+ * fixed_t y: Fixed-point y of the ball
+ *
+ * Returns: BIT(row) for the row y rounds to, 0 if that is off the grid
+*/
+uint8_t ball_row_mask(fixed_t y)
+{
+    int row = FIXED_TO_INT(y);
+
+    return (row >= BOTTOM_WALL_Y && row <= TOP_WALL_Y) ? BIT(row) : 0;
+}
+
+
+/*
+ * Function: ball_initial_state
+ * --------------------
+ * Gives the state reset_ball() puts the ball in
+ *
+ * ball_state_t *state: Filled in with the ball's state
+ *
+*/
+void ball_initial_state(ball_state_t *state)
+{
+    state->x = FIXED_FROM_INT(INITIAL_BALL_X_POS);
+    state->y = FIXED_FROM_INT(INITIAL_BALL_Y_POS);
+    state->vel_x = BALL_INITIAL_SPEED;
+    state->vel_y = 0;
+}
+
+
+/*
+ * Function: ball_intercept
+ * --------------------
+ * Predicts where a ball heading towards the paddle will reach the column
+ * in front of it, bouncing off the walls on the way, without moving it
+ * an update at a time: the number of updates comes from a table of the
+ * speeds' reciprocals, and the walls are unfolded so the flight is a
+ * straight line. Takes the same time whatever the distance.
+ *
+ * ball_state_t *state: Ball to follow, moved on to the update it reaches
+ * the column in front of the paddle
+ *
+ * Returns: the number of updates until the ball reaches the paddle, 0 if
+ * it isn't heading towards it
+*/
+int ball_intercept(ball_state_t *state)
 {
-    int my_score = 0;
-    if (ir_uart_read_ready_p()) {
-        uint8_t y_pos_and_score = (int) ir_uart_getc();
-        ball_dir_y = (int) ir_uart_getc();
-        // Performing reverse bitshifting operations to get score and y_pos
-        ball.y = (y_pos_and_score >> 4);
-        my_score = (y_pos_and_score) & 0b00001111;
-        // Set initial x co-ord and direction
-        ball.x = INITIAL_BALL_X_POS;
-        ball_dir_x = X_TOWARDS_PADDLE;
+    int32_t distance = CONTACT_X - state->x;
+    int32_t y;
+    int32_t folds;
+    int speed = state->vel_x;
+    int updates;
+
+    if (speed <= 0) {
+        return 0;
+    }
+
+    // Underestimates by at most an update or two, then round up
+    updates = 0;
+    if (distance > 0) {
+        updates = (distance * pgm_read_word(&speed_reciprocals[speed < BALL_MAX_SPEED ? speed : BALL_MAX_SPEED])) >> 16;
+    }
+    while (distance > (int32_t) updates * speed) {
+        updates++;
+    }
+    state->x += updates * speed;
+
+    // The bounces reflect the ball's path, so fold the straight path
+    // back over the walls
+    y = state->y - BOTTOM_Y + (int32_t) updates * state->vel_y;
+    folds = (y * WALL_PERIOD_RECIPROCAL) >> 16;
+    y -= folds * WALL_PERIOD;
+    if (y < 0) {
+        y += WALL_PERIOD;
+    } else if (y >= WALL_PERIOD) {
+        y -= WALL_PERIOD;
     }
-    return my_score;
+    // A ball just touching a wall only bounces off it next update
+    if (y > WALL_PERIOD / 2 || (y == WALL_PERIOD / 2 && state->vel_y < 0)) {
+        y = WALL_PERIOD - y;
+        state->vel_y = -state->vel_y;
+    } else if (y == 0 && state->vel_y > 0) {
+        state->vel_y = -state->vel_y;
+    }
+    state->y = BOTTOM_Y + y;
+    return updates;
+}
+
+
+/*
+ * Function: ball_hit
+ * --------------------
+ * Reflects a ball off a paddle, speeding it up and giving it "english":
+ * the further from the paddles centre the ball hits, the steeper it
+ * leaves, hitting one pixel off centre leaves at 45 degrees
+ *
+ * ball_state_t *state: Ball reaching the paddle
+ * fixed_t paddle_centre_y: Fixed-point y of the paddle's centre
+ *
+*/
+void ball_hit(ball_state_t *state, fixed_t paddle_centre_y)
+{
+    fixed_t speed = state->vel_x + (state->vel_x >> BALL_SPEED_UP_SHIFT);
+
+    if (speed > BALL_MAX_SPEED) {
+        speed = BALL_MAX_SPEED;
+    }
+    state->x = 2 * CONTACT_X - state->x;
+    state->vel_x = -speed;
+    state->vel_y = FIXED_MUL(state->y - paddle_centre_y, speed);
 }
 
 
 /*
  * Function: reset_ball
  * --------------------
- * Resets the balls position and direction when the current game has
+ * Resets a balls position and velocity when the current game has
  * finished, so the next game can begin.
+ *
+ * uint8_t id: Ball to reset
+ *
 */
-void reset_ball(void)
+void reset_ball(uint8_t id)
 {
-    ball.x = INITIAL_BALL_X_POS;
-    ball.y = INITIAL_BALL_Y_POS;
-    ball_dir_x = X_TOWARDS_PADDLE;
-    ball_dir_y = Y_STRAIGHT;
+    set_ball_position(id, INITIAL_BALL_X_POS, INITIAL_BALL_Y_POS);
 }
 
 
 /*
  * Function: is_bouncing_off_paddle
  * --------------------
- * Determines whether the ball is bouncing of the players paddle, and
- * decides in which y direction the ball should rebound based on where
- * the ball came into contact with the paddle
+ * Determines whether a ball has reached the players paddle in this
+ * update, i.e. crossed the column in front of it while heading towards
+ * it, in a row the paddle covers
+ *
+ * uint8_t id: Ball to check
+ * uint8_t paddle_rows: Rows the paddle covers, from get_paddle_rows()
  *
  * Returns: an int, 1 if the ball is bouncing of the paddle, 0 otherwise
 */
-static int is_bouncing_off_paddle(void)
+static int is_bouncing_off_paddle(uint8_t id, uint8_t paddle_rows)
 {
-    //Get current paddle position
-    int paddle_top_y = get_paddle_top().y;
-    int paddle_bottom_y = get_paddle_bottom().y;
-    if(ball.x == ONE_FROM_GOAL && ball_dir_x == X_TOWARDS_PADDLE && ball.y >= paddle_bottom_y && ball.y <= paddle_top_y) {
-        if(ball.y == paddle_bottom_y) {
-            ball_dir_y = Y_TOWARDS_BOTTOM;
-        } else if (ball.y == paddle_top_y) {
-            ball_dir_y = Y_TOWARDS_TOP;
-        } else {
-            ball_dir_y = Y_STRAIGHT;
-        }
-        return 1;
-    } else {
-        return 0;
-    }
+    return (ball_vel_x[id] > 0 && ball_x[id] >= CONTACT_X && ball_x[id] - ball_vel_x[id] < CONTACT_X
+            && (ball_row_mask(ball_y[id]) & paddle_rows));
+}
+
+
+/*
+ * Function: bounce_off_paddle
+ * --------------------
+ * Reflects a ball off the paddle, see ball_hit()
+ *
+ * uint8_t id: Ball to reflect
+ * fixed_t paddle_centre_y: Fixed-point y of the paddle's centre
+ *
+*/
+static void bounce_off_paddle(uint8_t id, fixed_t paddle_centre_y)
+{
+    ball_state_t state = {ball_x[id], ball_y[id], ball_vel_x[id], ball_vel_y[id]};
+
+    ball_hit(&state, paddle_centre_y);
+    ball_x[id] = state.x;
+    ball_vel_x[id] = state.vel_x;
+    ball_vel_y[id] = state.vel_y;
 }
 
 
 /*
  * Function: is_bouncing_off_wall
  * --------------------
- * Determines whether the ball is bouncing of the wall of the playing
- * grid
+ * Determines whether a ball has gone past the top or bottom wall of
+ * the playing grid in this update
+ *
+ * uint8_t id: Ball to check
  *
  * Returns: an int to_return, 1 if the ball is bouncing of the wall,
  * 0 otherwise
 */
-static int is_bouncing_off_wall(void)
+static int is_bouncing_off_wall(uint8_t id)
 {
     int to_return = 0;
-    if(ball.y == TOP_WALL_Y && ball_dir_y == Y_TOWARDS_TOP) {
+    if(ball_y[id] > TOP_Y && ball_vel_y[id] > 0) {
         to_return = 1;
-    } else if(ball.y == BOTTOM_WALL_Y && ball_dir_y == Y_TOWARDS_BOTTOM) {
+    } else if(ball_y[id] < BOTTOM_Y && ball_vel_y[id] < 0) {
         to_return = 1;
     }
     return to_return;
@@ -185,106 +581,216 @@ static int is_bouncing_off_wall(void)
 
 
 /*
- * Function: is_crossing_border
+ * Function: bounce_off_wall
  * --------------------
- * Determines whether the ball is crossing the grid border
+ * Reflects a ball off whichever wall it has gone past
+ *
+ * uint8_t id: Ball to reflect
  *
- * Returns: an int, 1 if the ball is crossing the border, 0 otherwise
 */
-static int is_crossing_border(void)
+static void bounce_off_wall(uint8_t id)
 {
-    return (ball.x == BORDER_X && ball_dir_x == X_AWAY_FROM_PADDLE);
+    if (ball_vel_y[id] > 0) {
+        ball_y[id] = 2 * TOP_Y - ball_y[id];
+    } else {
+        ball_y[id] = 2 * BOTTOM_Y - ball_y[id];
+    }
+    ball_vel_y[id] = -ball_vel_y[id];
 }
 
 
 /*
  * Function: is_moving_away
  * --------------------
- * Determines whether the ball is moving away from the paddle
+ * Determines whether a ball is moving away from the paddle
+ *
+ * uint8_t id: Ball to check
  *
  * Returns: an int, 1 if the ball is moving away from the paddle, 0
  * otherwise
 */
-static int is_moving_away(void)
+static int is_moving_away(uint8_t id)
+{
+    return (ball_vel_x[id] < 0);
+}
+
+
+/*
+ * Function: is_crossing_border
+ * --------------------
+ * Determines whether a ball has left the grid over the border
+ *
+ * uint8_t id: Ball to check
+ *
+ * Returns: an int, 1 if the ball is crossing the border, 0 otherwise
+*/
+static int is_crossing_border(uint8_t id)
 {
-    return (ball_dir_x == X_AWAY_FROM_PADDLE);
+    if (is_moving_away(id)) {
+        return (ball_x[id] < CROSSING_X);
+    }
+    return (far_border && ball_x[id] >= FAR_CROSSING_X);
 }
 
 
 /*
  * Function: scored_against
  * --------------------
- * Determines whether the player has been scored against
+ * Determines whether the player has been scored against by a ball
+ *
+ * uint8_t id: Ball to check
  *
  * Returns: an int, 1 if the player has been scored against, 0 otherwise
 */
-static int scored_against(void)
+static int scored_against(uint8_t id)
 {
-    return (ball.x == GOAL_X);
+    return (!far_border && ball_x[id] >= SCORED_X);
 }
 
 
 /*
  * Function: move_ball
  * --------------------
- * Moves the ball position with its current x and y directions
+ * Moves a ball position by its current velocity
+ *
+ * uint8_t id: Ball to move
  *
 */
-static void move_ball(void)
+static void move_ball(uint8_t id)
 {
-    // Changing the x position of the ball
-    if (is_moving_away()) {
-        ball.x--;
-    } else {
-        ball.x++;
+    ball_x[id] += ball_vel_x[id];
+    ball_y[id] += ball_vel_y[id];
+}
+
+
+/*
+ * Function: is_behind_border
+ * --------------------
+ * Determines whether a ball is off the grid behind the border, or
+ * behind the far border, see ball_far_border_set()
+ *
+ * uint8_t id: Ball to check
+ *
+ * Returns: an int, 1 if the ball is behind a border, 0 otherwise
+*/
+static int is_behind_border(uint8_t id)
+{
+    return (ball_x[id] < CROSSING_X || (far_border && ball_x[id] >= FAR_CROSSING_X));
+}
+
+
+/*
+ * Function: ball_arriving
+ * --------------------
+ * Moves a ball that is still behind the border on its way to this
+ * screen, exactly as it would have moved on the other screen
+ *
+ * uint8_t id: Ball to move
+ *
+ * Returns: an int, 1 once the ball has crossed onto this screen,
+ * 0 otherwise
+*/
+static int ball_arriving(uint8_t id)
+{
+    if (!is_behind_border(id)) {
+        return 1;
+    }
+    move_ball(id);
+    if (is_bouncing_off_wall(id)) {
+        bounce_off_wall(id);
     }
-    // Changing the y position of the ball
-    switch (ball_dir_y) {
-    case Y_TOWARDS_TOP:
-        ball.y++;
-        break;
-    case Y_TOWARDS_BOTTOM:
-        ball.y--;
-        break;
+    render_ball(id, get_ball(id));
+    return !is_behind_border(id);
+}
+
+
+/*
+ * Function: balls_arriving
+ * --------------------
+ * Moves the balls that are still behind the border on their way to this
+ * screen, exactly as they would have moved on the other screen
+ *
+ * uint8_t balls: Bitmask of the balls on their way, BIT(id) for each
+ *
+ * Returns: a bitmask of the balls that have crossed onto this screen
+*/
+uint8_t balls_arriving(uint8_t balls)
+{
+    uint8_t arrived = 0;
+    uint8_t id;
+
+    for (id = 0; balls; id++, balls >>= 1) {
+        if ((balls & 1) && ball_arriving(id)) {
+            arrived |= BIT(id);
+        }
     }
+    return arrived;
 }
 
 
 /*
- * Function: update_position
+ * Function: update_balls
  * --------------------
- * Updates the position of the ball by checking whether: The ball has
- * gone past the ball and the players has been scored against, the ball
- * is bouncing off the players paddle, the ball is bouncing off the,
- * wall or the ball is crossing the border. Moves the ball using the
- * move_ball() function if the border has not been crossed
- *
- * Returns: int to_return, 1 if the player has been scored against, -1 if
- * the player is crossing the border and 0 otherwise. This is so the
- * associated functionality in the game.c file can be updated if either
- * of these scenarios occur.
+ * Updates the position of each ball on this screen in one pass, checking
+ * whether: The ball has gone past the paddle and the players has been
+ * scored against, the ball is bouncing off the players paddle, the ball
+ * is bouncing off the wall or the ball is crossing the border. Positions
+ * and velocities are 8.8 fixed-point, so the balls move a fraction of a
+ * pixel per update at any angle and only snap to the grid when drawn.
+ * The balls are kept as a struct of arrays, one array per field indexed
+ * by ball id, and the paddle is only looked up once for all of them.
+ *
+ * uint8_t balls: Bitmask of the balls on this screen, BIT(id) for each
+ * ball_events_t *events: Filled in with a bitmask of the balls for each
+ * of the scenarios, so the associated functionality in the game.c file
+ * can be updated if any of them occur
+ *
 */
-int update_position(void)
+void update_balls(uint8_t balls, ball_events_t *events)
 {
-    int to_return = 0;
-    if (scored_against()) {
-        to_return = 1;
-    } else {
-        if (is_bouncing_off_paddle()) {
-            ball_dir_x = X_AWAY_FROM_PADDLE;
+    uint8_t paddle_rows = get_paddle_rows();
+    fixed_t paddle_centre_y = (FIXED_FROM_INT(get_paddle_top().y)
+                               + FIXED_FROM_INT(get_paddle_bottom().y)) / 2;
+    uint8_t id;
+
+    events->scored = 0;
+    events->hit = 0;
+    events->crossed = 0;
+    for (id = 0; balls; id++, balls >>= 1) {
+        if (!(balls & 1)) {
+            continue;
+        }
+        if (scored_against(id)) {
+            events->scored |= BIT(id);
+            continue;
         }
-        if (is_bouncing_off_wall()) {
-            //Reverse y direction of ball
-            ball_dir_y = - ball_dir_y;
+        move_ball(id);
+        if (is_bouncing_off_paddle(id, paddle_rows)) {
+            bounce_off_paddle(id, paddle_centre_y);
+            events->hit |= BIT(id);
         }
-        if (is_crossing_border()) {
-            if (is_bouncing_off_wall()) {
-                ball_dir_y = - ball_dir_y;
-            }
-            to_return = -1;
-        } else {
-            move_ball();
+        if (is_bouncing_off_wall(id)) {
+            bounce_off_wall(id);
         }
+        if (is_crossing_border(id)) {
+            events->crossed |= BIT(id);
+        }
+        render_ball(id, get_ball(id));
     }
-    return to_return;
+}
+
+
+/*
+ * Function: ball_far_border_set
+ * --------------------
+ * Makes the far side of the grid a border like the near one, for a
+ * board in the middle of a ring with no paddle: balls pass over it to
+ * the next board instead of scoring, and arrive over it from there
+ *
+ * int enable: True for a far border, false for a goal
+ *
+*/
+void ball_far_border_set(int enable)
+{
+    far_border = enable;
 }
@@ -12,78 +12,317 @@
 #include "ir_uart.h"
 #include "tinygl.h"
 #include "paddle.h"
+#include "packet.h"
+#include "fixed.h"
+#include "render.h"
+#include "geometry.h"
+
+#define BALL_UPDATE_RATE 50 // Rate update_balls() is called at, in Hz
+#define BALL_POOL_SIZE RENDER_BALLS // Most balls in play at once
+#define BALL_PAYLOAD_SIZE 6 // Bytes in a PACKET_BALL payload for the first ball
+#define BALL_PAYLOAD_MAX (BALL_PAYLOAD_SIZE + 1) // Other balls add their id
+#define BALL_SCORE_BITS (8 - GRID_Y_BITS) // The score shares a byte with the row, below it
+#define BALL_SCORE_MASK (BIT(BALL_SCORE_BITS) - 1)
+#define BALL_SPEED_BACK 0x80 // Set in a PACKET_BALL's speed for a ball heading away from the receiver's goal
+
+// How a ball is handed to another board, see ball_pack_to()
+#define BALL_FACING 0 // Across the border to a board facing this one, as the players' boards do
+#define BALL_BEHIND 1 // Back over the border to a board in a ring facing the same way
+#define BALL_AHEAD 2 // On past the goal to a board in a ring facing the same way
+
+
+typedef struct ball_state_struct
+{
+    fixed_t x; // Fixed-point x position, increasing towards the paddle
+    fixed_t y; // Fixed-point y position, increasing towards the top
+    fixed_t vel_x; // Fixed-point x velocity in pixels per update
+    fixed_t vel_y; // Fixed-point y velocity in pixels per update
+} ball_state_t;
+
+
+typedef struct ball_events_struct
+{
+    uint8_t scored; // Balls that went past the paddle, BIT(id) for each
+    uint8_t hit; // Balls just hit back off the paddle
+    uint8_t crossed; // Balls that left the grid over the border
+} ball_events_t;
+
 
 /*
  * Function: set_ball_position
  * --------------------
  * Initialization of the balls position and directon
  *
+ * uint8_t id: Ball to set
  * int x: x-coordinate to be set
  * int y: y-coordinate to be set
  *
 */
-void set_ball_position(int x, int y);
+void set_ball_position(uint8_t id, int x, int y);
+
+
+/*
+ * Function: get_ball_state
+ * --------------------
+ * Getter for the exact position and velocity of a ball
+ *
+ * uint8_t id: Ball to get
+ * ball_state_t *state: Filled in with the ball's state
+ *
+*/
+void get_ball_state(uint8_t id, ball_state_t *state);
+
+
+/*
+ * Function: set_ball_state
+ * --------------------
+ * Puts a ball back to a state from get_ball_state()
+ *
+ * uint8_t id: Ball to set
+ * const ball_state_t *state: State to restore
+ *
+*/
+void set_ball_state(uint8_t id, const ball_state_t *state);
 
 
 /*
  * Function: get_ball
  * --------------------
- * Getter for the ball
+ * Getter for a ball, rasterising its sub-pixel position onto the
+ * nearest LED of the grid
+ *
+ * uint8_t id: Ball to get
  *
  * Returns: a tinygl_point struct for the ball, holding the balls x
  * and y co-ordinates
  *
 */
-struct tinygl_point get_ball(void);
+struct tinygl_point get_ball(uint8_t id);
 
 
 /*
  * Function: send_ball_position
  * --------------------
- * Sends the position of the ball to the other player when the border
- * has been crossed via ir_uart serial communications
+ * Sends the trajectory of a ball to the other player as soon as it
+ * has been hit back, as a PACKET_BALL packet. The position is given in
+ * the other player's co-ordinates, where the ball is still behind the
+ * border, so they can follow it in from their own clock.
  *
- * uint8_t their_score: The score for the other player to be sent
+ * uint8_t id: Ball to send
+ * int their_score: The score for the other player to be sent
  */
-void send_ball_position(int their_score);
+void send_ball_position(uint8_t id, int their_score);
+
+
+/*
+ * Function: send_ball_to
+ * --------------------
+ * Sends the trajectory of a ball to a board in a ring, as
+ * send_ball_position() does, in that board's co-ordinates
+ *
+ * uint8_t id: Ball to send
+ * int their_score: The score to be sent with it
+ * uint8_t handoff: BALL_FACING, BALL_BEHIND or BALL_AHEAD
+ * uint8_t address: PACKET_ADDRESS() of this board and the board to
+ * send to
+ */
+void send_ball_to(uint8_t id, int their_score, uint8_t handoff, uint8_t address);
 
 
 /*
  * Function: get_ball_position
  * --------------------
- * Gets the position and directon for the ball along with this players
- * score from the opposing player via ir_uart serial communications.
- * The balls x co-ordinates, y co-ordinates, x direction are y direction
- * are then set.
+ * Gets the trajectory for a ball along with this players score from a
+ * PACKET_BALL packet sent by the opposing player. The ball starts out
+ * behind the border, already moved on by the time the packet took to
+ * arrive; balls_arriving() then follows it in.
+ *
+ * const packet_t *packet: The PACKET_BALL packet received
+ * uint8_t *id: Set to the ball the packet was for
  *
  * Returns: an int my_score representing this players score
 */
-int get_ball_position(void);
+int get_ball_position(const packet_t *packet, uint8_t *id);
+
+
+/*
+ * Function: balls_arriving
+ * --------------------
+ * Moves the balls that are still behind the border on their way to this
+ * screen, exactly as they would have moved on the other screen
+ *
+ * uint8_t balls: Bitmask of the balls on their way, BIT(id) for each
+ *
+ * Returns: a bitmask of the balls that have crossed onto this screen
+*/
+uint8_t balls_arriving(uint8_t balls);
+
+
+/*
+ * Function: ball_pack
+ * --------------------
+ * Packs the trajectory of a ball and a score into a PACKET_BALL payload.
+ * The position is given in the other player's co-ordinates, where the
+ * ball is still behind the border.
+ *
+ * const ball_state_t *state: Ball just hit back, on this player's screen
+ * uint8_t id: Which of the balls in play it is
+ * int their_score: The score for the other player to be sent
+ * uint8_t *payload: Filled in with up to BALL_PAYLOAD_MAX bytes
+ *
+ * Returns: the length of the payload, BALL_PAYLOAD_SIZE for the first
+ * ball and a byte more for the id of any other
+*/
+uint8_t ball_pack(const ball_state_t *state, uint8_t id, int their_score, uint8_t *payload);
+
+
+/*
+ * Function: ball_pack_to
+ * --------------------
+ * Packs a ball as ball_pack() does, for a board that may not be facing
+ * this one. A board in a ring facing the same way carries straight on
+ * from this one's border or goal, so the ball is only moved along by
+ * the width of the grid.
+ *
+ * const ball_state_t *state: Ball to send
+ * uint8_t id: Which of the balls in play it is
+ * int their_score: The score to be sent with it
+ * uint8_t handoff: BALL_FACING, BALL_BEHIND or BALL_AHEAD
+ * uint8_t *payload: Filled in with up to BALL_PAYLOAD_MAX bytes
+ *
+ * Returns: the length of the payload, as for ball_pack()
+*/
+uint8_t ball_pack_to(const ball_state_t *state, uint8_t id, int their_score, uint8_t handoff,
+                     uint8_t *payload);
+
+
+/*
+ * Function: ball_unpack
+ * --------------------
+ * Unpacks the trajectory of a ball and a score from a PACKET_BALL packet,
+ * leaving the ball behind the border as it was sent
+ *
+ * const packet_t *packet: The PACKET_BALL packet received
+ * ball_state_t *state: Filled in with the ball's trajectory
+ * uint8_t *id: Set to which of the balls in play it is
+ *
+ * Returns: the score sent, this player's score
+*/
+int ball_unpack(const packet_t *packet, ball_state_t *state, uint8_t *id);
+
+
+/*
+ * Function: ball_packet_id
+ * --------------------
+ * Gives which of the balls in play a PACKET_BALL packet is for, without
+ * unpacking the rest of it
+ *
+ * const packet_t *packet: The PACKET_BALL packet received
+ *
+ * Returns: the id of the ball, 0 for packets without one
+*/
+uint8_t ball_packet_id(const packet_t *packet);
+
+
+/*
+ * Function: ball_far_border_set
+ * --------------------
+ * Makes the far side of the grid a border like the near one, for a
+ * board in the middle of a ring with no paddle: balls pass over it to
+ * the next board instead of scoring, and arrive over it from there
+ *
+ * int enable: True for a far border, false for a goal
+ *
+*/
+void ball_far_border_set(int enable);
+
+
+/*
+ * Function: ball_row_mask
+ * --------------------
+ * Gives the row of the playing grid a ball is drawn in as a bitmask, so
+ * it can be tested against a whole column at once
+ *
+ * fixed_t y: Fixed-point y of the ball
+ *
+ * Returns: BIT(row) for the row y rounds to, 0 if that is off the grid
+*/
+uint8_t ball_row_mask(fixed_t y);
+
+
+/*
+ * Function: ball_initial_state
+ * --------------------
+ * Gives the state reset_ball() puts the ball in
+ *
+ * ball_state_t *state: Filled in with the ball's state
+ *
+*/
+void ball_initial_state(ball_state_t *state);
+
+
+/*
+ * Function: ball_intercept
+ * --------------------
+ * Predicts where a ball heading towards the paddle will reach the column
+ * in front of it, bouncing off the walls on the way, without moving it
+ * an update at a time: the number of updates comes from a table of the
+ * speeds' reciprocals, and the walls are unfolded so the flight is a
+ * straight line. Takes the same time whatever the distance.
+ *
+ * ball_state_t *state: Ball to follow, moved on to the update it reaches
+ * the column in front of the paddle
+ *
+ * Returns: the number of updates until the ball reaches the paddle, 0 if
+ * it isn't heading towards it
+*/
+int ball_intercept(ball_state_t *state);
+
+
+/*
+ * Function: ball_hit
+ * --------------------
+ * Reflects a ball off a paddle, speeding it up and giving it "english":
+ * the further from the paddles centre the ball hits, the steeper it
+ * leaves, hitting one pixel off centre leaves at 45 degrees
+ *
+ * ball_state_t *state: Ball reaching the paddle
+ * fixed_t paddle_centre_y: Fixed-point y of the paddle's centre
+ *
+*/
+void ball_hit(ball_state_t *state, fixed_t paddle_centre_y);
 
 
 /*
  * Function: reset_ball
  * --------------------
- * Resets the balls position and direction when the current game has
+ * Resets a balls position and velocity when the current game has
  * finished, so the next game can begin.
+ *
+ * uint8_t id: Ball to reset
+ *
 */
-void reset_ball(void);
+void reset_ball(uint8_t id);
 
 
 /*
- * Function: update_position
+ * Function: update_balls
  * --------------------
- * Updates the position of the ball by checking whether: The ball has
- * gone past the ball and the players has been scored against, the ball
- * is bouncing off the players paddle, the ball is bouncing off the,
- * wall or the ball is crossing the border. Moves the ball using the
- * move_ball() function if the border has not been crossed
+ * Updates the position of each ball on this screen in one pass, checking
+ * whether: The ball has gone past the paddle and the players has been
+ * scored against, the ball is bouncing off the players paddle, the ball
+ * is bouncing off the wall or the ball is crossing the border. Positions
+ * and velocities are 8.8 fixed-point, so the balls move a fraction of a
+ * pixel per update at any angle and only snap to the grid when drawn.
+ * The balls are kept as a struct of arrays, one array per field indexed
+ * by ball id, and the paddle is only looked up once for all of them.
+ *
+ * uint8_t balls: Bitmask of the balls on this screen, BIT(id) for each
+ * ball_events_t *events: Filled in with a bitmask of the balls for each
+ * of the scenarios, so the associated functionality in the game.c file
+ * can be updated if any of them occur
  *
- * Returns: int to_return, 1 if the player has been scored against, -1 if
- * the player is crossing the border and 0 otherwise. This is so the
- * associated functionality in the game.c file can be updated if either
- * of these scenarios occur.
 */
-int update_position(void);
+void update_balls(uint8_t balls, ball_events_t *events);
 
 #endif
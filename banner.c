@@ -0,0 +1,185 @@
+/** @file   banner.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module scrolls the pong game's messages across the
+            display from the columns rendered for them when the game was
+            built.
+*/
+
+
+#include <avr/pgmspace.h>
+#include "system.h"
+#include "ledmat.h"
+#include "geometry.h"
+#include "banner.h"
+
+
+static uint8_t pieces[BANNER_PIECES_MAX]; // Pieces of the message being shown
+static uint8_t pieces_num; // Number of them
+static uint16_t length; // Columns the message scrolls through before it starts again
+static uint16_t offset; // Column of the message at the left of the display
+static uint16_t period; // Updates between moving the message along, see banner_init()
+static uint16_t updates; // Updates since the message last moved
+static uint8_t shown[GRID_WIDTH]; // Columns of the message on the display, a bit per row
+
+
+/*
+ * Function: message_column
+ * --------------------
+ * Finds a column of the message, from flash
+ *
+ * uint16_t column: Column of the message, below length; the message
+ * starts a display's width of blank columns in, so it scrolls on from
+ * the right
+ *
+ * Returns: the column, a bit per row
+*/
+static uint8_t message_column(uint16_t column)
+{
+    uint16_t start;
+    uint16_t end;
+    uint8_t i;
+
+    if (column < GRID_WIDTH) {
+        return 0;
+    }
+    column -= GRID_WIDTH;
+    for (i = 0; i < pieces_num; i++) {
+        start = pgm_read_word(&banner_starts[pieces[i]]);
+        end = pgm_read_word(&banner_starts[pieces[i] + 1]);
+        if (column < end - start) {
+            return pgm_read_byte(&banner_columns[start + column]);
+        }
+        column -= end - start;
+    }
+    return 0;
+}
+
+
+/*
+ * Function: fill_display
+ * --------------------
+ * Copies the columns of the message now on the display out of flash
+ *
+*/
+static void fill_display(void)
+{
+    uint16_t column = offset;
+    uint8_t x;
+
+    for (x = 0; x < GRID_WIDTH; x++) {
+        shown[x] = message_column(column);
+        column = column + 1 < length ? column + 1 : 0;
+    }
+}
+
+
+/*
+ * Function: banner_init
+ * --------------------
+ * Sets how fast messages scroll
+ *
+ * uint16_t update_rate: Rate banner_update() is called at, in Hz
+ * uint8_t speed: Characters scrolled per 10 seconds, as tinygl_text_speed_set()
+ *
+*/
+void banner_init(uint16_t update_rate, uint8_t speed)
+{
+    period = update_rate * 10 / (speed * BANNER_GLYPH_COLUMNS);
+    pieces_num = 0;
+    length = GRID_WIDTH;
+    offset = 0;
+    fill_display();
+}
+
+
+/*
+ * Function: banner_show
+ * --------------------
+ * Starts scrolling a message, in from the right, over and over until
+ * another is shown
+ *
+ * const uint8_t *new_pieces: Pieces of the message, BANNER_START and so on
+ * uint8_t count: Number of pieces, at most BANNER_PIECES_MAX
+ *
+*/
+void banner_show(const uint8_t *new_pieces, uint8_t count)
+{
+    uint8_t i;
+
+    length = GRID_WIDTH;
+    for (i = 0; i < count; i++) {
+        pieces[i] = new_pieces[i];
+        length += pgm_read_word(&banner_starts[pieces[i] + 1]) - pgm_read_word(&banner_starts[pieces[i]]);
+    }
+    pieces_num = count;
+    offset = 0;
+    updates = 0;
+    fill_display();
+}
+
+
+/*
+ * Function: banner_update
+ * --------------------
+ * Counts a display update, moving the message along a column when it is
+ * time to
+ *
+*/
+void banner_update(void)
+{
+    if (++updates < period) {
+        return;
+    }
+    updates = 0;
+    offset = offset + 1 < length ? offset + 1 : 0;
+    fill_display();
+}
+
+
+/*
+ * Function: banner_column
+ * --------------------
+ * Lights a column of the message on the LED matrix, in place of
+ * tinygl_update() while a message is shown
+ *
+ * uint8_t column: Column to light, below GRID_WIDTH
+ *
+*/
+void banner_column(uint8_t column)
+{
+    ledmat_display_column(shown[column], column);
+}
+
+
+/*
+ * Function: banner_text_get
+ * --------------------
+ * Gets the text of the message being shown, for diagnostics
+ *
+ * char *text: Filled in with the text
+ * uint8_t size: Size of text, including the terminating nul
+ *
+*/
+void banner_text_get(char *text, uint8_t size)
+{
+    const char *piece_text;
+    uint8_t piece;
+    uint8_t i;
+    char ch;
+
+    for (i = 0; i < pieces_num; i++) {
+        // Skipping the texts of the pieces before this one
+        piece_text = banner_texts;
+        for (piece = 0; piece < pieces[i]; piece++) {
+            while (pgm_read_byte(piece_text++)) {
+                continue;
+            }
+        }
+        while ((ch = pgm_read_byte(piece_text++)) && size > 1) {
+            *text++ = ch;
+            size--;
+        }
+    }
+    *text = '\0';
+}
@@ -0,0 +1,104 @@
+/** @file   banner.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for the scrolling text of the pong
+            game: the start message and the end of game results. Each
+            piece of text they are made of is rendered from the 5x7 font
+            when the game is built, by host/banner_gen.c, into a byte per
+            column kept in flash (banner_data.c). A message is a list of
+            pieces, such as "Lose " and a digit, and is scrolled across
+            the display straight from those columns, a column at a time
+            as the grid is, with no glyphs looked up while it plays.
+*/
+
+#ifndef BANNER_H
+#define BANNER_H
+
+#include "system.h"
+
+#define BANNER_FONT_WIDTH 5 // Columns of a glyph, as font5x7_1 has them
+#define BANNER_FONT_HEIGHT 7
+#define BANNER_GLYPH_COLUMNS (BANNER_FONT_WIDTH + 1) // And a blank column between glyphs
+#define BANNER_PIECES_MAX 4 // Most pieces in one message
+
+// Pieces of text the messages are made of, see BANNER_PIECE_TEXTS
+enum {BANNER_START, BANNER_WIN, BANNER_LOSE, BANNER_DASH, BANNER_DIGITS};
+#define BANNER_DIGITS_NUM 8 // Digits rendered from BANNER_DIGITS on, enough for any score
+#define BANNER_PIECES (BANNER_DIGITS + BANNER_DIGITS_NUM)
+
+// Text of each piece, in the order above, for host/banner_gen.c
+#define BANNER_PIECE_TEXTS {"PONG - Press down to start", "Win ", "Lose ", "-", \
+                            "0", "1", "2", "3", "4", "5", "6", "7"}
+
+#if BANNER_FONT_HEIGHT > 8
+#error "BANNER_FONT_HEIGHT is too tall for a byte per column"
+#endif
+
+
+// Built by host/banner_gen.c, in flash: the columns of every piece one
+// after the other, a bit per row, where each piece starts in them, with
+// the end of the last, and the pieces' texts, each ending with a nul
+extern const uint8_t banner_columns[];
+extern const uint16_t banner_starts[BANNER_PIECES + 1];
+extern const char banner_texts[];
+
+
+/*
+ * Function: banner_init
+ * --------------------
+ * Sets how fast messages scroll
+ *
+ * uint16_t update_rate: Rate banner_update() is called at, in Hz
+ * uint8_t speed: Characters scrolled per 10 seconds, as tinygl_text_speed_set()
+ *
+*/
+void banner_init(uint16_t update_rate, uint8_t speed);
+
+
+/*
+ * Function: banner_show
+ * --------------------
+ * Starts scrolling a message, in from the right, over and over until
+ * another is shown
+ *
+ * const uint8_t *new_pieces: Pieces of the message, BANNER_START and so on
+ * uint8_t count: Number of pieces, at most BANNER_PIECES_MAX
+ *
+*/
+void banner_show(const uint8_t *new_pieces, uint8_t count);
+
+
+/*
+ * Function: banner_update
+ * --------------------
+ * Counts a display update, moving the message along a column when it is
+ * time to
+ *
+*/
+void banner_update(void);
+
+
+/*
+ * Function: banner_column
+ * --------------------
+ * Lights a column of the message on the LED matrix, in place of
+ * tinygl_update() while a message is shown
+ *
+ * uint8_t column: Column to light, below GRID_WIDTH
+ *
+*/
+void banner_column(uint8_t column);
+
+
+/*
+ * Function: banner_text_get
+ * --------------------
+ * Gets the text of the message being shown, for diagnostics
+ *
+ * char *text: Filled in with the text
+ * uint8_t size: Size of text, including the terminating nul
+ *
+*/
+void banner_text_get(char *text, uint8_t size);
+
+#endif
@@ -0,0 +1,156 @@
+/** @file   broadcast.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module broadcasts the match to spectators, a frame from
+            the board with the ball every so often, keeping out of the
+            way of the ball hand-offs.
+*/
+
+
+#include "system.h"
+#include "tinygl.h"
+#include "packet.h"
+#include "link.h"
+#include "ball.h"
+#include "state.h"
+#include "broadcast.h"
+
+#define BALL_X_INDEX STATE_SIZE
+#define BALL_Y_INDEX (STATE_SIZE + 1)
+#define TICK_INDEX (STATE_SIZE + 2)
+
+
+static uint8_t enabled; // True to send frames, see broadcast_init()
+static uint8_t updates; // Game updates since the last frame was sent
+static uint16_t tick; // Game updates since the game started
+
+
+/*
+ * Function: broadcast_init
+ * --------------------
+ * Starts or stops broadcasting, for a new game
+ *
+ * int enable: True to send frames, false to send none
+ *
+*/
+void broadcast_init(int enable)
+{
+    enabled = enable;
+    updates = 0;
+    tick = 0;
+}
+
+
+/*
+ * Function: is_hit_due
+ * --------------------
+ * Determines whether any of the balls on this screen will reach the
+ * paddle, and be sent to the other board, before a frame has gone out
+ *
+ * uint8_t balls: Bitmask of the balls on this screen, BIT(id) for each
+ *
+ * Returns: an int, 1 if a hit is due, 0 otherwise
+*/
+static int is_hit_due(uint8_t balls)
+{
+    ball_state_t state;
+    int until;
+    uint8_t id;
+
+    for (id = 0; balls; id++, balls >>= 1) {
+        if (balls & 1) {
+            get_ball_state(id, &state);
+            until = ball_intercept(&state);
+            if (until && until <= BROADCAST_AIR_UPDATES) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * Function: broadcast_update
+ * --------------------
+ * Counts a game update, sending a frame if one is due and can't hold up
+ * a hand-off, see broadcast.h. Called once per game update while the
+ * game is played, after the balls have moved.
+ *
+ * const game_state_t *state: Snapshot of the game, see game_state_get()
+ * int sent: True if a ball was sent to another board this update
+ *
+*/
+void broadcast_update(const game_state_t *state, int sent)
+{
+    if (!enabled) {
+        return;
+    }
+    tick++;
+    if (updates < BROADCAST_PERIOD) {
+        updates++;
+    }
+    // Only the board with the ball sends, so there's one frame a period
+    if (updates < BROADCAST_PERIOD || !state->ball_visible || sent
+        || is_hit_due(state->ball_visible)) {
+        return;
+    }
+    broadcast_send(state);
+}
+
+
+/*
+ * Function: broadcast_send
+ * --------------------
+ * Sends a frame straight away, such as at the end of the game when no
+ * more hand-offs will be held up by it
+ *
+ * const game_state_t *state: Snapshot of the game, see game_state_get()
+ *
+*/
+void broadcast_send(const game_state_t *state)
+{
+    uint8_t payload[BROADCAST_PAYLOAD_SIZE];
+    tinygl_point_t ball = {0, 0};
+    uint8_t id = 0;
+
+    if (!enabled) {
+        return;
+    }
+    while (id < BALL_POOL_SIZE - 1 && !(state->ball_visible & BIT(id))) {
+        id++;
+    }
+    if (state->ball_visible) {
+        ball = get_ball(id);
+    }
+    state_pack(state, payload);
+    payload[BALL_X_INDEX] = ball.x;
+    payload[BALL_Y_INDEX] = ball.y;
+    payload[TICK_INDEX] = tick >> 8;
+    payload[TICK_INDEX + 1] = tick;
+    link_send(PACKET_SPECTATE, payload, BROADCAST_PAYLOAD_SIZE);
+    updates = 0;
+}
+
+
+/*
+ * Function: broadcast_unpack
+ * --------------------
+ * Unpacks a PACKET_SPECTATE frame, for a listener
+ *
+ * const packet_t *packet: Packet received
+ * broadcast_frame_t *frame: Filled in with the frame
+ *
+ * Returns: 1 if the packet was a frame, 0 otherwise
+*/
+int broadcast_unpack(const packet_t *packet, broadcast_frame_t *frame)
+{
+    if (packet->type != PACKET_SPECTATE || packet->length != BROADCAST_PAYLOAD_SIZE
+        || !state_unpack(packet->payload, &frame->state)) {
+        return 0;
+    }
+    frame->ball_x = (int8_t) packet->payload[BALL_X_INDEX];
+    frame->ball_y = packet->payload[BALL_Y_INDEX];
+    frame->tick = (uint16_t) (packet->payload[TICK_INDEX] << 8 | packet->payload[TICK_INDEX + 1]);
+    return 1;
+}
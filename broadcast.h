@@ -0,0 +1,98 @@
+/** @file   broadcast.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for broadcasting the match to
+            spectators. While the game is played, the board with the
+            ball on its screen sends a PACKET_SPECTATE frame every
+            BROADCAST_PERIOD updates: its packed state (see state.h),
+            where the ball is and a count of the game updates. Any
+            listener in range can decode them, another kit or a host
+            tool (see host/spectate.c); the players' boards ignore them.
+
+            A frame takes about three game updates to send, so one is
+            only sent when no ball was sent in the update and no ball on
+            this screen will reach the paddle while it is going out, so a
+            hand-off is never held up behind one. A frame that is held
+            back goes at the next update it can. Built in with
+            make BROADCAST=1.
+*/
+
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include "system.h"
+#include "packet.h"
+#include "state.h"
+
+#define BROADCAST_PERIOD 10 // Game updates between frames, five a second
+#define BROADCAST_PAYLOAD_SIZE (STATE_SIZE + 4) // Snapshot, ball column and row, tick
+// Game updates a frame takes to send: a 13 byte frame at 2400 baud is 2.7
+// updates
+#define BROADCAST_AIR_UPDATES 3
+
+#ifdef BROADCAST
+#define BROADCAST_ENABLED 1
+#else
+#define BROADCAST_ENABLED 0
+#endif
+
+
+typedef struct broadcast_frame_struct
+{
+    game_state_t state; // Snapshot of the sending board's game
+    int8_t ball_x; // Column of the ball on the sending board's screen
+    uint8_t ball_y; // Row of the ball
+    uint16_t tick; // Game updates since the sending board's game started
+} broadcast_frame_t;
+
+
+/*
+ * Function: broadcast_init
+ * --------------------
+ * Starts or stops broadcasting, for a new game
+ *
+ * int enable: True to send frames, false to send none
+ *
+*/
+void broadcast_init(int enable);
+
+
+/*
+ * Function: broadcast_update
+ * --------------------
+ * Counts a game update, sending a frame if one is due and can't hold up
+ * a hand-off, see broadcast.h. Called once per game update while the
+ * game is played, after the balls have moved.
+ *
+ * const game_state_t *state: Snapshot of the game, see game_state_get()
+ * int sent: True if a ball was sent to another board this update
+ *
+*/
+void broadcast_update(const game_state_t *state, int sent);
+
+
+/*
+ * Function: broadcast_send
+ * --------------------
+ * Sends a frame straight away, such as at the end of the game when no
+ * more hand-offs will be held up by it
+ *
+ * const game_state_t *state: Snapshot of the game, see game_state_get()
+ *
+*/
+void broadcast_send(const game_state_t *state);
+
+
+/*
+ * Function: broadcast_unpack
+ * --------------------
+ * Unpacks a PACKET_SPECTATE frame, for a listener
+ *
+ * const packet_t *packet: Packet received
+ * broadcast_frame_t *frame: Filled in with the frame
+ *
+ * Returns: 1 if the packet was a frame, 0 otherwise
+*/
+int broadcast_unpack(const packet_t *packet, broadcast_frame_t *frame);
+
+#endif
@@ -0,0 +1,244 @@
+/** @file   cpu.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module is the computer opponent, which plays the other
+            board's half of the game when there is only one board. It
+            takes the ball packets this board sends in place of IR and
+            sends back its own, predicting where each ball will reach its
+            paddle as soon as it is sent rather than following it an
+            update at a time.
+*/
+
+
+#include "system.h"
+#include "fixed.h"
+#include "packet.h"
+#include "paddle.h"
+#include "ball.h"
+#include "geometry.h"
+#include "cpu.h"
+
+
+#define CPU_MOVE_UPDATES 3 // Updates between paddle moves, as fast as a quick player pushes
+#define CPU_SCORED_UPDATES (BALL_UPDATE_RATE / 2) // Updates from a miss to the next serve
+#define CPU_AIMS 3 // Hits cycle through aiming below, at and above the paddle's centre
+
+enum {CPU_WAITING, CPU_INCOMING, CPU_SCORED};
+
+
+static void cpu_send(const packet_t *packet);
+static int cpu_receive(packet_t *packet);
+
+
+// Updates the paddle waits before following a ball, for each level: from
+// about a second down to a quick player's quarter of a second
+static const uint8_t reaction_updates[CPU_LEVELS] = {48, 32, 22, 12};
+
+static const packet_peer_t cpu_peer = {cpu_send, cpu_receive}; // Link to this board
+
+static uint8_t level; // Difficulty, 0 when not playing
+static uint8_t phase; // CPU_WAITING while the ball is on this board's screen
+static int winning; // Score the game is played to
+static int player_score; // Score of the player on this board
+static ball_state_t ball; // Ball as it will reach the paddle's column
+static uint8_t updates; // Updates until the ball reaches the paddle, or the serve
+static uint8_t reaction; // Updates left before the paddle starts following the ball
+static uint8_t move_wait; // Updates left before the paddle can move again
+static int8_t paddle_bottom; // Row of the bottom of the paddle
+static int8_t target; // Row the bottom of the paddle is heading for
+static uint8_t hits; // Balls hit back, choosing where to aim the next
+static packet_t outbox; // Ball packet waiting for this board to take it
+static uint8_t outbox_full; // True while the outbox holds a packet
+
+
+/*
+ * Function: paddle_length
+ * --------------------
+ * Returns: the rows the paddle spans less one, the same as this board's
+*/
+static int8_t paddle_length(void)
+{
+    return get_paddle_top().y - get_paddle_bottom().y;
+}
+
+
+/*
+ * Function: follow
+ * --------------------
+ * Predicts where the ball will reach the paddle's column and aims the
+ * paddle for it, after the level's reaction time
+ *
+ * uint8_t delay: Updates to wait before moving
+ *
+*/
+static void follow(uint8_t delay)
+{
+    int8_t length = paddle_length();
+
+    updates = ball_intercept(&ball);
+    target = FIXED_TO_INT(ball.y) - length / 2 + (int8_t) (hits % CPU_AIMS) - 1;
+    if (target < BOTTOM_WALL_Y) {
+        target = BOTTOM_WALL_Y;
+    } else if (target > TOP_WALL_Y - length) {
+        target = TOP_WALL_Y - length;
+    }
+    reaction = delay;
+    phase = CPU_INCOMING;
+}
+
+
+/*
+ * Function: post
+ * --------------------
+ * Sends the ball back to this board, with the player's score
+ *
+*/
+static void post(void)
+{
+    outbox.length = ball_pack(&ball, 0, player_score, outbox.payload);
+    outbox.type = PACKET_BALL;
+    outbox.seq++;
+    outbox_full = 1;
+    phase = CPU_WAITING;
+}
+
+
+/*
+ * Function: reach_paddle
+ * --------------------
+ * Hits the ball back if the paddle covers it, within half a pixel of its
+ * ends like this board's paddle, otherwise concedes the point
+ *
+*/
+static void reach_paddle(void)
+{
+    fixed_t bottom = FIXED_FROM_INT(paddle_bottom);
+    fixed_t top = FIXED_FROM_INT(paddle_bottom + paddle_length());
+    uint8_t rows = (uint8_t) (BIT(paddle_bottom + paddle_length() + 1) - BIT(paddle_bottom));
+
+    if (ball_row_mask(ball.y) & rows) {
+        ball_hit(&ball, (bottom + top) / 2);
+        hits++;
+        post();
+    } else {
+        player_score++;
+        if (player_score >= winning) {
+            // Tells the player the game is over, as the other board would
+            ball_initial_state(&ball);
+            post();
+        } else {
+            updates = CPU_SCORED_UPDATES;
+            phase = CPU_SCORED;
+        }
+    }
+}
+
+
+/*
+ * Function: cpu_send
+ * --------------------
+ * Takes a packet this board sent, following the ball in it
+ *
+ * const packet_t *packet: Packet sent
+ *
+*/
+static void cpu_send(const packet_t *packet)
+{
+    uint8_t id; // Always the first ball, the computer only plays with one
+
+    if (packet->type != PACKET_BALL) {
+        return;
+    }
+    ball_unpack(packet, &ball, &id);
+    follow(reaction_updates[level - 1]);
+}
+
+
+/*
+ * Function: cpu_receive
+ * --------------------
+ * Gives this board the ball once the computer has hit it back
+ *
+ * packet_t *packet: Filled in when a packet is received
+ *
+ * Returns: 1 if a packet was received, 0 otherwise
+*/
+static int cpu_receive(packet_t *packet)
+{
+    if (!outbox_full) {
+        return 0;
+    }
+    *packet = outbox;
+    outbox_full = 0;
+    return 1;
+}
+
+
+/*
+ * Function: cpu_start
+ * --------------------
+ * Starts the computer opponent, sending and receiving this board's
+ * packets through it instead of IR
+ *
+ * uint8_t new_level: Difficulty from 1 to CPU_LEVELS, the higher the level
+ * the sooner the opponent reacts to a ball
+ * int winning_score: Score the game is played to
+ *
+*/
+void cpu_start(uint8_t new_level, int winning_score)
+{
+    level = new_level;
+    winning = winning_score;
+    phase = CPU_WAITING;
+    player_score = 0;
+    paddle_bottom = get_paddle_bottom().y;
+    outbox_full = 0;
+    packet_peer_set(&cpu_peer);
+}
+
+
+/*
+ * Function: cpu_stop
+ * --------------------
+ * Stops the computer opponent, going back to IR
+ *
+*/
+void cpu_stop(void)
+{
+    level = 0;
+    packet_peer_set(0);
+}
+
+
+/*
+ * Function: cpu_update
+ * --------------------
+ * Plays the computer opponent's half for a game update: moves its paddle
+ * towards where the ball will reach it, and hits the ball back or
+ * concedes when it gets there. Takes the same time every update.
+ *
+*/
+void cpu_update(void)
+{
+    if (!level || phase == CPU_WAITING) {
+        return;
+    }
+    if (reaction) {
+        reaction--;
+    } else if (move_wait) {
+        move_wait--;
+    } else if (paddle_bottom != target) {
+        paddle_bottom += paddle_bottom < target ? 1 : -1;
+        move_wait = CPU_MOVE_UPDATES - 1;
+    }
+    if (updates && --updates) {
+        return;
+    }
+    if (phase == CPU_INCOMING) {
+        reach_paddle();
+    } else {
+        // Serves to itself after a miss, as the other board would
+        ball_initial_state(&ball);
+        follow(0);
+    }
+}
@@ -0,0 +1,53 @@
+/** @file   cpu.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for the computer opponent, which plays
+            the other board's half of the game when there is only one
+            board. It takes the ball packets this board sends in place
+            of IR and sends back its own, predicting where each ball
+            will reach its paddle as soon as it is sent rather than
+            following it an update at a time.
+*/
+
+#ifndef CPU_H
+#define CPU_H
+
+#include "system.h"
+
+#define CPU_LEVELS 4 // Difficulties, 1 is the easiest
+
+
+/*
+ * Function: cpu_start
+ * --------------------
+ * Starts the computer opponent, sending and receiving this board's
+ * packets through it instead of IR
+ *
+ * uint8_t new_level: Difficulty from 1 to CPU_LEVELS, the higher the level
+ * the sooner the opponent reacts to a ball
+ * int winning_score: Score the game is played to
+ *
+*/
+void cpu_start(uint8_t new_level, int winning_score);
+
+
+/*
+ * Function: cpu_stop
+ * --------------------
+ * Stops the computer opponent, going back to IR
+ *
+*/
+void cpu_stop(void);
+
+
+/*
+ * Function: cpu_update
+ * --------------------
+ * Plays the computer opponent's half for a game update: moves its paddle
+ * towards where the ball will reach it, and hits the ball back or
+ * concedes when it gets there. Takes the same time every update.
+ *
+*/
+void cpu_update(void);
+
+#endif
@@ -0,0 +1,219 @@
+/** @file   discovery.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module pairs two boards over IR with beacons, and agrees
+            which of them serves.
+*/
+
+
+#include "system.h"
+#include "timer.h"
+#include "hal.h"
+#include "packet.h"
+#include "discovery.h"
+
+#define BEACON_NONCE_INDEX 0
+#define BEACON_HEARD_INDEX 1 // Nonce of the board the sender has heard, 0 for none
+#define BEACON_FLAGS_INDEX 2
+#define BEACON_PAYLOAD_SIZE 3
+
+// Beacon flags
+#define BEACON_PAIRED BIT(0) // The sender is paired
+#define BEACON_PEER_PAIRED BIT(1) // The sender knows the board it heard is paired too
+
+
+static uint16_t rng; // Random number state, never 0
+static uint8_t nonce; // Nonce in this board's beacons, never 0
+static uint8_t peer; // Nonce of the other board, 0 until it is heard
+static uint8_t heard_back; // True once the other board has heard this one's nonce
+static uint8_t peer_paired; // True once the other board has said it is paired
+static uint16_t window; // Random part of the gap before the next beacon while searching
+static uint16_t beacon_at; // Tick the next beacon is sent at
+static uint16_t heard_at; // Tick the other board was last heard
+
+
+/*
+ * Function: random_next
+ * --------------------
+ * Returns: the next of the random numbers, a 16 bit xorshift
+*/
+static uint16_t random_next(void)
+{
+    rng ^= rng << 7;
+    rng ^= rng >> 9;
+    rng ^= rng << 8;
+    return rng;
+}
+
+
+/*
+ * Function: nonce_draw
+ * --------------------
+ * Draws a new nonce, different to the last and to the other board's
+ *
+*/
+static void nonce_draw(void)
+{
+    uint8_t last = nonce;
+
+    do {
+        nonce = (uint8_t) random_next();
+    } while (!nonce || nonce == last || nonce == peer);
+}
+
+
+/*
+ * Function: beacon_send
+ * --------------------
+ * Sends a beacon and works out when the next one is due
+ *
+*/
+static void beacon_send(void)
+{
+    uint8_t payload[BEACON_PAYLOAD_SIZE];
+    uint16_t now = hal_timer_get();
+
+    if (peer) {
+        beacon_at = now + DISCOVERY_KEEPALIVE - DISCOVERY_ANSWER_MAX + random_next() % DISCOVERY_ANSWER_MAX;
+    } else {
+        // No one has answered, so the next beacon is one with a new nonce
+        // after a longer wait, as there may be no one there
+        nonce_draw();
+        beacon_at = now + DISCOVERY_GAP + random_next() % window;
+        if (window < DISCOVERY_WINDOW_MAX / 2) {
+            window *= 2;
+        }
+    }
+    payload[BEACON_NONCE_INDEX] = nonce;
+    payload[BEACON_HEARD_INDEX] = peer;
+    payload[BEACON_FLAGS_INDEX] = (discovery_paired() ? BEACON_PAIRED : 0)
+        | (peer_paired ? BEACON_PEER_PAIRED : 0);
+    packet_send(PACKET_BEACON, payload, BEACON_PAYLOAD_SIZE);
+}
+
+
+/*
+ * Function: forget
+ * --------------------
+ * Forgets the other board and searches again from the shortest gaps
+ *
+*/
+static void forget(void)
+{
+    peer = 0;
+    heard_back = 0;
+    peer_paired = 0;
+    window = DISCOVERY_WINDOW_MIN;
+}
+
+
+/*
+ * Function: discovery_init
+ * --------------------
+ * Starts searching for the other board, the first beacon going out
+ * after a random wait
+ *
+ * uint16_t seed: Seed for the random numbers, different on each board,
+ * see hal_random_seed()
+ *
+*/
+void discovery_init(uint16_t seed)
+{
+    rng = seed ? seed : 1;
+    nonce = 0;
+    forget();
+    nonce_draw();
+    beacon_at = hal_timer_get() + random_next() % DISCOVERY_WINDOW_MIN;
+}
+
+
+/*
+ * Function: discovery_receive
+ * --------------------
+ * Takes in a PACKET_BEACON from the other board, or an echo of this
+ * board's own
+ *
+ * const packet_t *packet: Packet received
+ *
+*/
+void discovery_receive(const packet_t *packet)
+{
+    uint8_t sender = packet->payload[BEACON_NONCE_INDEX];
+    uint8_t heard = packet->payload[BEACON_HEARD_INDEX];
+    uint8_t flags = packet->payload[BEACON_FLAGS_INDEX];
+    uint16_t now = hal_timer_get();
+
+    if (packet->type != PACKET_BEACON || packet->length != BEACON_PAYLOAD_SIZE || !sender) {
+        return;
+    }
+    // When the beacon arrived is different on the two boards, so it
+    // breaks any tie between them
+    rng ^= now;
+    if (!rng) {
+        rng = 1;
+    }
+    if (sender == nonce) {
+        if (heard != peer) {
+            // The other board drew the same nonce
+            nonce_draw();
+            forget();
+            beacon_at = now + random_next() % DISCOVERY_ANSWER_MAX;
+        }
+        return;
+    }
+    // A board not heard before, or the other board restarted, is taken
+    // on; either way this beacon says what it knows now
+    peer = sender;
+    heard_at = now;
+    heard_back = heard == nonce;
+    peer_paired = heard_back && (flags & BEACON_PAIRED);
+    // Answering straight away unless the other board knows already that
+    // both are paired
+    if (!(heard_back && (flags & BEACON_PEER_PAIRED))) {
+        beacon_at = now + random_next() % DISCOVERY_ANSWER_MAX;
+    }
+}
+
+
+/*
+ * Function: discovery_update
+ * --------------------
+ * Sends a beacon if one is due and forgets the other board if it has
+ * gone quiet. Called every few milliseconds while discovering.
+ *
+*/
+void discovery_update(void)
+{
+    uint16_t now = hal_timer_get();
+
+    if (peer && (uint16_t) (now - heard_at) >= DISCOVERY_TIMEOUT) {
+        forget();
+    }
+    if ((int16_t) (now - beacon_at) >= 0) {
+        beacon_send();
+    }
+}
+
+
+/*
+ * Function: discovery_paired
+ * --------------------
+ * Returns: 1 if this board has heard the other and knows it was heard
+ * back, 0 otherwise
+*/
+int discovery_paired(void)
+{
+    return peer && heard_back;
+}
+
+
+/*
+ * Function: discovery_serving
+ * --------------------
+ * Returns: 1 if both boards are paired and this one has the lower nonce,
+ * so its player serves, 0 otherwise
+*/
+int discovery_serving(void)
+{
+    return discovery_paired() && peer_paired && nonce < peer;
+}
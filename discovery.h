@@ -0,0 +1,101 @@
+/** @file   discovery.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for two boards finding each other over
+            IR as soon as they are switched on, with nothing pressed.
+
+            Each board sends beacons carrying a random nonce, the nonce
+            of the board it has heard, if any, and flags for whether it
+            is paired and whether it knows the other board is. While no
+            one answers the gaps between beacons are random and widen,
+            so two boards that start together soon stop talking over
+            each other, and a new nonce is drawn for each. A board that
+            hears a beacon answers it after a short random wait, unless
+            the beacon shows the other board knows both are paired, and
+            is paired once a beacon shows its own nonce was heard back.
+            That takes four beacons, about a tenth of a second at 2400
+            baud. A board that hears its own nonce from a beacon that
+            isn't its own echo draws another.
+
+            Both boards then know both nonces, so they agree without
+            another word that the one with the lower nonce serves, once
+            each knows the other is paired. Until the game starts paired
+            boards send a beacon every DISCOVERY_KEEPALIVE; if nothing is
+            heard from the other board for DISCOVERY_TIMEOUT it is
+            forgotten and this board searches again, and a beacon with a
+            different nonce, such as from the other board restarting,
+            starts pairing again with it.
+*/
+
+#ifndef DISCOVERY_H
+#define DISCOVERY_H
+
+#include "system.h"
+#include "timer.h"
+#include "packet.h"
+
+#define DISCOVERY_GAP (TIMER_RATE / 20) // Shortest gap between beacons, longer than one takes to send
+#define DISCOVERY_WINDOW_MIN (TIMER_RATE / 16) // Random part of the first gaps while searching
+#define DISCOVERY_WINDOW_MAX (TIMER_RATE / 2) // It doubles up to this while no one answers
+#define DISCOVERY_ANSWER_MAX (TIMER_RATE / 50) // Longest random wait before answering a beacon
+#define DISCOVERY_KEEPALIVE (TIMER_RATE / 4) // Between beacons once paired
+#define DISCOVERY_TIMEOUT TIMER_RATE // Silence before the other board is forgotten
+
+#if DISCOVERY_GAP + DISCOVERY_WINDOW_MAX >= 32768 || DISCOVERY_TIMEOUT >= 65536
+#error "The discovery times don't fit the 16 bit timer"
+#endif
+
+
+/*
+ * Function: discovery_init
+ * --------------------
+ * Starts searching for the other board, the first beacon going out
+ * after a random wait
+ *
+ * uint16_t seed: Seed for the random numbers, different on each board,
+ * see hal_random_seed()
+ *
+*/
+void discovery_init(uint16_t seed);
+
+
+/*
+ * Function: discovery_receive
+ * --------------------
+ * Takes in a PACKET_BEACON from the other board, or an echo of this
+ * board's own
+ *
+ * const packet_t *packet: Packet received
+ *
+*/
+void discovery_receive(const packet_t *packet);
+
+
+/*
+ * Function: discovery_update
+ * --------------------
+ * Sends a beacon if one is due and forgets the other board if it has
+ * gone quiet. Called every few milliseconds while discovering.
+ *
+*/
+void discovery_update(void);
+
+
+/*
+ * Function: discovery_paired
+ * --------------------
+ * Returns: 1 if this board has heard the other and knows it was heard
+ * back, 0 otherwise
+*/
+int discovery_paired(void);
+
+
+/*
+ * Function: discovery_serving
+ * --------------------
+ * Returns: 1 if both boards are paired and this one has the lower nonce,
+ * so its player serves, 0 otherwise
+*/
+int discovery_serving(void);
+
+#endif
@@ -0,0 +1,32 @@
+/** @file   fixed.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  8.8 fixed-point arithmetic, used for sub-pixel positions and
+            velocities without pulling floating point into the AVR build.
+*/
+
+#ifndef FIXED_H
+#define FIXED_H
+
+#include "system.h"
+
+#define FIXED_FRAC_BITS 8
+#define FIXED_ONE (1 << FIXED_FRAC_BITS)
+#define FIXED_HALF (FIXED_ONE / 2)
+
+// Converts a whole number of pixels to fixed-point
+#define FIXED_FROM_INT(N) ((fixed_t) ((N) * FIXED_ONE))
+
+// Rounds a fixed-point value to the nearest whole pixel
+#define FIXED_TO_INT(F) ((int) (((F) + FIXED_HALF) >> FIXED_FRAC_BITS))
+
+// Multiplies two fixed-point values, widening so the product can't overflow
+#define FIXED_MUL(A, B) ((fixed_t) (((int32_t) (A) * (B)) >> FIXED_FRAC_BITS))
+
+// Converts a speed in pixels per second to fixed-point pixels per update
+#define FIXED_PER_TICK(PIXELS_PER_SECOND, RATE) \
+    ((fixed_t) ((PIXELS_PER_SECOND) * FIXED_ONE / (RATE)))
+
+typedef int16_t fixed_t;
+
+#endif
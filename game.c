@@ -9,55 +9,213 @@
 #include "system.h"
 #include "navswitch.h"
 #include "pio.h"
-#include "task.h"
 #include "led.h"
 #include "tinygl.h"
 #include "ir_uart.h"
-#include "../fonts/font5x7_1.h"
+#include "ir_rx.h"
+#include "input.h"
+#include "packet.h"
+#include "link.h"
+#include "probe.h"
+#include "record.h"
+#include "render.h"
+#include "sched.h"
+#include "hal.h"
+#include "geometry.h"
 #include "ball.h"
 #include "paddle.h"
+#include "cpu.h"
+#include "state.h"
+#include "resync.h"
+#include "ring.h"
+#include "broadcast.h"
+#include "banner.h"
+#include "discovery.h"
 
 
 #define DISPLAY_TASK_RATE 300
-#define GAME_TASK_RATE 2
-#define NAVSWITCH_TASK_RATE 20
+#define GAME_TASK_RATE BALL_UPDATE_RATE
+#define NAVSWITCH_TASK_RATE 20 // Polled to catch any transition the debouncing hid
+#define IR_TASK_PERIOD (SCHED_RATE / GAME_TASK_RATE)
 
+#ifndef WINNING_SCORE // Can be overridden to try other match lengths
 #define WINNING_SCORE 3
-#define TEXT_SCROLL_SPEED 10
-#define ASCII_DIFFERENCE 48
+#endif
+#define TEXT_SCROLL_SPEED 10 // Characters per 10 seconds
+#define SCORE_FLASH_UPDATES (GAME_TASK_RATE / 2)
 
-#define INITIAL_BALL_X_POS 0
-#define INITIAL_BALL_Y_POS 3
+#define MULTI_BALL_NAVSWITCH NAVSWITCH_NORTH // Starts a game with every ball in the pool
+#define MULTI_BALL_SPACING_X 2 // Pixels between the extra balls queued behind the border
+#define MULTI_BALL_SPACING_Y 2 // Rows between the extra balls
 
-#define READY 'R'
-#define INITIALIZATION_STATE 'I'
-#define PLAYING_STATE 'P'
-#define END_STATE 'E'
+#if WINNING_SCORE > STATE_SCORE_MAX
+#error "WINNING_SCORE is too high for the scores in game_state_t"
+#endif
+#if WINNING_SCORE > BALL_SCORE_MASK
+#error "WINNING_SCORE is too high to send beside the row in a PACKET_BALL"
+#endif
+#if WINNING_SCORE >= BANNER_DIGITS_NUM
+#error "WINNING_SCORE is too high for the digits rendered for the end of game text"
+#endif
+#if BALL_POOL_SIZE > STATE_BALLS || SCORE_FLASH_UPDATES > STATE_FLASH_MAX
+#error "game_state_t is too small for the balls or the score flash"
+#endif
 
+enum {NAVSWITCH_TASK, GAME_TASK, IR_TASK, DISPLAY_TASK, TASKS_NUM};
 
-char state; // State of the game
-int this_score; // Score of this other player
-int their_score; // Score of the other player
-int player_num; // Number used to determine who starts
-int ball_visible; // Number used to keep track of what screen the ball is on
-int just_scored; // Number used to keep track of when someone just scored
+// Pushes that start a game against the computer, from the easiest level
+static const uint8_t cpu_navswitches[CPU_LEVELS] = {NAVSWITCH_NORTH, NAVSWITCH_EAST,
+                                                     NAVSWITCH_SOUTH, NAVSWITCH_WEST};
+
+
+game_state_t game; // State of the game, packed, see state.h
+packet_t held_packets[BALL_POOL_SIZE]; // Ball packets waiting for their balls to leave this screen
+uint8_t holding_packets; // Balls with a packet in held_packets, BIT(id) for each
+int probe_dumping; // True while the task timings are being sent over IR
+sched_task_t tasks[TASKS_NUM]; // Tasks run throughout the game, set up in main()
+
+
+/*
+ * Function: set_state
+ * --------------------
+ * Changes the state of the game, suspending the tasks that have nothing
+ * to do in the new state so the CPU can sleep instead of running them
+ *
+ * uint8_t new_state: State to change to, one of the phases in state.h
+ *
+ */
+void set_state(uint8_t new_state)
+{
+    game.phase = new_state;
+    switch(game.phase) {
+    case INITIALIZATION_STATE:
+        sched_task_suspend(&tasks[GAME_TASK]);
+        break;
+    case PLAYING_STATE:
+        sched_task_resume(&tasks[GAME_TASK]);
+        break;
+    case END_STATE:
+        // Only the display is left to scroll the final score, and the IR
+        // task waiting for a query for the task timings. The game task
+        // keeps the link going and writes out the match recording until
+        // both are done, see game_task_().
+        sched_task_suspend(&tasks[NAVSWITCH_TASK]);
+        if (!probe_dumping) {
+            tasks[IR_TASK].period = 0;
+        }
+        record_finish();
+        break;
+    }
+}
+
+
+/*
+ * Function: set_ball_visible
+ * --------------------
+ * Sets which balls are on this screen, publishing them for drawing
+ *
+ * int visible: Bitmask of the balls on this screen, 1 for just the
+ * first ball and 0 for none
+ *
+ */
+void set_ball_visible(int visible)
+{
+    game.ball_visible = visible;
+    render_ball_show(visible);
+}
 
 
 /*
- * Function: display_msg
+ * Function: game_state_get
  * --------------------
- * Simple method to display a given message on the led matrix
+ * Takes a snapshot of the game, including the paddle
  *
- * char* msg: Message to be displayed
+ * game_state_t *snapshot: Filled in with the state of the game
  *
  */
-void display_msg(char* msg)
+void game_state_get(game_state_t *snapshot)
 {
-    tinygl_font_set (&font5x7_1);
-    tinygl_text_mode_set (TINYGL_TEXT_MODE_SCROLL);
-    tinygl_text_speed_set (TEXT_SCROLL_SPEED);
-    tinygl_clear();
-    tinygl_text(msg);
+    *snapshot = game;
+    snapshot->paddle_bottom = get_paddle_bottom().y;
+}
+
+
+/*
+ * Function: game_state_set
+ * --------------------
+ * Puts the game back to a snapshot from game_state_get(), moving the
+ * paddle and showing the balls to match. The tasks are left running as
+ * they are.
+ *
+ * const game_state_t *snapshot: State to restore
+ *
+ */
+void game_state_set(const game_state_t *snapshot)
+{
+    game = *snapshot;
+    set_paddle_position(snapshot->paddle_bottom);
+    render_ball_show(game.ball_visible);
+}
+
+
+/*
+ * Function: send_ball
+ * --------------------
+ * Sends a ball to the other player with this player's conceded points,
+ * keeping a copy in case the packet is lost
+ *
+ * uint8_t id: Ball to send
+ *
+ */
+void send_ball(uint8_t id)
+{
+    uint8_t side = ring_border_side(); // Of the other player's half of the court
+
+    PROBE_START(PROBE_SEND_BALL_POSITION);
+    send_ball_to(id, game.their_score, ring_handoff(side), ring_address(side));
+    PROBE_STOP(PROBE_SEND_BALL_POSITION);
+    resync_ball_sent(id, game.their_score);
+}
+
+
+/*
+ * Function: relay_ball
+ * --------------------
+ * Passes a ball just taken by a board in the middle of a ring on to the
+ * next board, with the score of the player it is heading for. Such a
+ * board keeps the right hand player's score as this_score and the left
+ * hand player's as their_score.
+ *
+ * uint8_t id: Ball to pass on
+ * uint8_t from: Side the ball came from, RING_LEFT or RING_RIGHT
+ *
+ */
+void relay_ball(uint8_t id, uint8_t from)
+{
+    uint8_t to = !from;
+
+    send_ball_to(id, to == RING_RIGHT ? game.this_score : game.their_score, ring_handoff(to),
+                 ring_address(to));
+}
+
+
+/*
+ * Function: start_multi_ball
+ * --------------------
+ * Puts the rest of the balls in the pool into play as well as the first,
+ * queued up behind the border on different rows so they come onto this
+ * screen one after another
+ *
+ */
+void start_multi_ball(void)
+{
+    uint8_t id;
+
+    for (id = 1; id < BALL_POOL_SIZE; id++) {
+        set_ball_position(id, INITIAL_BALL_X_POS - MULTI_BALL_SPACING_X * id,
+                          (INITIAL_BALL_Y_POS + MULTI_BALL_SPACING_Y * id) % GRID_HEIGHT);
+        game.ball_incoming |= BIT(id);
+    }
 }
 
 
@@ -65,44 +223,60 @@ void display_msg(char* msg)
  * Function: display_task
  * --------------------
  * Task to handle the displaying of information throughout the game.
- * Used in a task scheduler, behaves differently based on the current
+ * Run from the timer interrupt, so a column is lit on time however long
+ * the other tasks take, and behaves differently based on the current
  * game state.
  *
  */
 void display_task_(__unused__ void *data)
 {
     static int displaying_end_text = 0; // Var used to determine if end game text displayed
-    tinygl_update(); // Refreshing tinygl
-    char* score_string;
-    switch(state) {
+    static int rendering = 0; // Var used to determine if the grid has been set up
+    uint8_t message[BANNER_PIECES_MAX]; // End game text, as pieces rendered when built
+    uint8_t message_length = 0;
+    static uint8_t display_column = 0; // Column lit this call, a column each call
+    PROBE_START(PROBE_DISPLAY_TASK);
+    if (rendering) {
+        render_column(display_column); // Lighting the grid straight from its columns
+    } else {
+        banner_column(display_column); // Scrolling the message straight from its columns
+        banner_update();
+    }
+    input_latency_display(display_column);
+    display_column = (display_column + 1) % GRID_WIDTH;
+    switch(game.phase) {
     case INITIALIZATION_STATE:
         // Empty
         break;
     case PLAYING_STATE:
-        // Clears previous board state, then draws the paddle and ball on the display
-        tinygl_clear();
-        tinygl_draw_line(get_paddle_top(), get_paddle_bottom(), 1);
-        if (ball_visible) {
-            tinygl_draw_point(get_ball(), 1);
+        // Clears the start text once, then only rebuilds the grid when
+        // the paddle or a ball has moved
+        if (!rendering) {
+            render_reset();
+            rendering = 1;
         }
+        render_update();
         break;
     case END_STATE:
         // Displays the final game outcome and score
         if (!displaying_end_text) {
-            if (this_score == WINNING_SCORE) {
-                score_string = "Win ";
-                score_string[4] = this_score + ASCII_DIFFERENCE;
-                score_string[5] = '\0';
+            rendering = 0;
+            if (ring_is_court()) {
+                // Both players' scores, the left hand player's first
+                message[message_length++] = BANNER_DIGITS + game.their_score;
+                message[message_length++] = BANNER_DASH;
+            } else if (game.this_score == WINNING_SCORE) {
+                message[message_length++] = BANNER_WIN;
             } else {
-                score_string = "Lose ";
-                score_string[5] = this_score + ASCII_DIFFERENCE;
-                score_string[6] = '\0';
+                message[message_length++] = BANNER_LOSE;
             }
-            display_msg(score_string);
+            message[message_length++] = BANNER_DIGITS + game.this_score;
+            banner_show(message, message_length);
             displaying_end_text = 1;
         }
         break;
     }
+    PROBE_STOP(PROBE_DISPLAY_TASK);
 }
 
 
@@ -110,31 +284,39 @@ void display_task_(__unused__ void *data)
  * Function: navswitch_task
  * --------------------
  * Task to handle the inputs from the navswitch throughout the game.
- * Used in a task scheduler, behaves different based on the current
- * game state.
+ * Used in a task scheduler, run as soon as the navswitch is pushed or
+ * released, behaves different based on the current game state.
  *
  */
 void navswitch_task_(__unused__ void *data)
 {
-    navswitch_update(); // Updating the navswitch
-    switch(state) {
+    input_event_t event; // Navswitch transition from the input queue
+    PROBE_START(PROBE_NAVSWITCH_TASK);
+    input_poll(); // Catching any transition the debouncing hid
+    record_replay_resume();
+    switch(game.phase) {
     case INITIALIZATION_STATE:
         // Handles the starting of the game for both players
-        if (navswitch_push_event_p(NAVSWITCH_PUSH)) {
-            // If this microcontroller initiates the game
-            ir_uart_putc(PLAYING_STATE);
-            state = PLAYING_STATE;
-            player_num = 1;
-            ball_visible = 1;
-            set_ball_position(INITIAL_BALL_X_POS, INITIAL_BALL_Y_POS);
-            led_set(LED1, 0);
-        }
-        if (ir_uart_read_ready_p()) {
-            // If the other microcrontroller initiated the game
-            char incoming = ir_uart_getc();
-            if (incoming == PLAYING_STATE) {
-                state = PLAYING_STATE;
+        while (input_event_get(&event)) {
+            if (ring_is_court() || (ring_boards() == 2 && !game.cpu_opponent && !discovery_serving())) {
+                // Only the players at the ends can start the game, and
+                // between two boards only the one that won the toss
+                continue;
+            }
+            if (event.pressed && (event.navswitch == NAVSWITCH_PUSH
+                                  || (event.navswitch == MULTI_BALL_NAVSWITCH
+                                      && !game.cpu_opponent))) {
+                // If this microcontroller initiates the game
+                link_send(PACKET_START, 0, 0);
+                set_state(PLAYING_STATE);
+                game.player_num = 1;
+                set_ball_visible(1);
+                set_ball_position(0, INITIAL_BALL_X_POS, INITIAL_BALL_Y_POS);
+                if (event.navswitch == MULTI_BALL_NAVSWITCH) {
+                    start_multi_ball();
+                }
                 led_set(LED1, 0);
+                break;
             }
         }
         break;
@@ -146,6 +328,7 @@ void navswitch_task_(__unused__ void *data)
         // Empty
         break;
     }
+    PROBE_STOP(PROBE_NAVSWITCH_TASK);
 }
 
 
@@ -159,124 +342,403 @@ void navswitch_task_(__unused__ void *data)
  */
 void game_task_(__unused__ void *data)
 {
-    int ball_state; // Used to represent state of ball
-    switch(state) {
+    ball_events_t events; // Balls that scored, were hit or crossed this update
+    uint8_t arrived; // Balls that came onto this screen this update
+    uint8_t id; // Ball the events are being handled for
+    int score; // This player's score, from a ball sent by the other player
+    uint8_t from; // Side of the board a ball came from, in a ring
+    int handed_off = 0; // True if a ball was sent to another board this update
+    game_state_t snapshot; // Copy of the game, for spectators
+    PROBE_START(PROBE_GAME_TASK);
+    switch(game.phase) {
     case INITIALIZATION_STATE:
         // Empty
         break;
     case PLAYING_STATE:
-        // Check used to flash LED when someone scores
-        if (just_scored) {
-            just_scored = 0;
-            led_set(LED1, 0);
+        // The computer's half, if there's no other board
+        cpu_update();
+        // Acknowledging packets received and sending again any lost
+        link_update();
+        // LED1 flashes when someone scores, otherwise it shows how many
+        // packets are being lost
+        if (game.just_scored) {
+            game.just_scored--;
         }
+        led_set(LED1, game.just_scored || link_led());
         // Check used to determine if game is finished
-        if(their_score >= WINNING_SCORE || this_score >= WINNING_SCORE) {
-            send_ball_position(their_score);
-            state = END_STATE;
+        if(game.their_score >= WINNING_SCORE || game.this_score >= WINNING_SCORE) {
+            // The final score goes with a ball on this screen, which the
+            // other player can't be holding. A board in the middle of a
+            // ring has passed it on already.
+            id = 0;
+            while (id < BALL_POOL_SIZE - 1 && !((game.ball_visible | game.ball_incoming) & BIT(id))) {
+                id++;
+            }
+            if (!ring_is_court()) {
+                send_ball(id);
+            }
+            set_state(END_STATE);
+            // Spectators are sent the final score straight away
+            game_state_get(&snapshot);
+            broadcast_send(&snapshot);
         } else {
-            // If the game isn't finished, either update the balls position (If the
-            // ball is on this screen) other wise check if the ball is incoming from
-            // the other screen
-            if (ball_visible) {
-                ball_state = update_position();
-                if (ball_state == 1) {
-                    // Case when someone has scored
-                    their_score++;
-                    reset_ball();
-                    led_set(LED1, 1);
-                    just_scored = 1;
-                } else if (ball_state == -1) {
-                    // Case when ball has moved screen
-                    send_ball_position(their_score);
-                    ball_visible = 0;
+            // If the game isn't finished, update the positions of the balls
+            // on this screen, then follow any coming in from the other screen
+            if (game.ball_visible) {
+                PROBE_START(PROBE_UPDATE_BALLS);
+                update_balls(game.ball_visible, &events);
+                PROBE_STOP(PROBE_UPDATE_BALLS);
+                for (id = 0; id < BALL_POOL_SIZE; id++) {
+                    if (events.scored & BIT(id)) {
+                        // Case when someone has scored
+                        game.their_score++;
+                        reset_ball(id);
+                        led_set(LED1, 1);
+                        game.just_scored = SCORE_FLASH_UPDATES;
+                    } else if (events.hit & BIT(id)) {
+                        // Case when ball has been hit back, the other player
+                        // is told where it is going straight away
+                        send_ball(id);
+                        handed_off = 1;
+                    }
                 }
-            } else {
-                // Case where ball is on the other screen
-                if(ir_uart_read_ready_p()) {
-                    // Case where ball is moving from the other screen to this screen
-                    this_score = get_ball_position();
-                    ball_visible = 1;
+                if (events.crossed) {
+                    // Case when balls have moved screen
+                    set_ball_visible(game.ball_visible & ~events.crossed);
+                }
+            }
+            // A ball sent by the other player can only be taken once it
+            // has left this screen
+            for (id = 0; id < BALL_POOL_SIZE; id++) {
+                if (holding_packets & ~(game.ball_visible | game.ball_incoming) & BIT(id)) {
+                    from = ring_side_of(&held_packets[id]);
+                    PROBE_START(PROBE_GET_BALL_POSITION);
+                    score = get_ball_position(&held_packets[id], &id);
+                    PROBE_STOP(PROBE_GET_BALL_POSITION);
+                    // A ball sent again after being lost can carry an older
+                    // score than a snapshot already gave, see resync.h
+                    if (ring_is_court() && from == RING_RIGHT) {
+                        if (score > game.their_score) {
+                            game.their_score = score;
+                        }
+                    } else if (score > game.this_score) {
+                        game.this_score = score;
+                    }
+                    game.ball_incoming |= BIT(id);
+                    holding_packets &= ~BIT(id);
+                    if (ring_is_court()) {
+                        relay_ball(id, from);
+                        handed_off = 1;
+                    }
+                }
+            }
+            if (game.ball_incoming) {
+                // Case where balls are on their way from the other screen
+                arrived = balls_arriving(game.ball_incoming);
+                if (arrived) {
+                    game.ball_incoming &= ~arrived;
+                    set_ball_visible(game.ball_visible | arrived);
                 }
             }
+            // The computer can't lose packets, so there's nothing to check.
+            // Snapshots are only swapped between two boards.
+            if (!game.cpu_opponent && ring_boards() == 2) {
+                resync_update(&game);
+            }
+            // Spectators are sent the game every so often, if it won't
+            // hold up a ball
+            game_state_get(&snapshot);
+            broadcast_update(&snapshot, handed_off);
         }
         break;
     case END_STATE:
-        // Empty
+        // The ball with the final score is sent again until the next
+        // board along has it, as there are no snapshots once the game is
+        // over, and the rest of the match recording written out. Between
+        // two boards there is nothing else to do once both are done; a
+        // repeat arriving later wakes it, see ir_task_().
+        link_update();
+        if (ring_boards() == 2 && link_idle() && record_written_p()) {
+            sched_task_suspend(&tasks[GAME_TASK]);
+        }
         break;
     }
+    record_frame();
+    PROBE_STOP(PROBE_GAME_TASK);
 }
 
 
 /*
- * Function: setup_connection
+ * Function: probe_query
  * --------------------
- * Method used to ensure both devices are present before the game is started.
+ * Starts sending the task timings if a packet asks for them. The IR task
+ * runs periodically until they are all sent, a packet each time.
+ *
+ * const packet_t *packet: Packet received from the other microcontroller
  *
+ * Returns: 1 if the packet was a query for the task timings, 0 otherwise
  */
-void setup_connection(void)
+int probe_query(const packet_t *packet)
 {
-    int sent = 0; // True if confirmation sent
-    int rec = 0; // True if confirmation received
-    char input;
-
-    // Continuously checks for confirmation from both microcontrollers
-    while (!(rec && sent)) {
-        navswitch_update();
-        if (ir_uart_read_ready_p()) {
-            input = ir_uart_getc();
-            if (input == READY) {
-                rec = 1;
+    if (packet->type != PACKET_PROBE_QUERY) {
+        return 0;
+    }
+    probe_dump_start();
+    probe_dumping = 1;
+    tasks[IR_TASK].period = IR_TASK_PERIOD;
+    return 1;
+}
+
+
+/*
+ * Function: receive_packet
+ * --------------------
+ * Gets the next packet from the other microcontroller that is for the
+ * game, once the link has taken its own and any query for the task
+ * timings has been started. Frames for spectators are passed over.
+ *
+ * packet_t *packet: Filled in with the packet
+ *
+ * Returns: 1 if there was a packet for the game, 0 otherwise
+ */
+int receive_packet(packet_t *packet)
+{
+    while (packet_receive(packet)) {
+        if (link_receive(packet) && packet->type != PACKET_SPECTATE && !probe_query(packet)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * Function: ir_task
+ * --------------------
+ * Task used to handle the packets from the other microcontroller. Run
+ * as soon as IR data arrives, as well as periodically to pick up any
+ * packet left waiting until this board was ready for it.
+ *
+ */
+void ir_task_(__unused__ void *data)
+{
+    packet_t packet; // Packet received from the other microcontroller
+    game_state_t snapshot; // Copy of the game for a snapshot to be checked against
+    PROBE_START(PROBE_IR_TASK);
+    if (probe_dumping) {
+        probe_dumping = probe_dump_step();
+        if (!probe_dumping && game.phase == END_STATE) {
+            tasks[IR_TASK].period = 0;
+        }
+    }
+    switch(game.phase) {
+    case INITIALIZATION_STATE:
+        if (receive_packet(&packet)) {
+            if (packet.type == PACKET_START) {
+                // If the other microcrontroller initiated the game, passing it
+                // on along a ring
+                if (ring_is_court()) {
+                    link_send_to(ring_address(!ring_side_of(&packet)), PACKET_START, 0, 0);
+                }
+                set_state(PLAYING_STATE);
+                led_set(LED1, 0);
+            } else if (packet.type == PACKET_READY) {
+                // Boards before this one in a ring may still be connecting
+                ring_connect(&packet);
+            } else if (packet.type == PACKET_BEACON) {
+                discovery_receive(&packet);
+            }
+        }
+        if (game.phase == INITIALIZATION_STATE && ring_boards() == 2 && !game.cpu_opponent) {
+            // Keeping in touch with the other board until the game starts,
+            // LED1 going out while it is lost
+            discovery_update();
+            led_set(LED1, discovery_paired());
+        }
+        break;
+    case PLAYING_STATE:
+        if (receive_packet(&packet)) {
+            if (packet.type == PACKET_BALL) {
+                // Case where ball has been hit back towards this screen, the
+                // game task takes it once it has left this screen
+                resync_ball_received(ball_packet_id(&packet));
+                held_packets[ball_packet_id(&packet)] = packet;
+                holding_packets |= BIT(ball_packet_id(&packet));
+            } else if (packet.type == PACKET_RESYNC) {
+                // Case where the other player has sent a snapshot to check
+                resync_receive(&packet, &game);
             }
         }
-        if (navswitch_push_event_p(NAVSWITCH_PUSH)) {
-            ir_uart_putc(READY);
-            sent = 1;
+        break;
+    case END_STATE:
+        // The game is over, but the task timings can still be asked for,
+        // and the ball with the final score sent again if it was lost.
+        // The score on this screen is final, so only a copy is corrected.
+        if (receive_packet(&packet) && packet.type == PACKET_RESYNC) {
+            snapshot = game;
+            resync_receive(&packet, &snapshot);
+        }
+        // A repeat of the final ball, whose ACK was lost, is acknowledged
+        // again by the game task
+        if (!link_idle()) {
+            sched_task_resume(&tasks[GAME_TASK]);
+        }
+        break;
+    }
+    PROBE_STOP(PROBE_IR_TASK);
+}
+
+
+/*
+ * Function: connection_step
+ * --------------------
+ * Checks once whether both devices are present, so the game can be
+ * started. Two boards find each other by themselves, see discovery.h.
+ * Pushing the navswitch in a direction instead plays against the
+ * computer, at the level for the direction in cpu_navswitches. In a ring
+ * of more than two boards, pushing the navswitch down numbers the boards
+ * from this one instead, see ring.h.
+ *
+ * Returns: an int, 1 once connected, 0 if still waiting
+ */
+int connection_step(void)
+{
+    static int sent = 0; // True if confirmation sent
+    static int rec = 0; // True if confirmation received
+    packet_t packet; // Packet received from the other microcontroller
+    uint8_t level; // Computer level the pushes are checked for
+
+    navswitch_update();
+    if (ring_boards() > 2) {
+        if (packet_receive(&packet)) {
+            ring_connect(&packet);
+        }
+        if (navswitch_push_event_p(NAVSWITCH_PUSH)
+            && (ring_position() == RING_UNNUMBERED || ring_position() == 0)) {
+            ring_number(0);
+        }
+        rec = sent = ring_connected();
+    } else {
+        if (packet_receive(&packet) && packet.type == PACKET_BEACON) {
+            discovery_receive(&packet);
         }
+        discovery_update();
+        rec = sent = discovery_paired();
+        for (level = 0; level < CPU_LEVELS && !(rec && sent); level++) {
+            if (navswitch_push_event_p(cpu_navswitches[level])) {
+                cpu_start(level + 1, WINNING_SCORE);
+                game.cpu_opponent = 1;
+                rec = sent = 1;
+            }
+        }
+    }
+    if (!(rec && sent)) {
+        return 0;
     }
     led_set(LED1, 1); // Indicates connections
+    return 1;
 }
 
 
 /*
- * Main method of game.c.
- * Calls all required methods to run pong.
+ * Function: game_init
+ * --------------------
+ * Initializes the game and the systems it uses, ready to connect
+ *
  */
-int main (void)
+void game_init(void)
 {
     // Initializing required variables
-    state = INITIALIZATION_STATE;
-    this_score = 0;
-    their_score = 0;
-    player_num = 0;
-    ball_visible = 0;
-    just_scored = 0;
+    game = (game_state_t) {.phase = INITIALIZATION_STATE};
+    holding_packets = 0;
+    probe_dumping = 0;
+    resync_init();
+    ring_init(RING_BOARDS);
 
     // Initializing required systems
     system_init ();
+    timer_init(); // Running already for discovery, before the tasks start
+    discovery_init(hal_random_seed());
     navswitch_init();
     tinygl_init(DISPLAY_TASK_RATE);
+    banner_init(DISPLAY_TASK_RATE, TEXT_SCROLL_SPEED);
     ir_uart_init();
+    ir_rx_init();
     led_init();
     paddle_init();
     led_set(LED1, 0);
+}
 
 
-    // Establishing connection with other microcontroller
-    setup_connection();
+/*
+ * Function: game_start
+ * --------------------
+ * Sets the game up once connected, showing the start message and
+ * setting up the tasks for sched_run()
+ *
+ */
+void game_start(void)
+{
+    link_init(!game.cpu_opponent); // The computer can't lose packets
+    input_init();
+    record_init(); // Recording the match from here on, for replay
+    broadcast_init(BROADCAST_ENABLED && !ring_is_court()); // Spectators see the players' boards
+    if (ring_is_court()) {
+        // The ball passes straight through a board with no player
+        paddle_remove();
+        ball_far_border_set(1);
+    }
 
-    char* start_message = "PONG - Press down to start";
-    display_msg(start_message);
+    static const uint8_t start_message[] = {BANNER_START};
+    banner_show(start_message, ARRAY_SIZE(start_message));
 
 
     // Array of task to run throughout game
-    task_t tasks[] = {
-        {.func = navswitch_task_, .period = TASK_RATE / NAVSWITCH_TASK_RATE},
-        {.func = game_task_, .period = TASK_RATE / GAME_TASK_RATE},
-        {.func = display_task_, .period = TASK_RATE / DISPLAY_TASK_RATE}
-    };
+    tasks[NAVSWITCH_TASK] = (sched_task_t) {.func = navswitch_task_,
+                                            .period = SCHED_RATE / NAVSWITCH_TASK_RATE,
+                                            .events = SCHED_EVENT_INPUT,
+                                            .priority = SCHED_PRIORITY_HIGH};
+    tasks[GAME_TASK] = (sched_task_t) {.func = game_task_,
+                                       .period = SCHED_RATE / GAME_TASK_RATE};
+    tasks[IR_TASK] = (sched_task_t) {.func = ir_task_,
+                                     .period = IR_TASK_PERIOD,
+                                     .events = SCHED_EVENT_IR_RX};
+    // Lit from the timer interrupt, ahead of the other tasks
+    tasks[DISPLAY_TASK] = (sched_task_t) {.func = display_task_,
+                                          .period = SCHED_RATE / DISPLAY_TASK_RATE,
+                                          .priority = SCHED_PRIORITY_INTERRUPT};
+    set_state(INITIALIZATION_STATE);
+}
+
+
+/*
+ * Function: game_run
+ * --------------------
+ * Runs the game's tasks, set up by game_start(), sleeping between them.
+ * Only returns after sched_stop().
+ *
+ */
+void game_run(void)
+{
+    sched_run(tasks, TASKS_NUM);
+}
 
 
-    // Calling task scheduler on tasks array
-    task_schedule(tasks, ARRAY_SIZE(tasks));
+/*
+ * Main method of game.c.
+ * Calls all required methods to run pong.
+ */
+int main (void)
+{
+    game_init();
+
+    // Establishing connection with other microcontroller
+    while (!connection_step()) {
+        continue;
+    }
+    game_start();
+
+    // Calling task scheduler on tasks array, sleeping between tasks
+    game_run();
+    return 0;
 }
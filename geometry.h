@@ -0,0 +1,63 @@
+/** @file   geometry.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  The size of the playing grid and where the walls, goal,
+            paddle and serve are on it, for every module. The grid is
+            the whole display, so building for another LED matrix (an
+            8x8 add-on, or displays chained side by side) only needs
+            the board's matrix size; everything here follows from it
+            at compile time and is checked below.
+*/
+
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include "tinygl.h"
+
+
+#define GRID_WIDTH TINYGL_WIDTH // Columns, from the border to the paddle
+#define GRID_HEIGHT TINYGL_HEIGHT // Rows, from the bottom wall to the top
+
+#define BORDER_X 0 // Column next to the other player's screen
+#define GOAL_X (GRID_WIDTH - 1) // Column the paddle is in, a ball reaching it scores
+#define ONE_FROM_GOAL (GOAL_X - 1) // Column a ball is hit back from
+#define BOTTOM_WALL_Y 0
+#define TOP_WALL_Y (GRID_HEIGHT - 1)
+
+#define INITIAL_BALL_X_POS BORDER_X // Where a ball is served from
+#define INITIAL_BALL_Y_POS (TOP_WALL_Y / 2)
+
+#define PADDLE_X GOAL_X
+#define PADDLE_BOTTOM_INIT_Y ((GRID_HEIGHT - 3) / 2) // A three pixel paddle, centred
+#ifndef PADDLE_TOP_INIT_Y // Can be overridden to try other paddle lengths
+#define PADDLE_TOP_INIT_Y (PADDLE_BOTTOM_INIT_Y + 2)
+#endif
+
+// Bits a row number takes, which sets how a PACKET_BALL packs its row
+#if GRID_HEIGHT <= 2
+#define GRID_Y_BITS 1
+#elif GRID_HEIGHT <= 4
+#define GRID_Y_BITS 2
+#else
+#define GRID_Y_BITS 3
+#endif
+
+
+// A column of the grid is drawn from a byte, a bit per row, as the LED
+// matrix driver takes it
+#if GRID_HEIGHT > 8
+#error "GRID_HEIGHT is too tall for a byte per column"
+#endif
+#if GRID_WIDTH < 3
+#error "GRID_WIDTH leaves no room between the border and the paddle"
+#endif
+// Fixed-point x positions, and those sent across the border, are 8.8
+#if GRID_WIDTH > 63
+#error "GRID_WIDTH is too wide for fixed-point positions"
+#endif
+#if PADDLE_BOTTOM_INIT_Y < BOTTOM_WALL_Y || PADDLE_TOP_INIT_Y > TOP_WALL_Y \
+    || PADDLE_TOP_INIT_Y < PADDLE_BOTTOM_INIT_Y
+#error "PADDLE_TOP_INIT_Y does not fit the paddle on the grid"
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+/** @file   hal.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Hardware services the pong game needs beyond the kit drivers.
+            hal_avr.c implements them for the ATmega32U2 and
+            host/drivers/hal.c for the host build.
+*/
+
+#ifndef HAL_H
+#define HAL_H
+
+#include "system.h"
+
+
+/*
+ * Function: hal_interrupts_disable
+ * --------------------
+ * Disables interrupts, so data shared with an interrupt handler can be
+ * read or written as a whole
+ *
+ * Returns: the previous interrupt state, for hal_interrupts_restore()
+*/
+uint8_t hal_interrupts_disable(void);
+
+
+/*
+ * Function: hal_interrupts_restore
+ * --------------------
+ * Restores the interrupt state saved by hal_interrupts_disable()
+ *
+*/
+void hal_interrupts_restore(uint8_t state);
+
+
+/*
+ * Function: hal_ir_rx_interrupt_enable
+ * --------------------
+ * Enables the IR receive interrupt. From then on every received byte is
+ * handed to ir_rx_isr() as soon as it arrives, and must no longer be
+ * read with ir_uart_getc().
+ *
+*/
+void hal_ir_rx_interrupt_enable(void);
+
+
+
+/*
+ * Function: hal_navswitch_interrupt_enable
+ * --------------------
+ * Enables the navswitch pin change interrupts. From then on each time a
+ * direction is pushed or released input_isr() is called with the
+ * directions held down.
+ *
+*/
+void hal_navswitch_interrupt_enable(void);
+
+
+/*
+ * Function: hal_navswitch_down
+ * --------------------
+ * Reads the navswitch without debouncing
+ *
+ * Returns: a bitmask of the directions held down, a bit per NAVSWITCH_*
+ * direction
+*/
+uint8_t hal_navswitch_down(void);
+
+
+/*
+ * Function: hal_eeprom_write
+ * --------------------
+ * Starts writing a byte to EEPROM, without waiting for it to finish
+ *
+ * uint16_t address: Address to write to
+ * uint8_t byte: Byte to write
+ *
+ * Returns: 1 if the write was started, 0 if the last one is still busy
+*/
+int hal_eeprom_write(uint16_t address, uint8_t byte);
+
+
+/*
+ * Function: hal_eeprom_read
+ * --------------------
+ * Reads a byte from EEPROM
+ *
+ * uint16_t address: Address to read from
+ *
+ * Returns: the byte
+*/
+uint8_t hal_eeprom_read(uint16_t address);
+
+
+/*
+ * Function: hal_sleep_until
+ * --------------------
+ * Puts the CPU into idle sleep until the timer reaches a deadline or an
+ * event is posted, sleeping on through the timer interrupts in between.
+ * Doesn't sleep at all if the deadline has passed or an event is already
+ * pending; this is checked with interrupts disabled so an event posted
+ * just before sleeping isn't missed.
+ *
+ * uint16_t deadline: Timer tick to wake at
+ * volatile uint8_t *events: Pending events, see sched_event_post()
+ *
+*/
+void hal_sleep_until(uint16_t deadline, volatile uint8_t *events);
+
+
+/*
+ * Function: hal_tick_interrupt_enable
+ * --------------------
+ * Starts the timer interrupt, which calls sched_tick_isr() every period
+ * ticks of the timer from now on, however busy the CPU is
+ *
+ * uint16_t period: Timer ticks between interrupts
+ *
+*/
+void hal_tick_interrupt_enable(uint16_t period);
+
+
+/*
+ * Function: hal_tick_interrupt_disable
+ * --------------------
+ * Stops the timer interrupt
+ *
+*/
+void hal_tick_interrupt_disable(void);
+
+
+/*
+ * Function: hal_timer_get
+ * --------------------
+ * Reads the kit timer, as timer_get() does, but safe to call with
+ * interrupts enabled: on the kit the timer interrupt writes a 16 bit
+ * register of timer 1 through the same temporary byte that reading the
+ * count goes through, so the count is read with interrupts disabled
+ *
+ * Returns: the timer's tick count
+*/
+uint16_t hal_timer_get(void);
+
+
+/*
+ * Function: hal_timestamp
+ * --------------------
+ * Reads a free running count for timing code. Differences between two
+ * readings are only meaningful up to 65535 counts.
+ *
+ * Returns: the count, timer 1 on the kit (256 CPU cycles, 32 us per
+ * count) and nanoseconds on the host
+*/
+uint16_t hal_timestamp(void);
+
+
+/*
+ * Function: hal_random_seed
+ * --------------------
+ * Makes a seed for random numbers that differs from board to board and
+ * from one power up to the next. Takes a few tens of milliseconds on
+ * the kit, so is only called while starting up.
+ *
+ * Returns: the seed
+*/
+uint16_t hal_random_seed(void);
+
+#endif
@@ -0,0 +1,357 @@
+/** @file   hal_avr.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  ATmega32U2 implementation of the hardware services in hal.h
+*/
+
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/eeprom.h>
+#include <avr/wdt.h>
+#include "system.h"
+#include "pio.h"
+#include "navswitch.h"
+#include "hal.h"
+#include "ir_rx.h"
+#include "input.h"
+#include "sched.h"
+
+
+#define RANDOM_SEED_TIMEOUTS 4 // Watchdog timeouts timed for hal_random_seed(), 16 ms each
+
+// Navswitch pins, in NAVSWITCH_* order
+static const pio_t navswitch_pios[NAVSWITCH_NUM] = {
+    NAVSWITCH_NORTH_PIO, NAVSWITCH_EAST_PIO, NAVSWITCH_SOUTH_PIO,
+    NAVSWITCH_WEST_PIO, NAVSWITCH_PUSH_PIO
+};
+
+static uint16_t tick_period; // Timer ticks between timer interrupts
+
+
+/*
+ * Function: hal_interrupts_disable
+ * --------------------
+ * Disables interrupts, so data shared with an interrupt handler can be
+ * read or written as a whole
+ *
+ * Returns: the previous interrupt state, for hal_interrupts_restore()
+*/
+uint8_t hal_interrupts_disable(void)
+{
+    uint8_t state = SREG;
+
+    cli();
+    return state;
+}
+
+
+/*
+ * Function: hal_interrupts_restore
+ * --------------------
+ * Restores the interrupt state saved by hal_interrupts_disable()
+ *
+*/
+void hal_interrupts_restore(uint8_t state)
+{
+    SREG = state;
+}
+
+
+/*
+ * Function: timer1_read
+ * --------------------
+ * Reads the count of timer 1. Its high byte comes from the temporary
+ * byte latched when the low byte is read, which the timer interrupt
+ * overwrites when it sets OCR1B, so it is read with interrupts disabled.
+ *
+ * Returns: the count
+*/
+static uint16_t timer1_read(void)
+{
+    uint8_t state = hal_interrupts_disable();
+    uint16_t count = TCNT1;
+
+    hal_interrupts_restore(state);
+    return count;
+}
+
+
+/*
+ * Function: hal_ir_rx_interrupt_enable
+ * --------------------
+ * Enables the IR receive interrupt. From then on every received byte is
+ * handed to ir_rx_isr() as soon as it arrives, and must no longer be
+ * read with ir_uart_getc().
+ *
+*/
+void hal_ir_rx_interrupt_enable(void)
+{
+    UCSR1B |= BIT(RXCIE1);
+    sei();
+}
+
+
+/*
+ * USART1 receive complete interrupt, the IR receiver
+ */
+ISR(USART1_RX_vect)
+{
+    ir_rx_isr(UDR1);
+}
+
+
+/*
+ * Function: hal_navswitch_interrupt_enable
+ * --------------------
+ * Enables the navswitch pin change interrupts. From then on each time a
+ * direction is pushed or released input_isr() is called with the
+ * directions held down.
+ *
+*/
+void hal_navswitch_interrupt_enable(void)
+{
+    // North, south, west and push are on PC6, PC5, PC4 and PC2, pin
+    // change interrupts 8 to 11. East is on PC7, which only has external
+    // interrupt 4, set to trigger on either edge.
+    PCMSK1 = BIT(PCINT8) | BIT(PCINT9) | BIT(PCINT10) | BIT(PCINT11);
+    PCIFR = BIT(PCIF1);
+    PCICR |= BIT(PCIE1);
+    EICRB = (EICRB & ~BIT(ISC41)) | BIT(ISC40);
+    EIFR = BIT(INTF4);
+    EIMSK |= BIT(INT4);
+    sei();
+}
+
+
+/*
+ * Function: hal_navswitch_down
+ * --------------------
+ * Reads the navswitch without debouncing
+ *
+ * Returns: a bitmask of the directions held down, a bit per NAVSWITCH_*
+ * direction
+*/
+uint8_t hal_navswitch_down(void)
+{
+    uint8_t down = 0;
+    uint8_t i;
+
+    // The switches pull their pins low when pushed
+    for (i = 0; i < NAVSWITCH_NUM; i++) {
+        if (!pio_input_get(navswitch_pios[i])) {
+            down |= BIT(i);
+        }
+    }
+    return down;
+}
+
+
+/*
+ * Navswitch pin change interrupts
+ */
+ISR(PCINT1_vect)
+{
+    input_isr(hal_navswitch_down());
+}
+
+ISR(INT4_vect, ISR_ALIASOF(PCINT1_vect));
+
+
+/*
+ * Function: hal_eeprom_write
+ * --------------------
+ * Starts writing a byte to EEPROM, without waiting for it to finish
+ *
+ * uint16_t address: Address to write to
+ * uint8_t byte: Byte to write
+ *
+ * Returns: 1 if the write was started, 0 if the last one is still busy
+*/
+int hal_eeprom_write(uint16_t address, uint8_t byte)
+{
+    // A write takes 3.4 ms, eeprom_write_byte() only waits for the last
+    if (!eeprom_is_ready()) {
+        return 0;
+    }
+    eeprom_write_byte((uint8_t *) address, byte);
+    return 1;
+}
+
+
+/*
+ * Function: hal_eeprom_read
+ * --------------------
+ * Reads a byte from EEPROM
+ *
+ * uint16_t address: Address to read from
+ *
+ * Returns: the byte
+*/
+uint8_t hal_eeprom_read(uint16_t address)
+{
+    return eeprom_read_byte((const uint8_t *) address);
+}
+
+
+/*
+ * Function: hal_sleep_until
+ * --------------------
+ * Puts the CPU into idle sleep until the timer reaches a deadline or an
+ * event is posted, sleeping on through the timer interrupts in between.
+ * Doesn't sleep at all if the deadline has passed or an event is already
+ * pending; this is checked with interrupts disabled so an event posted
+ * just before sleeping isn't missed.
+ *
+ * uint16_t deadline: Timer tick to wake at
+ * volatile uint8_t *events: Pending events, see sched_event_post()
+ *
+*/
+void hal_sleep_until(uint16_t deadline, volatile uint8_t *events)
+{
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    // Timer 1 runs freely for the kit timer driver, so a compare match
+    // on channel A can wake the CPU without disturbing it. OCR1A is set
+    // with interrupts disabled, as the timer interrupt sets OCR1B through
+    // the same temporary byte.
+    cli();
+    OCR1A = deadline;
+    TIFR1 = BIT(OCF1A);
+    TIMSK1 |= BIT(OCIE1A);
+    while (!*events && (int16_t) (deadline - timer1_read()) > 0) {
+        sleep_enable();
+        // Interrupts are only enabled after the next instruction, so
+        // nothing can be handled between here and sleeping
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        cli();
+    }
+    TIMSK1 &= ~BIT(OCIE1A);
+    sei();
+}
+
+
+/*
+ * Timer 1 compare match A interrupt, only used to wake from sleep
+ */
+EMPTY_INTERRUPT(TIMER1_COMPA_vect);
+
+
+/*
+ * Function: hal_tick_interrupt_enable
+ * --------------------
+ * Starts the timer interrupt, which calls sched_tick_isr() every period
+ * ticks of the timer from now on, however busy the CPU is
+ *
+ * uint16_t period: Timer ticks between interrupts
+ *
+*/
+void hal_tick_interrupt_enable(uint16_t period)
+{
+    // Channel B of timer 1, as channel A wakes from sleep
+    cli();
+    tick_period = period;
+    OCR1B = timer1_read() + period;
+    TIFR1 = BIT(OCF1B);
+    TIMSK1 |= BIT(OCIE1B);
+    sei();
+}
+
+
+/*
+ * Function: hal_tick_interrupt_disable
+ * --------------------
+ * Stops the timer interrupt
+ *
+*/
+void hal_tick_interrupt_disable(void)
+{
+    TIMSK1 &= ~BIT(OCIE1B);
+}
+
+
+/*
+ * Timer 1 compare match B interrupt, the timer interrupt. The next one is
+ * set from when this one was due, not when it ran, so they keep to the
+ * period.
+ */
+ISR(TIMER1_COMPB_vect)
+{
+    uint16_t due = OCR1B;
+
+    OCR1B = due + tick_period;
+    sched_tick_isr(due);
+}
+
+
+/*
+ * Function: hal_timer_get
+ * --------------------
+ * Reads the kit timer, timer 1, with interrupts disabled. The kit's
+ * timer_get() reads TCNT1 as it is, which is only safe where interrupts
+ * are disabled already.
+ *
+ * Returns: the timer's tick count
+*/
+uint16_t hal_timer_get(void)
+{
+    return timer1_read();
+}
+
+
+/*
+ * Function: hal_timestamp
+ * --------------------
+ * Reads a free running count for timing code. Timer 0 generates the IR
+ * carrier and has no cycle counter to spare, so this is timer 1 as set
+ * up by the kit timer driver.
+ *
+ * Returns: the count, timer 1 on the kit (256 CPU cycles, 32 us per
+ * count) and nanoseconds on the host
+*/
+uint16_t hal_timestamp(void)
+{
+    return timer1_read();
+}
+
+
+/*
+ * Function: hal_random_seed
+ * --------------------
+ * Makes a seed for random numbers that differs from board to board and
+ * from one power up to the next. The watchdog runs from its own
+ * oscillator, which drifts against the crystal, so timer 1 is counted at
+ * the full CPU clock over a few watchdog timeouts and the low bits kept.
+ * Takes a few tens of milliseconds.
+ *
+ * Returns: the seed
+*/
+uint16_t hal_random_seed(void)
+{
+    uint8_t state = hal_interrupts_disable();
+    uint8_t clock = TCCR1B;
+    uint16_t seed = 0;
+    uint8_t i;
+
+    TCCR1B = (clock & ~(BIT(CS12) | BIT(CS11) | BIT(CS10))) | BIT(CS10);
+    wdt_reset();
+    // Watchdog interrupt mode at its shortest timeout, polled with
+    // interrupts disabled, so it never resets the board
+    WDTCSR = BIT(WDCE) | BIT(WDE);
+    WDTCSR = BIT(WDIF) | BIT(WDIE);
+    for (i = 0; i < RANDOM_SEED_TIMEOUTS; i++) {
+        while (!(WDTCSR & BIT(WDIF))) {
+            continue;
+        }
+        WDTCSR = BIT(WDIF) | BIT(WDIE);
+        seed = (seed << 5 | seed >> 11) ^ timer1_read();
+    }
+    MCUSR &= ~BIT(WDRF);
+    WDTCSR = BIT(WDCE) | BIT(WDE);
+    WDTCSR = 0;
+    TCCR1B = clock;
+    hal_interrupts_restore(state);
+    return seed;
+}
@@ -0,0 +1,101 @@
+/** @file   banner_gen.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Build tool that renders the pieces of the game's messages
+            (see banner.h) from the 5x7 font, as tinygl would draw them,
+            and writes them out as C source for the game to keep in
+            flash: a byte per column, a bit per row, with a blank column
+            after each glyph. Run by the Makefile on the machine doing
+            the build, against the kit's font for the kit and the host
+            stand-in for the host.
+
+            Usage: banner_gen > banner_data.c
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+#include "system.h"
+#include "font.h"
+#include "font5x7_1.h"
+#include "banner.h"
+
+
+#define COLUMNS_PER_LINE 12
+
+
+static const char *piece_texts[BANNER_PIECES] = BANNER_PIECE_TEXTS;
+
+
+/*
+ * Function: glyph_column
+ * --------------------
+ * Renders a column of a glyph
+ *
+ * char ch: Character of the glyph
+ * uint8_t col: Column of the glyph, BANNER_FONT_WIDTH for the blank
+ * column after it
+ *
+ * Returns: the column, a bit per row
+*/
+static uint8_t glyph_column(char ch, uint8_t col)
+{
+    uint8_t column = 0;
+    uint8_t row;
+
+    if (col >= BANNER_FONT_WIDTH) {
+        return 0;
+    }
+    for (row = 0; row < BANNER_FONT_HEIGHT; row++) {
+        if (font_pixel_get(&font5x7_1, ch, col, row)) {
+            column |= BIT(row);
+        }
+    }
+    return column;
+}
+
+
+int main(void)
+{
+    unsigned columns = 0;
+    unsigned on_line;
+    unsigned piece;
+    const char *ch;
+    uint8_t col;
+
+    if (font5x7_1.width != BANNER_FONT_WIDTH || font5x7_1.height != BANNER_FONT_HEIGHT) {
+        fprintf(stderr, "banner_gen: font5x7_1 is %ux%u, banner.h expects %ux%u\n",
+                font5x7_1.width, font5x7_1.height, BANNER_FONT_WIDTH, BANNER_FONT_HEIGHT);
+        return 1;
+    }
+
+    printf("/* Generated by host/banner_gen.c from font5x7_1, do not edit. */\n\n");
+    printf("#include <avr/pgmspace.h>\n#include \"system.h\"\n#include \"banner.h\"\n\n");
+
+    printf("const uint8_t banner_columns[] PROGMEM =\n{");
+    for (piece = 0; piece < BANNER_PIECES; piece++) {
+        printf("\n    // \"%s\"", piece_texts[piece]);
+        on_line = 0;
+        for (ch = piece_texts[piece]; *ch; ch++) {
+            for (col = 0; col < BANNER_GLYPH_COLUMNS; col++, on_line++) {
+                printf("%s0x%02x,", on_line % COLUMNS_PER_LINE ? " " : "\n    ",
+                       glyph_column(*ch, col));
+            }
+        }
+    }
+    printf("\n};\n\n");
+
+    printf("const uint16_t banner_starts[BANNER_PIECES + 1] PROGMEM =\n{\n   ");
+    for (piece = 0; piece < BANNER_PIECES; piece++) {
+        printf(" %u,", columns);
+        columns += strlen(piece_texts[piece]) * BANNER_GLYPH_COLUMNS;
+    }
+    printf(" %u\n};\n\n", columns);
+
+    printf("const char banner_texts[] PROGMEM =");
+    for (piece = 0; piece < BANNER_PIECES; piece++) {
+        printf("\n    \"%s\\0\"", piece_texts[piece]);
+    }
+    printf(";\n");
+    return 0;
+}
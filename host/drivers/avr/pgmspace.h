@@ -0,0 +1,19 @@
+/** @file   pgmspace.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for avr-libc's program memory access.
+            The host has one address space, so data kept in flash on
+            the kit is read like any other.
+*/
+
+#ifndef PGMSPACE_H
+#define PGMSPACE_H
+
+#include <stdint.h>
+
+#define PROGMEM
+
+#define pgm_read_byte(ADDRESS) (*(const uint8_t *) (ADDRESS))
+#define pgm_read_word(ADDRESS) (*(const uint16_t *) (ADDRESS))
+
+#endif
@@ -0,0 +1,138 @@
+/** @file   hal.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) implementation of the hardware services in
+            hal.h. The IR receive interrupt lives with the rest of the
+            simulated IR link in ir_uart.c.
+*/
+
+
+#include <time.h>
+#include "system.h"
+#include "timer.h"
+#include "hal.h"
+#include "host.h"
+
+
+static uint8_t eeprom[HOST_EEPROM_SIZE]; // Simulated EEPROM, erased until first written
+static bool eeprom_used; // True once the EEPROM has been written to
+
+
+/*
+ * Function: hal_interrupts_disable
+ * --------------------
+ * Nothing interrupts the host build, so there is nothing to disable
+ *
+ * Returns: 0
+*/
+uint8_t hal_interrupts_disable(void)
+{
+    return 0;
+}
+
+
+/*
+ * Function: hal_interrupts_restore
+ * --------------------
+ * Nothing interrupts the host build, so there is nothing to restore
+ *
+*/
+void hal_interrupts_restore(__unused__ uint8_t state)
+{
+}
+
+
+/*
+ * Function: hal_timer_get
+ * --------------------
+ * Reads the simulated timer, which nothing interrupts
+ *
+ * Returns: the timer's tick count
+*/
+uint16_t hal_timer_get(void)
+{
+    return timer_get();
+}
+
+
+/*
+ * Function: hal_timestamp
+ * --------------------
+ * Reads a free running count for timing code, from the wall clock as
+ * simulated time doesn't move while code runs
+ *
+ * Returns: the count, in nanoseconds
+*/
+uint16_t hal_timestamp(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint16_t) (now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+
+/*
+ * Function: hal_random_seed
+ * --------------------
+ * Makes a seed for random numbers from host_rand(), so runs with the
+ * same HOST_SEED pick the same numbers
+ *
+ * Returns: the seed
+*/
+uint16_t hal_random_seed(void)
+{
+    return (uint16_t) (host_rand() >> 8);
+}
+
+
+/*
+ * Function: hal_eeprom_write
+ * --------------------
+ * Writes a byte to the simulated EEPROM, which is never busy
+ *
+ * uint16_t address: Address to write to
+ * uint8_t byte: Byte to write
+ *
+ * Returns: 1
+*/
+int hal_eeprom_write(uint16_t address, uint8_t byte)
+{
+    uint16_t i;
+
+    if (!eeprom_used) {
+        for (i = 0; i < HOST_EEPROM_SIZE; i++) {
+            eeprom[i] = 0xFF;
+        }
+        eeprom_used = 1;
+    }
+    eeprom[address % HOST_EEPROM_SIZE] = byte;
+    return 1;
+}
+
+
+/*
+ * Function: hal_eeprom_read
+ * --------------------
+ * Reads a byte from the simulated EEPROM
+ *
+ * uint16_t address: Address to read from
+ *
+ * Returns: the byte, 0xFF if it has never been written
+*/
+uint8_t hal_eeprom_read(uint16_t address)
+{
+    return eeprom_used ? eeprom[address % HOST_EEPROM_SIZE] : 0xFF;
+}
+
+
+/*
+ * Function: host_eeprom
+ * --------------------
+ * Returns: the contents of the simulated EEPROM, HOST_EEPROM_SIZE bytes,
+ * or 0 if it has never been written
+*/
+const uint8_t *host_eeprom(void)
+{
+    return eeprom_used ? eeprom : 0;
+}
@@ -0,0 +1,127 @@
+/** @file   host.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Shared state of the host (Linux) backend: run bounds and the
+            random number generator used by the autopilot.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "system.h"
+#include "host.h"
+
+
+#define DEFAULT_SEED 1
+#define DEFAULT_TICK_LIMIT 10000000UL
+
+
+static uint32_t rand_state = DEFAULT_SEED; // State of the LCG
+static uint32_t tick_limit = DEFAULT_TICK_LIMIT; // Bound on a headless run
+static const char *eeprom_file; // File the EEPROM is saved to at exit, if any
+
+
+/*
+ * Function: save_eeprom
+ * --------------------
+ * Saves the simulated EEPROM, holding any match recording, to the file
+ * named by HOST_EEPROM
+ *
+*/
+static void save_eeprom(void)
+{
+    const uint8_t *eeprom = host_eeprom();
+    FILE *file;
+
+    if (!eeprom) {
+        return;
+    }
+    file = fopen(eeprom_file, "wb");
+    if (!file) {
+        perror(eeprom_file);
+        return;
+    }
+    fwrite(eeprom, 1, HOST_EEPROM_SIZE, file);
+    fclose(file);
+}
+
+
+/*
+ * Function: system_init
+ * --------------------
+ * Initializes the host backend, reading the HOST_TICKS and HOST_SEED
+ * environment variables used to bound and seed a headless run, and
+ * HOST_EEPROM naming a file to save the EEPROM to when it exits
+ *
+*/
+void system_init(void)
+{
+    char *value;
+
+    value = getenv("HOST_TICKS");
+    if (value) {
+        tick_limit = strtoul(value, NULL, 0);
+    }
+    value = getenv("HOST_SEED");
+    if (value) {
+        host_seed_set(strtoul(value, NULL, 0));
+    }
+    eeprom_file = getenv("HOST_EEPROM");
+    if (eeprom_file) {
+        atexit(save_eeprom);
+    }
+}
+
+
+/*
+ * Function: host_rand
+ * --------------------
+ * Deterministic pseudo random number generator seeded from HOST_SEED
+ *
+ * Returns: a 31 bit pseudo random number
+*/
+uint32_t host_rand(void)
+{
+    rand_state = rand_state * 1103515245UL + 12345UL;
+    return (rand_state >> 1) & 0x7fffffffUL;
+}
+
+
+/*
+ * Function: host_seed_set
+ * --------------------
+ * Reseeds host_rand()
+ *
+ * uint32_t seed: New seed
+ *
+*/
+void host_seed_set(uint32_t seed)
+{
+    rand_state = seed;
+}
+
+
+/*
+ * Function: host_tick_limit
+ * --------------------
+ * Returns: the number of scheduler ticks a headless run is bounded to,
+ * taken from HOST_TICKS, 0 meaning unbounded
+*/
+uint32_t host_tick_limit(void)
+{
+    return tick_limit;
+}
+
+
+/*
+ * Function: host_tick_limit_set
+ * --------------------
+ * Bounds a headless run, in place of HOST_TICKS
+ *
+ * uint32_t limit: Scheduler ticks to stop after, 0 for no limit
+ *
+*/
+void host_tick_limit_set(uint32_t limit)
+{
+    tick_limit = limit;
+}
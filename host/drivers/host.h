@@ -0,0 +1,215 @@
+/** @file   host.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Controls for the host (Linux) backend of the driver layer.
+            The game modules never include this; it is for host tools
+            that want to script input, wire up the IR link or inspect
+            what the board would be showing.
+*/
+
+#ifndef HOST_H
+#define HOST_H
+
+#include "system.h"
+
+#define HOST_EEPROM_SIZE 1024
+
+
+// Called by the simulated sleep before it moves time on, with the tick
+// it would sleep until and the data given to host_sleep_hook_set().
+// Returns the tick to wake at instead, no later; the current tick wakes
+// straight away, such as when the hook has raised an interrupt.
+typedef uint32_t (*host_sleep_hook_t)(uint32_t until, void *data);
+
+
+/*
+ * Function: host_rand
+ * --------------------
+ * Deterministic pseudo random number generator seeded from HOST_SEED
+ *
+ * Returns: a 31 bit pseudo random number
+*/
+uint32_t host_rand(void);
+
+
+/*
+ * Function: host_seed_set
+ * --------------------
+ * Reseeds host_rand()
+ *
+ * uint32_t seed: New seed
+ *
+*/
+void host_seed_set(uint32_t seed);
+
+
+/*
+ * Function: host_tick_limit
+ * --------------------
+ * Returns: the number of scheduler ticks a headless run is bounded to,
+ * taken from HOST_TICKS, 0 meaning unbounded
+*/
+uint32_t host_tick_limit(void);
+
+
+/*
+ * Function: host_tick_limit_set
+ * --------------------
+ * Bounds a headless run, in place of HOST_TICKS
+ *
+ * uint32_t limit: Scheduler ticks to stop after, 0 for no limit
+ *
+*/
+void host_tick_limit_set(uint32_t limit);
+
+
+/*
+ * Function: host_sleep_hook_set
+ * --------------------
+ * Hands the simulated sleep to a host tool, which can hold time back
+ * until it is safe to move on, deliver input on the way or wake the
+ * board early, such as to run boards in step on threads of their own
+ *
+ * host_sleep_hook_t hook: Called before each sleep, 0 for none
+ * void *data: Passed to the hook
+ *
+*/
+void host_sleep_hook_set(host_sleep_hook_t hook, void *data);
+
+
+/*
+ * Function: host_navswitch_press
+ * --------------------
+ * Queues a push event for the next navswitch_update() and turns the
+ * random autopilot off, so scripted input is reproduced exactly
+ *
+ * uint8_t navswitch: Direction to push
+ *
+*/
+void host_navswitch_press(uint8_t navswitch);
+
+
+/*
+ * Function: host_navswitch_autopilot_set
+ * --------------------
+ * Enables or disables the random autopilot, which pushes a random
+ * direction on roughly a quarter of navswitch updates
+ *
+*/
+void host_navswitch_autopilot_set(bool enable);
+
+
+/*
+ * Function: host_navswitch_next_change
+ * --------------------
+ * Returns: the tick the autopilot next pushes or releases the navswitch,
+ * or UINT32_MAX if it won't
+*/
+uint32_t host_navswitch_next_change(void);
+
+
+/*
+ * Function: host_navswitch_change
+ * --------------------
+ * Pushes a random direction, or releases the one pushed, and raises the
+ * pin change interrupt. Called by the simulated sleep once the tick from
+ * host_navswitch_next_change() is reached.
+ *
+*/
+void host_navswitch_change(void);
+
+
+/*
+ * Function: host_ir_loopback_set
+ * --------------------
+ * Chooses whether transmitted bytes are looped back to this board's
+ * receiver (the default, for a single headless board) or queued for
+ * host_ir_transmitted()
+ *
+*/
+void host_ir_loopback_set(bool enable);
+
+
+/*
+ * Function: host_ir_receive
+ * --------------------
+ * Delivers a byte to this board's IR receiver
+ *
+*/
+void host_ir_receive(uint8_t byte);
+
+
+/*
+ * Function: host_ir_transmitted
+ * --------------------
+ * Returns: the next byte this board transmitted, or -1 if there are none
+*/
+int host_ir_transmitted(void);
+
+
+/*
+ * Function: host_led_get
+ * --------------------
+ * Returns: the state of a simulated LED
+*/
+bool host_led_get(uint8_t led);
+
+
+/*
+ * Function: host_pixel_get
+ * --------------------
+ * Returns: the value last drawn to a pixel of the simulated matrix
+*/
+uint8_t host_pixel_get(uint8_t x, uint8_t y);
+
+
+/*
+ * Function: host_pixel_writes
+ * --------------------
+ * Returns: the number of pixels written to the simulated matrix so far,
+ * a hardware independent measure of drawing cost
+*/
+unsigned long host_pixel_writes(void);
+
+
+/*
+ * Function: host_column_get
+ * --------------------
+ * Returns: the pattern last lit in a column of the simulated LED matrix
+*/
+uint8_t host_column_get(uint8_t col);
+
+
+/*
+ * Function: host_column_writes
+ * --------------------
+ * Returns: the number of columns lit on the simulated LED matrix so far
+*/
+unsigned long host_column_writes(void);
+
+
+/*
+ * Function: host_text_get
+ * --------------------
+ * Returns: the text most recently passed to tinygl_text()
+*/
+const char *host_text_get(void);
+
+
+/*
+ * Function: host_eeprom
+ * --------------------
+ * Returns: the contents of the simulated EEPROM, HOST_EEPROM_SIZE bytes,
+ * or 0 if it has never been written
+*/
+const uint8_t *host_eeprom(void);
+
+
+/*
+ * Function: host_ticks
+ * --------------------
+ * Returns: the current simulated tick, in units of 1 / TIMER_RATE seconds
+*/
+uint32_t host_ticks(void);
+
+#endif
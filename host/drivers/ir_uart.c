@@ -0,0 +1,208 @@
+/** @file   ir_uart.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 IR UART driver
+*/
+
+
+#include "system.h"
+#include "ir_uart.h"
+#include "hal.h"
+#include "ir_rx.h"
+#include "host.h"
+
+
+#define QUEUE_SIZE 256 // Must be a power of two
+
+
+typedef struct {
+    uint8_t data[QUEUE_SIZE];
+    uint16_t head;
+    uint16_t tail;
+} queue_t;
+
+
+static queue_t rx_queue; // Bytes arriving at this board
+static queue_t tx_queue; // Bytes sent by this board, when not looped back
+static bool loopback = 1; // True if sent bytes arrive back at this board
+static bool rx_interrupt; // True if received bytes go straight to ir_rx_isr()
+
+
+/*
+ * Function: queue_put
+ * --------------------
+ * Appends a byte to a queue, dropping it if the queue is full like an
+ * overrun receiver would
+ *
+*/
+static void queue_put(queue_t *queue, uint8_t byte)
+{
+    if ((uint16_t) (queue->head - queue->tail) < QUEUE_SIZE) {
+        queue->data[queue->head++ & (QUEUE_SIZE - 1)] = byte;
+    }
+}
+
+
+/*
+ * Function: queue_get
+ * --------------------
+ * Returns: the oldest byte in a queue, or -1 if the queue is empty
+*/
+static int queue_get(queue_t *queue)
+{
+    if (queue->head == queue->tail) {
+        return -1;
+    }
+    return queue->data[queue->tail++ & (QUEUE_SIZE - 1)];
+}
+
+
+/*
+ * Function: receive
+ * --------------------
+ * Delivers a byte to this board, through the receive "interrupt" if it
+ * has been enabled, otherwise into the queue ir_uart_getc() reads
+ *
+*/
+static void receive(uint8_t byte)
+{
+    if (rx_interrupt) {
+        ir_rx_isr(byte);
+    } else {
+        queue_put(&rx_queue, byte);
+    }
+}
+
+
+/*
+ * Function: ir_uart_init
+ * --------------------
+ * Initializes the simulated IR link, emptying both queues
+ *
+ * Returns: 1 on success
+*/
+int8_t ir_uart_init(void)
+{
+    rx_queue.head = rx_queue.tail = 0;
+    tx_queue.head = tx_queue.tail = 0;
+    rx_interrupt = 0;
+    return 1;
+}
+
+
+/*
+ * Function: ir_uart_putc
+ * --------------------
+ * Sends a character over the simulated IR link
+ *
+*/
+void ir_uart_putc(char ch)
+{
+    if (loopback) {
+        receive((uint8_t) ch);
+    } else {
+        queue_put(&tx_queue, (uint8_t) ch);
+    }
+}
+
+
+/*
+ * Function: ir_uart_puts
+ * --------------------
+ * Sends a string over the simulated IR link
+ *
+*/
+void ir_uart_puts(const char *str)
+{
+    while (*str) {
+        ir_uart_putc(*str++);
+    }
+}
+
+
+/*
+ * Function: ir_uart_getc
+ * --------------------
+ * Reads a character from the simulated IR link, 0 if nothing arrived
+ *
+*/
+char ir_uart_getc(void)
+{
+    int byte = queue_get(&rx_queue);
+
+    return byte < 0 ? 0 : (char) byte;
+}
+
+
+/*
+ * Function: ir_uart_read_ready_p
+ * --------------------
+ * Returns: true if a character is waiting to be read
+ *
+*/
+bool ir_uart_read_ready_p(void)
+{
+    return rx_queue.head != rx_queue.tail;
+}
+
+
+/*
+ * Function: ir_uart_write_ready_p
+ * --------------------
+ * Returns: true, the simulated transmitter is never busy
+ *
+*/
+bool ir_uart_write_ready_p(void)
+{
+    return 1;
+}
+
+
+/*
+ * Function: hal_ir_rx_interrupt_enable
+ * --------------------
+ * Enables the simulated IR receive interrupt. From then on every
+ * received byte is handed to ir_rx_isr() as soon as it arrives.
+ *
+*/
+void hal_ir_rx_interrupt_enable(void)
+{
+    rx_interrupt = 1;
+}
+
+
+/*
+ * Function: host_ir_loopback_set
+ * --------------------
+ * Chooses whether transmitted bytes are looped back to this board's
+ * receiver (the default, for a single headless board) or queued for
+ * host_ir_transmitted()
+ *
+*/
+void host_ir_loopback_set(bool enable)
+{
+    loopback = enable;
+}
+
+
+/*
+ * Function: host_ir_receive
+ * --------------------
+ * Delivers a byte to this board's IR receiver
+ *
+*/
+void host_ir_receive(uint8_t byte)
+{
+    receive(byte);
+}
+
+
+/*
+ * Function: host_ir_transmitted
+ * --------------------
+ * Returns: the next byte this board transmitted, or -1 if there are none
+*/
+int host_ir_transmitted(void)
+{
+    return queue_get(&tx_queue);
+}
@@ -0,0 +1,71 @@
+/** @file   ir_uart.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 IR UART driver. Bytes are
+            queued in memory; by default everything sent is looped back
+            to the receiver, see host.h for other wiring.
+*/
+
+#ifndef IR_UART_H
+#define IR_UART_H
+
+#include "system.h"
+
+
+/*
+ * Function: ir_uart_init
+ * --------------------
+ * Initializes the simulated IR link, emptying both queues
+ *
+ * Returns: 1 on success
+*/
+int8_t ir_uart_init(void);
+
+
+/*
+ * Function: ir_uart_putc
+ * --------------------
+ * Sends a character over the simulated IR link
+ *
+*/
+void ir_uart_putc(char ch);
+
+
+/*
+ * Function: ir_uart_puts
+ * --------------------
+ * Sends a string over the simulated IR link
+ *
+*/
+void ir_uart_puts(const char *str);
+
+
+/*
+ * Function: ir_uart_getc
+ * --------------------
+ * Reads a character from the simulated IR link. The kit driver blocks
+ * when nothing has arrived, here 0 is returned instead since nothing
+ * else could run to deliver a byte.
+ *
+*/
+char ir_uart_getc(void);
+
+
+/*
+ * Function: ir_uart_read_ready_p
+ * --------------------
+ * Returns: true if a character is waiting to be read
+ *
+*/
+bool ir_uart_read_ready_p(void);
+
+
+/*
+ * Function: ir_uart_write_ready_p
+ * --------------------
+ * Returns: true, the simulated transmitter is never busy
+ *
+*/
+bool ir_uart_write_ready_p(void);
+
+#endif
@@ -0,0 +1,60 @@
+/** @file   led.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 LED driver
+*/
+
+
+#include "system.h"
+#include "led.h"
+#include "host.h"
+
+
+#define LEDS_NUM 1
+
+
+static bool leds[LEDS_NUM]; // Simulated LED states
+
+
+/*
+ * Function: led_init
+ * --------------------
+ * Initializes the (simulated) LEDs, turning them off
+ *
+*/
+void led_init(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < LEDS_NUM; i++) {
+        leds[i] = 0;
+    }
+}
+
+
+/*
+ * Function: led_set
+ * --------------------
+ * Sets the state of a simulated LED
+ *
+ * uint8_t led: LED to set
+ * bool state: 1 for on, 0 for off
+ *
+*/
+void led_set(uint8_t led, bool state)
+{
+    if (led < LEDS_NUM) {
+        leds[led] = state;
+    }
+}
+
+
+/*
+ * Function: host_led_get
+ * --------------------
+ * Returns: the state of a simulated LED
+*/
+bool host_led_get(uint8_t led)
+{
+    return led < LEDS_NUM && leds[led];
+}
@@ -0,0 +1,35 @@
+/** @file   led.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 LED driver
+*/
+
+#ifndef LED_H
+#define LED_H
+
+#include "system.h"
+
+#define LED1 0
+
+
+/*
+ * Function: led_init
+ * --------------------
+ * Initializes the (simulated) LEDs, turning them off
+ *
+*/
+void led_init(void);
+
+
+/*
+ * Function: led_set
+ * --------------------
+ * Sets the state of a simulated LED
+ *
+ * uint8_t led: LED to set
+ * bool state: 1 for on, 0 for off
+ *
+*/
+void led_set(uint8_t led, bool state);
+
+#endif
@@ -0,0 +1,70 @@
+/** @file   ledmat.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 LED matrix driver
+*/
+
+
+#include "system.h"
+#include "ledmat.h"
+#include "host.h"
+
+
+static uint8_t columns[LEDMAT_COLS_NUM]; // Pattern last lit in each column
+static unsigned long column_writes; // Number of columns lit
+
+
+/*
+ * Function: ledmat_init
+ * --------------------
+ * Initializes the simulated LED matrix, turning every column off
+ *
+*/
+void ledmat_init(void)
+{
+    uint8_t col;
+
+    for (col = 0; col < LEDMAT_COLS_NUM; col++) {
+        columns[col] = 0;
+    }
+}
+
+
+/*
+ * Function: ledmat_display_column
+ * --------------------
+ * Lights a column of the simulated LED matrix
+ *
+ * uint8_t pattern: LEDs to light, a bit per row
+ * uint8_t col: Column to light
+ *
+*/
+void ledmat_display_column(uint8_t pattern, uint8_t col)
+{
+    if (col < LEDMAT_COLS_NUM) {
+        columns[col] = pattern;
+        column_writes++;
+    }
+}
+
+
+/*
+ * Function: host_column_get
+ * --------------------
+ * Returns: the pattern last lit in a column of the simulated LED matrix
+*/
+uint8_t host_column_get(uint8_t col)
+{
+    return col < LEDMAT_COLS_NUM ? columns[col] : 0;
+}
+
+
+/*
+ * Function: host_column_writes
+ * --------------------
+ * Returns: the number of columns lit on the simulated LED matrix so far
+*/
+unsigned long host_column_writes(void)
+{
+    return column_writes;
+}
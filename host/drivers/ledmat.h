@@ -0,0 +1,33 @@
+/** @file   ledmat.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 LED matrix driver
+*/
+
+#ifndef LEDMAT_H
+#define LEDMAT_H
+
+#include "system.h"
+
+
+/*
+ * Function: ledmat_init
+ * --------------------
+ * Initializes the simulated LED matrix, turning every column off
+ *
+*/
+void ledmat_init(void);
+
+
+/*
+ * Function: ledmat_display_column
+ * --------------------
+ * Lights a column of the simulated LED matrix
+ *
+ * uint8_t pattern: LEDs to light, a bit per row
+ * uint8_t col: Column to light
+ *
+*/
+void ledmat_display_column(uint8_t pattern, uint8_t col);
+
+#endif
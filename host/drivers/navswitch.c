@@ -0,0 +1,190 @@
+/** @file   navswitch.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 navswitch driver
+*/
+
+
+#include "system.h"
+#include "navswitch.h"
+#include "timer.h"
+#include "hal.h"
+#include "input.h"
+#include "host.h"
+
+
+#define AUTOPILOT_ODDS 4
+#define AUTOPILOT_GAP_MAX (TIMER_RATE * 2 / 5) // Longest wait between pushes
+#define AUTOPILOT_HOLD (TIMER_RATE / 20) // Time each push is held for
+
+
+static uint8_t pending; // Bitmask of scripted pushes not yet latched
+static uint8_t events; // Bitmask of push events since the last update
+static bool autopilot = 1; // True if random pushes are generated
+static bool interrupt; // True once the pin change interrupts are enabled
+static uint8_t down; // Directions held down, for the pin change interrupts
+static uint32_t next_change; // Tick of the autopilot's next push or release
+
+
+/*
+ * Function: navswitch_init
+ * --------------------
+ * Initializes the simulated navswitch
+ *
+*/
+void navswitch_init(void)
+{
+    pending = 0;
+    events = 0;
+    interrupt = 0;
+    down = 0;
+}
+
+
+/*
+ * Function: navswitch_update
+ * --------------------
+ * Latches the pending simulated events so they can be polled
+ *
+*/
+void navswitch_update(void)
+{
+    events = pending;
+    pending = 0;
+    if (autopilot && host_rand() % AUTOPILOT_ODDS == 0) {
+        events |= BIT(host_rand() % NAVSWITCH_NUM);
+    }
+}
+
+
+/*
+ * Function: navswitch_down_p
+ * --------------------
+ * Returns: true if the given direction is currently held down
+ *
+*/
+bool navswitch_down_p(uint8_t navswitch)
+{
+    return (events & BIT(navswitch)) != 0;
+}
+
+
+/*
+ * Function: navswitch_push_event_p
+ * --------------------
+ * Returns: true if the given direction was pushed since the last update,
+ * the event is consumed by the call
+ *
+*/
+bool navswitch_push_event_p(uint8_t navswitch)
+{
+    bool pushed = (events & BIT(navswitch)) != 0;
+
+    events &= ~BIT(navswitch);
+    return pushed;
+}
+
+
+/*
+ * Function: navswitch_release_event_p
+ * --------------------
+ * Returns: false, the simulated navswitch has no release events
+ *
+*/
+bool navswitch_release_event_p(__unused__ uint8_t navswitch)
+{
+    return 0;
+}
+
+
+/*
+ * Function: host_navswitch_press
+ * --------------------
+ * Queues a push event for the next navswitch_update() and turns the
+ * random autopilot off, so scripted input is reproduced exactly
+ *
+ * uint8_t navswitch: Direction to push
+ *
+*/
+void host_navswitch_press(uint8_t navswitch)
+{
+    autopilot = 0;
+    pending |= BIT(navswitch);
+    if (interrupt) {
+        // Released again straight away, input_poll() picks that up
+        input_isr(down | BIT(navswitch));
+    }
+}
+
+
+/*
+ * Function: host_navswitch_autopilot_set
+ * --------------------
+ * Enables or disables the random autopilot, which pushes a random
+ * direction on roughly a quarter of navswitch updates, or once the pin
+ * change interrupts are enabled, every AUTOPILOT_GAP_MAX / 2 on average
+ *
+*/
+void host_navswitch_autopilot_set(bool enable)
+{
+    autopilot = enable;
+}
+
+
+/*
+ * Function: hal_navswitch_interrupt_enable
+ * --------------------
+ * Enables the simulated pin change interrupts, after which the autopilot
+ * pushes and releases the navswitch at random times
+ *
+*/
+void hal_navswitch_interrupt_enable(void)
+{
+    interrupt = 1;
+    next_change = host_ticks() + host_rand() % AUTOPILOT_GAP_MAX;
+}
+
+
+/*
+ * Function: hal_navswitch_down
+ * --------------------
+ * Returns: a bitmask of the directions held down, a bit per NAVSWITCH_*
+ * direction
+*/
+uint8_t hal_navswitch_down(void)
+{
+    return down;
+}
+
+
+/*
+ * Function: host_navswitch_next_change
+ * --------------------
+ * Returns: the tick the autopilot next pushes or releases the navswitch,
+ * or UINT32_MAX if it won't
+*/
+uint32_t host_navswitch_next_change(void)
+{
+    return interrupt && autopilot ? next_change : UINT32_MAX;
+}
+
+
+/*
+ * Function: host_navswitch_change
+ * --------------------
+ * Pushes a random direction, or releases the one pushed, and raises the
+ * pin change interrupt. Called by the simulated sleep once the tick from
+ * host_navswitch_next_change() is reached.
+ *
+*/
+void host_navswitch_change(void)
+{
+    if (down) {
+        down = 0;
+        next_change += 1 + host_rand() % AUTOPILOT_GAP_MAX;
+    } else {
+        down = BIT(host_rand() % NAVSWITCH_NUM);
+        next_change += AUTOPILOT_HOLD;
+    }
+    input_isr(down);
+}
@@ -0,0 +1,63 @@
+/** @file   navswitch.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 navswitch driver. Events
+            come from host_navswitch_press() or, when nothing has been
+            scripted, from a seeded random autopilot.
+*/
+
+#ifndef NAVSWITCH_H
+#define NAVSWITCH_H
+
+#include "system.h"
+
+enum {NAVSWITCH_NORTH, NAVSWITCH_EAST, NAVSWITCH_SOUTH, NAVSWITCH_WEST,
+      NAVSWITCH_PUSH, NAVSWITCH_NUM};
+
+
+/*
+ * Function: navswitch_init
+ * --------------------
+ * Initializes the simulated navswitch
+ *
+*/
+void navswitch_init(void);
+
+
+/*
+ * Function: navswitch_update
+ * --------------------
+ * Latches the pending simulated events so they can be polled
+ *
+*/
+void navswitch_update(void);
+
+
+/*
+ * Function: navswitch_down_p
+ * --------------------
+ * Returns: true if the given direction is currently held down
+ *
+*/
+bool navswitch_down_p(uint8_t navswitch);
+
+
+/*
+ * Function: navswitch_push_event_p
+ * --------------------
+ * Returns: true if the given direction was pushed since the last update,
+ * the event is consumed by the call
+ *
+*/
+bool navswitch_push_event_p(uint8_t navswitch);
+
+
+/*
+ * Function: navswitch_release_event_p
+ * --------------------
+ * Returns: true if the given direction was released since the last update
+ *
+*/
+bool navswitch_release_event_p(uint8_t navswitch);
+
+#endif
@@ -0,0 +1,15 @@
+/** @file   pio.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 PIO driver. There are no
+            pins off-board, so this only provides the types.
+*/
+
+#ifndef PIO_H
+#define PIO_H
+
+#include "system.h"
+
+typedef uint16_t pio_t;
+
+#endif
@@ -0,0 +1,42 @@
+/** @file   system.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 system definitions, so
+            the game modules can be built and run off-board.
+*/
+
+#ifndef SYSTEM_H
+#define SYSTEM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define F_CPU 8000000
+
+// Size of the LED matrix, set by the board's configuration on the UCFK4;
+// can be overridden to try the game on other matrices
+#ifndef LEDMAT_COLS_NUM
+#define LEDMAT_COLS_NUM 5
+#endif
+#ifndef LEDMAT_ROWS_NUM
+#define LEDMAT_ROWS_NUM 7
+#endif
+
+#define ARRAY_SIZE(ARRAY) (sizeof (ARRAY) / sizeof (ARRAY[0]))
+
+#define BIT(X) (1 << (X))
+
+#define __unused__ __attribute__ ((unused))
+
+
+/*
+ * Function: system_init
+ * --------------------
+ * Initializes the host backend, reading the HOST_TICKS and HOST_SEED
+ * environment variables used to bound and seed a headless run, and
+ * HOST_EEPROM naming a file to save the EEPROM to when it exits
+ *
+*/
+void system_init(void);
+
+#endif
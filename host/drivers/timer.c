@@ -0,0 +1,257 @@
+/** @file   timer.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 timer driver, and the
+            simulated sleep that moves its time on
+*/
+
+
+#include <stdio.h>
+#include <time.h>
+#include "system.h"
+#include "timer.h"
+#include "hal.h"
+#include "input.h"
+#include "link.h"
+#include "probe.h"
+#include "sched.h"
+#include "host.h"
+
+
+static uint32_t now; // Current simulated tick, without wrapping
+static uint16_t tick_period; // Ticks between timer interrupts, 0 while they're off
+static uint32_t tick_due; // Tick the next timer interrupt is due at
+static host_sleep_hook_t sleep_hook; // Host tool's say in each sleep, see host_sleep_hook_set()
+static void *sleep_hook_data; // Passed to it
+static struct timespec start; // Wall clock time the run started
+
+// Names of the probes, for the report
+static const char *const probe_names[PROBE_NUM] = {
+    [PROBE_DISPLAY_TASK] = "display_task",
+    [PROBE_NAVSWITCH_TASK] = "navswitch_task",
+    [PROBE_GAME_TASK] = "game_task",
+    [PROBE_IR_TASK] = "ir_task",
+    [PROBE_UPDATE_BALLS] = "update_balls",
+    [PROBE_SEND_BALL_POSITION] = "send_ball_position",
+    [PROBE_GET_BALL_POSITION] = "get_ball_position",
+    [PROBE_REFRESH_JITTER] = "refresh_jitter (ticks)",
+};
+
+
+/*
+ * Function: report_probes
+ * --------------------
+ * Prints the time each probe recorded to stderr, in nanoseconds, with
+ * the histogram as the count in each power of two bucket that has any
+ *
+*/
+static void report_probes(void)
+{
+    probe_stats_t stats;
+    uint8_t probe;
+    uint8_t bucket;
+
+    fprintf(stderr, "host: %-18s %8s %6s %6s %6s  histogram (ns < count)\n",
+            "probe", "count", "min", "mean", "max");
+    for (probe = 0; probe < PROBE_NUM; probe++) {
+        probe_get(probe, &stats);
+        fprintf(stderr, "host: %-18s %8lu %6u %6lu %6u ", probe_names[probe],
+                (unsigned long) stats.count, stats.min,
+                stats.count ? (unsigned long) (stats.total / stats.count) : 0UL,
+                stats.max);
+        for (bucket = 0; bucket < PROBE_BUCKETS; bucket++) {
+            if (stats.buckets[bucket]) {
+                if (bucket == PROBE_BUCKETS - 1) {
+                    fprintf(stderr, " inf:%u", stats.buckets[bucket]);
+                } else {
+                    fprintf(stderr, " %lu:%u", 1UL << bucket, stats.buckets[bucket]);
+                }
+            }
+        }
+        fprintf(stderr, "\n");
+    }
+}
+
+
+/*
+ * Function: report
+ * --------------------
+ * Prints a summary of a headless run to stderr
+ *
+*/
+static void report(void)
+{
+    struct timespec end;
+    sched_stats_t stats;
+    input_latency_t latency;
+    link_stats_t link;
+    double elapsed;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    sched_stats_get(&stats);
+    fprintf(stderr, "host: %lu ticks (%.1f s simulated), %lu task calls and %lu from the timer"
+            " interrupt in %.3f s (%.2f M calls/s)\n", (unsigned long) now,
+            (double) now / TIMER_RATE, (unsigned long) stats.runs,
+            (unsigned long) stats.interrupt_runs, elapsed,
+            elapsed > 0 ? (stats.runs + stats.interrupt_runs) / elapsed * 1e-6 : 0.0);
+    fprintf(stderr, "host: %lu sleeps, %lu woken early by events\n",
+            (unsigned long) stats.sleeps, (unsigned long) stats.early_wakes);
+    input_latency_get(&latency);
+    fprintf(stderr, "host: %u navswitch pushes lit, latency min %.1f ms,"
+            " median %.1f ms, max %.1f ms\n", latency.count,
+            latency.min * 1e3 / TIMER_RATE, latency.median * 1e3 / TIMER_RATE,
+            latency.max * 1e3 / TIMER_RATE);
+    link_stats_get(&link);
+    fprintf(stderr, "host: link %u sent, %u acked, %u sent again, %u given up, %u repeats"
+            " dropped, %u NACKs, rtt %.2f updates, timeout %u, loss %.1f%%\n",
+            link.sent, link.acked, link.retransmits, link.failed, link.repeats, link.nacks,
+            link.srtt / 8.0, link.rto, link.loss * 100.0 / FIXED_ONE);
+    report_probes();
+}
+
+
+/*
+ * Function: timer_init
+ * --------------------
+ * Initializes the simulated timer
+ *
+*/
+void timer_init(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &start);
+}
+
+
+/*
+ * Function: timer_get
+ * --------------------
+ * Returns: the current tick of the simulated timer, which wraps like
+ * the kit's 16 bit timer
+*/
+timer_tick_t timer_get(void)
+{
+    return (timer_tick_t) now;
+}
+
+
+/*
+ * Function: advance
+ * --------------------
+ * Moves simulated time on, raising the timer interrupts due on the way
+ *
+ * uint32_t to: Tick to move on to
+ *
+*/
+static void advance(uint32_t to)
+{
+    while (tick_period && tick_due <= to) {
+        now = tick_due;
+        tick_due += tick_period;
+        sched_tick_isr((timer_tick_t) now);
+    }
+    now = to;
+}
+
+
+/*
+ * Function: hal_sleep_until
+ * --------------------
+ * Simulated idle sleep: moves time straight on to the deadline, unless
+ * an event is already pending, or to the autopilot's next navswitch
+ * change if that comes first, raising its interrupt, and raises the
+ * timer interrupts due on the way. A host tool's sleep hook can wake it
+ * sooner. Once HOST_TICKS ticks have passed the run is reported and the
+ * scheduler stopped.
+ *
+ * uint16_t deadline: Timer tick to wake at
+ * volatile uint8_t *events: Pending events, see sched_event_post()
+ *
+*/
+void hal_sleep_until(uint16_t deadline, volatile uint8_t *events)
+{
+    uint32_t limit = host_tick_limit();
+    uint32_t change = host_navswitch_next_change();
+    int16_t ticks = (int16_t) (deadline - (timer_tick_t) now);
+    uint32_t until;
+
+    if (*events || ticks <= 0) {
+        return;
+    }
+    until = now + ticks;
+    if (sleep_hook) {
+        until = sleep_hook(until, sleep_hook_data);
+        if (until <= now) {
+            return;
+        }
+    }
+    if (change < until) {
+        if (change > now) {
+            advance(change);
+        }
+        host_navswitch_change();
+    } else {
+        advance(until);
+    }
+    if (limit && now >= limit) {
+        report();
+        sched_stop();
+    }
+}
+
+
+/*
+ * Function: hal_tick_interrupt_enable
+ * --------------------
+ * Starts the simulated timer interrupt, which calls sched_tick_isr()
+ * every period ticks as simulated time moves on
+ *
+ * uint16_t period: Timer ticks between interrupts
+ *
+*/
+void hal_tick_interrupt_enable(uint16_t period)
+{
+    tick_period = period;
+    tick_due = now + period;
+}
+
+
+/*
+ * Function: hal_tick_interrupt_disable
+ * --------------------
+ * Stops the simulated timer interrupt
+ *
+*/
+void hal_tick_interrupt_disable(void)
+{
+    tick_period = 0;
+}
+
+
+/*
+ * Function: host_sleep_hook_set
+ * --------------------
+ * Hands the simulated sleep to a host tool, which can hold time back
+ * until it is safe to move on, deliver input on the way or wake the
+ * board early, such as to run boards in step on threads of their own
+ *
+ * host_sleep_hook_t hook: Called before each sleep, 0 for none
+ * void *data: Passed to the hook
+ *
+*/
+void host_sleep_hook_set(host_sleep_hook_t hook, void *data)
+{
+    sleep_hook = hook;
+    sleep_hook_data = data;
+}
+
+
+/*
+ * Function: host_ticks
+ * --------------------
+ * Returns: the current simulated tick, in units of 1 / TIMER_RATE seconds
+*/
+uint32_t host_ticks(void)
+{
+    return now;
+}
@@ -0,0 +1,37 @@
+/** @file   timer.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 timer driver. Time is
+            simulated: it only moves on when the CPU sleeps, so tasks
+            take no time and sleeping returns straight away.
+*/
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include "system.h"
+
+#define TIMER_CLOCK_DIVISOR 256
+#define TIMER_RATE (F_CPU / TIMER_CLOCK_DIVISOR)
+
+typedef uint16_t timer_tick_t;
+
+
+/*
+ * Function: timer_init
+ * --------------------
+ * Initializes the simulated timer
+ *
+*/
+void timer_init(void);
+
+
+/*
+ * Function: timer_get
+ * --------------------
+ * Returns: the current tick of the simulated timer, which wraps like
+ * the kit's 16 bit timer
+*/
+timer_tick_t timer_get(void);
+
+#endif
@@ -0,0 +1,57 @@
+/** @file   font5x7_1.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 5x7 font. The host
+            tinygl does not rasterise text, so only the glyphs of the
+            game's messages are drawn, for host/banner_gen.c to render
+            them from; every other glyph is blank. Packed as the UCFK4
+            fonts are, a bit per pixel a row at a time, see
+            font_pixel_get().
+*/
+
+#ifndef FONT5X7_1_H
+#define FONT5X7_1_H
+
+#include "font.h"
+
+static const uint8_t font5x7_1_data[96 * 5] =
+{
+    [('-' - ' ') * 5] = 0x00, 0x80, 0x0f, 0x00, 0x00,
+    [('0' - ' ') * 5] = 0x2e, 0xe6, 0x3a, 0xa3, 0x03,
+    [('1' - ' ') * 5] = 0xc4, 0x10, 0x42, 0x88, 0x03,
+    [('2' - ' ') * 5] = 0x2e, 0x42, 0x44, 0xc4, 0x07,
+    [('3' - ' ') * 5] = 0x1f, 0x11, 0x04, 0xa3, 0x03,
+    [('4' - ' ') * 5] = 0x88, 0xa9, 0xf4, 0x11, 0x02,
+    [('5' - ' ') * 5] = 0x3f, 0x3c, 0x08, 0xa3, 0x03,
+    [('6' - ' ') * 5] = 0x4c, 0x84, 0x17, 0xa3, 0x03,
+    [('7' - ' ') * 5] = 0x1f, 0x22, 0x22, 0x84, 0x00,
+    [('G' - ' ') * 5] = 0x2e, 0x86, 0x1e, 0xa3, 0x07,
+    [('L' - ' ') * 5] = 0x21, 0x84, 0x10, 0xc2, 0x07,
+    [('N' - ' ') * 5] = 0x31, 0xce, 0x9a, 0x63, 0x04,
+    [('O' - ' ') * 5] = 0x2e, 0xc6, 0x18, 0xa3, 0x03,
+    [('P' - ' ') * 5] = 0x2f, 0xc6, 0x17, 0x42, 0x00,
+    [('W' - ' ') * 5] = 0x31, 0xc6, 0x5a, 0xab, 0x02,
+    [('a' - ' ') * 5] = 0x00, 0x38, 0xe8, 0xa3, 0x07,
+    [('d' - ' ') * 5] = 0x10, 0xda, 0x1c, 0xa3, 0x07,
+    [('e' - ' ') * 5] = 0x00, 0xb8, 0xf8, 0x83, 0x03,
+    [('i' - ' ') * 5] = 0x04, 0x18, 0x42, 0x88, 0x03,
+    [('n' - ' ') * 5] = 0x00, 0xb4, 0x19, 0x63, 0x04,
+    [('o' - ' ') * 5] = 0x00, 0xb8, 0x18, 0xa3, 0x03,
+    [('r' - ' ') * 5] = 0x00, 0xb4, 0x19, 0x42, 0x00,
+    [('s' - ' ') * 5] = 0x00, 0xf8, 0xe0, 0xe0, 0x03,
+    [('t' - ' ') * 5] = 0x42, 0x1c, 0x21, 0x24, 0x03,
+    [('w' - ' ') * 5] = 0x00, 0xc4, 0x58, 0xab, 0x02,
+};
+
+static font_t font5x7_1 =
+{
+    .flags = 1, // Packed
+    .width = 5,
+    .height = 7,
+    .offset = ' ',
+    .size = 96,
+    .bytes = 5,
+    .data = font5x7_1_data
+};
+
+#endif
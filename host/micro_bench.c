@@ -0,0 +1,492 @@
+/** @file   micro_bench.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host microbenchmarks of the game logic's hot paths:
+            update_balls() over every ball and paddle configuration
+            on a half pixel grid, for one ball and a full pool,
+            paddle_update() on synthetic navswitch streams, the ball
+            packet's pack and unpack, snapshots of the game state, and a
+            whole display frame of display_task_(). The time spent
+            setting up each operation is measured on its own and taken
+            off.
+
+            Results are printed tab separated, a line per benchmark:
+            name, operations, ns per operation. Given the output of an
+            earlier build with -c, the change from it is added as two
+            more columns.
+
+            Usage: micro_bench [-c previous] [passes]
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "system.h"
+#include "navswitch.h"
+#include "tinygl.h"
+#include "ir_uart.h"
+#include "ir_rx.h"
+#include "input.h"
+#include "packet.h"
+#include "fixed.h"
+#include "ball.h"
+#include "paddle.h"
+#include "render.h"
+#include "state.h"
+#include "geometry.h"
+#include "host.h"
+
+
+#define DEFAULT_PASSES 20
+#define DISPLAY_RATE 300
+#define PADDLE_POSITIONS (TOP_WALL_Y - 1) // Bottom of a three pixel paddle, from the bottom wall up
+#define BURST_EVENTS 8
+#define NAME_MAX 64
+#define RESULTS_MAX 16
+#define CONFIGS_MAX (2 * GRID_WIDTH * (2 * TOP_WALL_Y + 1) * 30) // Half pixels in x and y, by 30 velocities
+
+// The speeds ball.c starts at and is capped at
+#define SLOW FIXED_PER_TICK(3, BALL_UPDATE_RATE)
+#define FAST FIXED_PER_TICK(12, BALL_UPDATE_RATE)
+
+
+typedef struct result_struct
+{
+    char name[NAME_MAX];
+    unsigned long ops;
+    double ns_per_op;
+} result_t;
+
+
+// The game, from game.c built with main renamed
+extern game_state_t game;
+void display_task_(void *data);
+void game_state_get(game_state_t *snapshot);
+
+
+static ball_state_t configs[CONFIGS_MAX]; // Ball configurations to time
+static unsigned long configs_num; // Number of configurations
+static result_t results[RESULTS_MAX]; // Results of this run
+static unsigned results_num; // Number of results
+static volatile int sink; // Keeps results from being optimised away
+
+
+/*
+ * Function: seconds
+ * --------------------
+ * Returns: a monotonic time stamp in seconds
+*/
+static double seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/*
+ * Function: add_result
+ * --------------------
+ * Records the result of a benchmark
+ *
+ * const char *name: Name of the benchmark
+ * unsigned long ops: Number of operations timed
+ * double elapsed: Time taken, in seconds
+ * double baseline: Time the same setup took on its own
+ *
+*/
+static void add_result(const char *name, unsigned long ops, double elapsed,
+                       double baseline)
+{
+    result_t *result = &results[results_num++];
+
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->ops = ops;
+    result->ns_per_op = (elapsed - baseline) / ops * 1e9;
+}
+
+
+/*
+ * Function: set_paddle
+ * --------------------
+ * Moves the paddle to a position, by pushing the navswitch
+ *
+ * int bottom: Row for the bottom of the paddle
+ *
+*/
+static void set_paddle(int bottom)
+{
+    int i;
+
+    paddle_init();
+    for (i = 0; i < PADDLE_POSITIONS; i++) {
+        input_event_put(NAVSWITCH_NORTH, 1);
+        paddle_update();
+    }
+    for (i = 0; i < bottom; i++) {
+        input_event_put(NAVSWITCH_SOUTH, 1);
+        paddle_update();
+    }
+}
+
+
+/*
+ * Function: build_configs
+ * --------------------
+ * Lists ball configurations: every position on a half pixel grid from
+ * the border to the goal, moving either way in x at three speeds and
+ * five angles
+ *
+*/
+static void build_configs(void)
+{
+    static const fixed_t speeds[] = {SLOW, (SLOW + FAST) / 2, FAST};
+    static const fixed_t angles[] = {-FAST, -SLOW, 0, SLOW, FAST};
+    fixed_t x;
+    fixed_t y;
+    unsigned speed;
+    unsigned angle;
+    int direction;
+
+    configs_num = 0;
+    for (x = -FIXED_HALF; x <= FIXED_FROM_INT(GOAL_X); x += FIXED_HALF) {
+        for (y = 0; y <= FIXED_FROM_INT(TOP_WALL_Y); y += FIXED_HALF) {
+            for (speed = 0; speed < ARRAY_SIZE(speeds); speed++) {
+                for (direction = -1; direction <= 1; direction += 2) {
+                    for (angle = 0; angle < ARRAY_SIZE(angles); angle++) {
+                        configs[configs_num].x = x;
+                        configs[configs_num].y = y;
+                        configs[configs_num].vel_x = direction * speeds[speed];
+                        configs[configs_num].vel_y = angles[angle];
+                        configs_num++;
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/*
+ * Function: bench_update_balls
+ * --------------------
+ * Times update_balls() from every configuration, for every paddle
+ * position, with a number of balls in play. The other balls start from
+ * configurations spread evenly through the rest, and the time is given
+ * per ball.
+ *
+ * const char *name: Name of the benchmark
+ * uint8_t balls_num: Balls updated together, at most BALL_POOL_SIZE
+ * unsigned long passes: Number of times through the configurations
+ *
+*/
+static void bench_update_balls(const char *name, uint8_t balls_num,
+                               unsigned long passes)
+{
+    ball_events_t events;
+    double elapsed = 0;
+    double baseline = 0;
+    double start;
+    unsigned long pass;
+    unsigned long i;
+    uint8_t id;
+    int bottom;
+
+    build_configs();
+    for (bottom = 0; bottom < PADDLE_POSITIONS; bottom++) {
+        set_paddle(bottom);
+        start = seconds();
+        for (pass = 0; pass < passes; pass++) {
+            for (i = 0; i < configs_num; i++) {
+                for (id = 0; id < balls_num; id++) {
+                    set_ball_state(id, &configs[(i + id * configs_num / balls_num) % configs_num]);
+                }
+            }
+        }
+        baseline += seconds() - start;
+        start = seconds();
+        for (pass = 0; pass < passes; pass++) {
+            for (i = 0; i < configs_num; i++) {
+                for (id = 0; id < balls_num; id++) {
+                    set_ball_state(id, &configs[(i + id * configs_num / balls_num) % configs_num]);
+                }
+                update_balls(BIT(balls_num) - 1, &events);
+                sink = events.scored | events.hit | events.crossed;
+            }
+        }
+        elapsed += seconds() - start;
+    }
+    add_result(name, PADDLE_POSITIONS * configs_num * passes * balls_num,
+               elapsed, baseline);
+}
+
+
+/*
+ * Function: queue_stream
+ * --------------------
+ * Queues a call's worth of a synthetic navswitch stream
+ *
+ * unsigned events: Number of events to queue, alternating pushes and
+ * releases of north and south
+ * unsigned long call: Number of the call, to vary the directions
+ *
+*/
+static void queue_stream(unsigned events, unsigned long call)
+{
+    unsigned i;
+
+    for (i = 0; i < events; i++) {
+        input_event_put((call + i / 2) % 2 ? NAVSWITCH_SOUTH : NAVSWITCH_NORTH,
+                        i % 2 == 0);
+    }
+}
+
+
+/*
+ * Function: bench_paddle_update
+ * --------------------
+ * Times paddle_update() taking a number of events each call, net of
+ * queueing and dequeueing them
+ *
+ * const char *name: Name of the benchmark
+ * unsigned events: Events queued for each call
+ * unsigned long calls: Number of calls to time
+ *
+*/
+static void bench_paddle_update(const char *name, unsigned events,
+                                unsigned long calls)
+{
+    input_event_t event;
+    double baseline;
+    double start;
+    unsigned long i;
+
+    paddle_init();
+    start = seconds();
+    for (i = 0; i < calls; i++) {
+        queue_stream(events, i);
+        while (input_event_get(&event)) {
+            sink = event.navswitch;
+        }
+    }
+    baseline = seconds() - start;
+    start = seconds();
+    for (i = 0; i < calls; i++) {
+        queue_stream(events, i);
+        paddle_update();
+    }
+    add_result(name, calls, seconds() - start, baseline);
+}
+
+
+/*
+ * Function: bench_ball_packet
+ * --------------------
+ * Times packing the ball into a packet and sending it, unpacking a
+ * packet into the ball, and the two with the decoding in between
+ *
+ * unsigned long calls: Number of calls to time
+ *
+*/
+static void bench_ball_packet(unsigned long calls)
+{
+    ball_state_t ball;
+    packet_t packet;
+    double start;
+    unsigned long i;
+    uint8_t id;
+
+    ball = configs[configs_num / 2];
+    set_ball_state(0, &ball);
+
+    host_ir_loopback_set(0);
+    start = seconds();
+    for (i = 0; i < calls; i++) {
+        send_ball_position(0, i & 3);
+    }
+    add_result("send_ball_position", calls, seconds() - start, 0);
+
+    host_ir_loopback_set(1);
+    send_ball_position(0, 1);
+    if (!packet_receive(&packet)) {
+        fprintf(stderr, "micro_bench: ball packet wasn't received\n");
+        exit(1);
+    }
+    start = seconds();
+    for (i = 0; i < calls; i++) {
+        sink = get_ball_position(&packet, &id);
+    }
+    add_result("get_ball_position", calls, seconds() - start, 0);
+
+    start = seconds();
+    for (i = 0; i < calls; i++) {
+        send_ball_position(0, i & 3);
+        if (packet_receive(&packet)) {
+            sink = get_ball_position(&packet, &id);
+        }
+    }
+    add_result("ball_round_trip", calls, seconds() - start, 0);
+    host_ir_loopback_set(0);
+}
+
+
+/*
+ * Function: bench_state
+ * --------------------
+ * Times taking a snapshot of the game and packing it, and packing and
+ * unpacking one
+ *
+ * unsigned long calls: Number of calls to time
+ *
+*/
+static void bench_state(unsigned long calls)
+{
+    game_state_t snapshot;
+    uint8_t bytes[STATE_SIZE];
+    double start;
+    unsigned long i;
+
+    game = (game_state_t) {.phase = PLAYING_STATE, .this_score = 2, .ball_visible = 1};
+    start = seconds();
+    for (i = 0; i < calls; i++) {
+        game.just_scored = i;
+        game_state_get(&snapshot);
+        state_pack(&snapshot, bytes);
+        sink = bytes[1];
+    }
+    add_result("state_snapshot_pack", calls, seconds() - start, 0);
+
+    start = seconds();
+    for (i = 0; i < calls; i++) {
+        snapshot.just_scored = i;
+        state_pack(&snapshot, bytes);
+        sink = state_unpack(bytes, &snapshot);
+    }
+    add_result("state_pack_unpack", calls, seconds() - start, 0);
+    game = (game_state_t) {.phase = INITIALIZATION_STATE};
+}
+
+
+/*
+ * Function: bench_display_frame
+ * --------------------
+ * Times the display task for a whole frame, lighting each column once,
+ * with the ball moved to the next configuration every frame
+ *
+ * unsigned long frames: Number of frames to time
+ *
+*/
+static void bench_display_frame(unsigned long frames)
+{
+    double baseline;
+    double start;
+    unsigned long i;
+    int column;
+
+    game.phase = PLAYING_STATE;
+    paddle_init();
+    render_ball_show(1);
+    display_task_(0);
+    start = seconds();
+    for (i = 0; i < frames; i++) {
+        set_ball_state(0, &configs[i % configs_num]);
+    }
+    baseline = seconds() - start;
+    start = seconds();
+    for (i = 0; i < frames; i++) {
+        set_ball_state(0, &configs[i % configs_num]);
+        for (column = 0; column < GRID_WIDTH; column++) {
+            display_task_(0);
+        }
+    }
+    add_result("display_frame", frames, seconds() - start, baseline);
+}
+
+
+/*
+ * Function: previous_ns
+ * --------------------
+ * Finds a benchmark in the output of an earlier run
+ *
+ * FILE *previous: Earlier output
+ * const char *name: Name of the benchmark
+ * double *ns_per_op: Filled in with its time
+ *
+ * Returns: 1 if it was found, 0 otherwise
+*/
+static int previous_ns(FILE *previous, const char *name, double *ns_per_op)
+{
+    char line[256];
+    char found[NAME_MAX];
+    unsigned long ops;
+
+    rewind(previous);
+    while (fgets(line, sizeof(line), previous)) {
+        if (sscanf(line, "%63[^\t]\t%lu\t%lf", found, &ops, ns_per_op) == 3
+            && strcmp(found, name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * Main method of micro_bench.c.
+ * Runs every benchmark and prints the results.
+ */
+int main(int argc, char **argv)
+{
+    unsigned long passes;
+    FILE *previous = 0;
+    double old;
+    unsigned i;
+    int option;
+
+    while ((option = getopt(argc, argv, "c:")) != -1) {
+        switch (option) {
+        case 'c':
+            previous = fopen(optarg, "r");
+            if (!previous) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-c previous] [passes]\n", argv[0]);
+            return 1;
+        }
+    }
+    passes = optind < argc ? strtoul(argv[optind], NULL, 0) : DEFAULT_PASSES;
+
+    tinygl_init(DISPLAY_RATE);
+    navswitch_init();
+    ir_uart_init();
+    ir_rx_init();
+    render_reset();
+
+    bench_update_balls("update_balls", 1, passes);
+    bench_update_balls("update_balls_pool", BALL_POOL_SIZE, passes);
+    bench_paddle_update("paddle_update_idle", 0, passes * 100000);
+    bench_paddle_update("paddle_update_push", 2, passes * 100000);
+    bench_paddle_update("paddle_update_burst", BURST_EVENTS, passes * 100000);
+    bench_ball_packet(passes * 50000);
+    bench_state(passes * 100000);
+    bench_display_frame(passes * 20000);
+
+    for (i = 0; i < results_num; i++) {
+        printf("%s\t%lu\t%.2f", results[i].name, results[i].ops, results[i].ns_per_op);
+        if (previous && previous_ns(previous, results[i].name, &old)) {
+            printf("\t%.2f\t%+.1f%%", old, (results[i].ns_per_op - old) / old * 100);
+        }
+        printf("\n");
+    }
+    if (previous) {
+        fclose(previous);
+    }
+    return 0;
+}
@@ -0,0 +1,626 @@
+/** @file   monte_carlo.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Monte Carlo match simulator for balancing the rules. Plays
+            whole two-board matches of the game logic, game_task_() from
+            game.c with ball.c and paddle.c, against scripted players:
+            a board's game state is swapped in before each of its updates,
+            and the ball packets it sends are decoded into the other
+            board's inbox.
+
+            The matches are shared out over a worker process per core,
+            each with its own copy of the game's state. Every worker owns
+            a range of match numbers and takes them one at a time; a
+            worker that runs out steals the top half of the largest range
+            left. Each match has its own random numbers, seeded from the
+            match number, so results don't depend on the number of
+            workers.
+
+            Players are given as two letters, the first for the board
+            that starts: r pushes up or down at random, t tracks the ball
+            to hit it off a random part of the paddle, but misjudges it by
+            two pixels a percentage of the times it comes over.
+
+            The rules are the game's own, rebuilt with other values to
+            try them, for example:
+            make clean; make monte_carlo HOST_DEFINES="-DWINNING_SCORE=5"
+
+            Usage: monte_carlo [-j workers] [-p players] [-e error%]
+                               [-s seed] [matches]
+*/
+
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "system.h"
+#include "navswitch.h"
+#include "tinygl.h"
+#include "ir_uart.h"
+#include "input.h"
+#include "packet.h"
+#include "ball.h"
+#include "paddle.h"
+#include "state.h"
+#include "geometry.h"
+#include "host.h"
+
+
+#define DEFAULT_MATCHES 100000
+#define DEFAULT_ERROR 20 // Percentage of balls a tracking player misjudges
+#define MISJUDGED_AIM 2 // Pixels a misjudged ball is off the paddle's centre
+#define WORKERS_MAX 256
+#define BOARDS_NUM 2
+#define INBOX_SIZE 4 // Ball packets a board can have waiting
+
+#define NAVSWITCH_RATE 20 // Player decisions per second, the navswitch task's rate
+#define RANDOM_PUSH_ODDS 4 // A random player pushes on one decision in this many
+#define MATCH_SECONDS_MAX 600 // Matches still going after this are abandoned
+#define MATCH_FRAMES_MAX (MATCH_SECONDS_MAX * BALL_UPDATE_RATE)
+#define RALLY_BUCKETS 64 // Paddle hits in a point, the last bucket holds the rest
+
+
+typedef struct board_struct
+{
+    char player; // Player strategy, 'r' or 't'
+    int aiming; // True once a tracking player has judged the ball on screen
+    int aim; // Pixels from the paddle's centre the tracking player aims for
+    game_state_t game; // Snapshot of the game on this board
+    ball_state_t ball;
+    packet_decoder_t decoder; // Decodes the bytes the other board sends
+    packet_t inbox[INBOX_SIZE]; // Packets received, waiting to be taken
+    unsigned inbox_head;
+    unsigned inbox_tail;
+} board_t;
+
+
+typedef struct stats_struct
+{
+    unsigned long matches; // Matches played to the end
+    unsigned long first_wins; // Matches won by the board that started
+    unsigned long abandoned; // Matches still going after MATCH_SECONDS_MAX
+    unsigned long points;
+    unsigned long long frames; // Game updates over all the finished matches
+    unsigned long rally[RALLY_BUCKETS]; // Points by paddle hits in them
+    unsigned long duration[MATCH_SECONDS_MAX + 1]; // Matches by whole seconds
+} stats_t;
+
+
+// A worker's range of match numbers, [first, end) packed into a word so
+// it can be taken from and stolen from atomically. Padded to a cache line
+// so workers taking from their own ranges don't slow each other down.
+typedef struct range_struct
+{
+    _Atomic uint64_t packed;
+    char pad[64 - sizeof(uint64_t)];
+} range_t;
+
+
+typedef struct shared_struct
+{
+    range_t ranges[WORKERS_MAX];
+    stats_t stats[WORKERS_MAX];
+} shared_t;
+
+
+// The game, from game.c built with main renamed
+extern game_state_t game;
+void game_task_(void *data);
+void game_state_get(game_state_t *snapshot);
+void game_state_set(const game_state_t *snapshot);
+
+
+static shared_t *shared; // Ranges and results, shared by the workers
+static unsigned workers; // Number of worker processes
+static char players[BOARDS_NUM] = {'t', 't'}; // Strategy of each board's player
+static unsigned error_percent = DEFAULT_ERROR; // Balls a tracking player misjudges
+static uint32_t seed = 1; // Seed the matches' random numbers are made from
+static uint32_t rng; // This worker's random number state
+
+
+/*
+ * Function: seconds
+ * --------------------
+ * Returns: a monotonic time stamp in seconds
+*/
+static double seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/*
+ * Function: rng_seed
+ * --------------------
+ * Seeds this worker's random numbers for a match, mixing the match number
+ * so neighbouring matches don't play alike
+ *
+ * uint32_t match: Number of the match
+ *
+*/
+static void rng_seed(uint32_t match)
+{
+    uint32_t x = seed ^ (match * 0x9E3779B9u);
+
+    x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+    x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+    x ^= x >> 16;
+    rng = x ? x : 1;
+}
+
+
+/*
+ * Function: rng_next
+ * --------------------
+ * Returns: the next of this worker's random numbers, a 32 bit xorshift
+*/
+static uint32_t rng_next(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+
+/*
+ * Function: range_pack
+ * --------------------
+ * Returns: a range of match numbers packed into a word
+*/
+static uint64_t range_pack(uint32_t first, uint32_t end)
+{
+    return (uint64_t) first << 32 | end;
+}
+
+
+/*
+ * Function: range_take
+ * --------------------
+ * Takes the next match number from this worker's range, or failing that
+ * steals half of the largest range another worker has left
+ *
+ * unsigned worker: This worker
+ * uint32_t *match: Set to the match number taken
+ *
+ * Returns: 1 if a match was taken, 0 if every range is empty
+*/
+static int range_take(unsigned worker, uint32_t *match)
+{
+    _Atomic uint64_t *own = &shared->ranges[worker].packed;
+    uint64_t packed;
+    uint64_t largest_packed;
+    uint32_t first;
+    uint32_t end;
+    uint32_t middle;
+    unsigned largest;
+    unsigned i;
+
+    for (;;) {
+        packed = atomic_load(own);
+        first = packed >> 32;
+        end = (uint32_t) packed;
+        if (first < end) {
+            if (atomic_compare_exchange_weak(own, &packed, range_pack(first + 1, end))) {
+                *match = first;
+                return 1;
+            }
+            continue;
+        }
+
+        // Nothing left here, so look for the most to steal
+        largest = workers;
+        largest_packed = 0;
+        for (i = 0; i < workers; i++) {
+            packed = atomic_load(&shared->ranges[i].packed);
+            if (i != worker && (uint32_t) packed > packed >> 32
+                && (largest == workers || (uint32_t) packed - (packed >> 32)
+                    > (uint32_t) largest_packed - (largest_packed >> 32))) {
+                largest = i;
+                largest_packed = packed;
+            }
+        }
+        if (largest == workers) {
+            return 0;
+        }
+        first = largest_packed >> 32;
+        end = (uint32_t) largest_packed;
+        middle = first + (end - first) / 2;
+        if (atomic_compare_exchange_strong(&shared->ranges[largest].packed, &largest_packed,
+                                           range_pack(first, middle))) {
+            atomic_store(own, range_pack(middle, end));
+        }
+    }
+}
+
+
+/*
+ * Function: board_load
+ * --------------------
+ * Swaps a board's game state in, ready for its update
+ *
+ * const board_t *board: Board to load
+ *
+*/
+static void board_load(const board_t *board)
+{
+    game_state_set(&board->game);
+    set_ball_state(0, &board->ball);
+}
+
+
+/*
+ * Function: board_save
+ * --------------------
+ * Swaps a board's game state out after its update
+ *
+ * board_t *board: Board to save
+ *
+*/
+static void board_save(board_t *board)
+{
+    game_state_get(&board->game);
+    get_ball_state(0, &board->ball);
+}
+
+
+/*
+ * Function: board_init
+ * --------------------
+ * Sets a board up as the game is just started
+ *
+ * board_t *board: Board to set up
+ * char player: Strategy of the board's player
+ * int starting: True for the board that starts the game
+ *
+*/
+static void board_init(board_t *board, char player, int starting)
+{
+    memset(board, 0, sizeof(*board));
+    board->player = player;
+    board->game.phase = PLAYING_STATE;
+    board->game.ball_visible = starting;
+    set_ball_position(0, INITIAL_BALL_X_POS, INITIAL_BALL_Y_POS);
+    get_ball_state(0, &board->ball);
+    board->game.paddle_bottom = PADDLE_BOTTOM_INIT_Y;
+    packet_decoder_init(&board->decoder);
+}
+
+
+/*
+ * Function: player_move
+ * --------------------
+ * Pushes the navswitch for the loaded board's player
+ *
+ * board_t *board: Board of the player
+ *
+*/
+static void player_move(board_t *board)
+{
+    int target = get_ball(0).y;
+    int centre = (get_paddle_top().y + get_paddle_bottom().y) / 2;
+
+    if (board->player == 'r') {
+        if (rng_next() % RANDOM_PUSH_ODDS == 0) {
+            input_event_put(rng_next() & 1 ? NAVSWITCH_NORTH : NAVSWITCH_SOUTH, 1);
+        }
+    } else if (!game.ball_visible) {
+        board->aiming = 0;
+    } else {
+        if (!board->aiming) {
+            if (rng_next() % 100 < error_percent) {
+                board->aim = rng_next() & 1 ? MISJUDGED_AIM : -MISJUDGED_AIM;
+            } else {
+                board->aim = (int) (rng_next() % 3) - 1;
+            }
+            board->aiming = 1;
+        }
+        target -= board->aim;
+        if (target < centre) {
+            input_event_put(NAVSWITCH_NORTH, 1);
+        } else if (target > centre) {
+            input_event_put(NAVSWITCH_SOUTH, 1);
+        }
+    }
+    paddle_update();
+}
+
+
+/*
+ * Function: play_match
+ * --------------------
+ * Plays a match to the end, adding it to a worker's results
+ *
+ * uint32_t match: Number of the match, seeding its random numbers
+ * stats_t *stats: Results of the worker
+ *
+*/
+static void play_match(uint32_t match, stats_t *stats)
+{
+    board_t boards[BOARDS_NUM];
+    board_t *board;
+    board_t *other;
+    packet_t packet;
+    uint8_t id;
+    unsigned long frame;
+    unsigned rally = 0;
+    int scored_against;
+    int sent;
+    int byte;
+    int b;
+
+    rng_seed(match);
+    for (b = 0; b < BOARDS_NUM; b++) {
+        board_init(&boards[b], players[b], b == 0);
+    }
+
+    for (frame = 0; frame < MATCH_FRAMES_MAX; frame++) {
+        for (b = 0; b < BOARDS_NUM; b++) {
+            board = &boards[b];
+            other = &boards[!b];
+            board_load(board);
+
+            // The navswitch task, at its own rate
+            if ((frame + 1) * NAVSWITCH_RATE / BALL_UPDATE_RATE
+                != frame * NAVSWITCH_RATE / BALL_UPDATE_RATE) {
+                player_move(board);
+            }
+
+            scored_against = game.their_score;
+            game_task_(0);
+            if (game.their_score != scored_against) {
+                stats->rally[rally < RALLY_BUCKETS ? rally : RALLY_BUCKETS - 1]++;
+                stats->points++;
+                rally = 0;
+                board->aiming = 0;
+            }
+
+            // Ball packets fly straight to the other board. The link never
+            // loses a packet, so the resync snapshots are left out.
+            sent = 0;
+            while ((byte = host_ir_transmitted()) >= 0) {
+                if (packet_decode(&other->decoder, byte, &packet) && packet.type == PACKET_BALL
+                    && other->inbox_head - other->inbox_tail < INBOX_SIZE) {
+                    other->inbox[other->inbox_head++ % INBOX_SIZE] = packet;
+                    sent = 1;
+                }
+            }
+            if (sent && game.phase == PLAYING_STATE) {
+                rally++;
+            }
+
+            // The IR task, taking the ball once the last one has gone
+            if (game.phase == PLAYING_STATE && !game.ball_visible && !game.ball_incoming
+                && board->inbox_head != board->inbox_tail) {
+                packet = board->inbox[board->inbox_tail++ % INBOX_SIZE];
+                if (packet.type == PACKET_BALL) {
+                    game.this_score = get_ball_position(&packet, &id);
+                    game.ball_incoming = BIT(id);
+                }
+            }
+
+            board_save(board);
+            if (game.phase == END_STATE) {
+                // The board that ends the game first knows both scores
+                stats->matches++;
+                stats->first_wins += (b == 0) == (game.this_score > game.their_score);
+                stats->frames += frame + 1;
+                stats->duration[(frame + 1) / BALL_UPDATE_RATE]++;
+                return;
+            }
+        }
+    }
+    stats->abandoned++;
+}
+
+
+/*
+ * Function: worker
+ * --------------------
+ * Plays matches until every range is empty, in a process of its own
+ *
+ * unsigned worker: This worker
+ *
+*/
+static void worker(unsigned worker)
+{
+    uint32_t match;
+
+    ir_uart_init();
+    host_ir_loopback_set(0);
+    host_navswitch_autopilot_set(0);
+    input_init();
+    paddle_init();
+    while (range_take(worker, &match)) {
+        play_match(match, &shared->stats[worker]);
+    }
+}
+
+
+/*
+ * Function: percentile
+ * --------------------
+ * Finds a percentile of a histogram
+ *
+ * const unsigned long *histogram: Counts by value
+ * unsigned buckets: Number of values
+ * unsigned long total: Sum of the counts
+ * unsigned percent: Percentile to find
+ *
+ * Returns: the smallest value at or above the percentile
+*/
+static unsigned percentile(const unsigned long *histogram, unsigned buckets,
+                           unsigned long total, unsigned percent)
+{
+    unsigned long below = 0;
+    unsigned i;
+
+    for (i = 0; i < buckets - 1; i++) {
+        below += histogram[i];
+        if (below * 100 >= total * percent) {
+            break;
+        }
+    }
+    return i;
+}
+
+
+/*
+ * Function: report
+ * --------------------
+ * Prints the results of all the workers
+ *
+ * unsigned long requested: Matches asked for
+ * double elapsed: Seconds the workers took
+ *
+*/
+static void report(unsigned long requested, double elapsed)
+{
+    stats_t total;
+    unsigned long rally_hits = 0;
+    unsigned long rally_last;
+    double win;
+    unsigned w;
+    unsigned i;
+
+    memset(&total, 0, sizeof(total));
+    for (w = 0; w < workers; w++) {
+        total.matches += shared->stats[w].matches;
+        total.first_wins += shared->stats[w].first_wins;
+        total.abandoned += shared->stats[w].abandoned;
+        total.points += shared->stats[w].points;
+        total.frames += shared->stats[w].frames;
+        for (i = 0; i < RALLY_BUCKETS; i++) {
+            total.rally[i] += shared->stats[w].rally[i];
+        }
+        for (i = 0; i <= MATCH_SECONDS_MAX; i++) {
+            total.duration[i] += shared->stats[w].duration[i];
+        }
+    }
+
+    printf("%lu matches, %c against %c, on %u workers in %.2f s (%.0f matches/s)\n",
+           requested, players[0], players[1], workers, elapsed, requested / elapsed);
+    if (total.abandoned) {
+        printf("%lu abandoned after %u s\n", total.abandoned, MATCH_SECONDS_MAX);
+    }
+    if (!total.matches || !total.points) {
+        return;
+    }
+
+    // Normal approximation of the win rate's 95% confidence interval
+    win = (double) total.first_wins / total.matches;
+    printf("first player wins %.2f%% +/- %.2f%%\n", win * 100,
+           196 * sqrt(win * (1 - win) / total.matches));
+    printf("match duration s: mean %.1f p10 %u p50 %u p90 %u p99 %u\n",
+           (double) total.frames / BALL_UPDATE_RATE / total.matches,
+           percentile(total.duration, MATCH_SECONDS_MAX + 1, total.matches, 10),
+           percentile(total.duration, MATCH_SECONDS_MAX + 1, total.matches, 50),
+           percentile(total.duration, MATCH_SECONDS_MAX + 1, total.matches, 90),
+           percentile(total.duration, MATCH_SECONDS_MAX + 1, total.matches, 99));
+
+    rally_last = 0;
+    for (i = 0; i < RALLY_BUCKETS; i++) {
+        rally_hits += total.rally[i] * i;
+        if (total.rally[i]) {
+            rally_last = i;
+        }
+    }
+    printf("rally hits: mean %.2f p50 %u p90 %u p99 %u\n",
+           (double) rally_hits / total.points,
+           percentile(total.rally, RALLY_BUCKETS, total.points, 50),
+           percentile(total.rally, RALLY_BUCKETS, total.points, 90),
+           percentile(total.rally, RALLY_BUCKETS, total.points, 99));
+    printf("hits\tpoints\t%%\n");
+    for (i = 0; i <= rally_last; i++) {
+        printf("%u%s\t%lu\t%.3f\n", i, i == RALLY_BUCKETS - 1 ? "+" : "",
+               total.rally[i], 100.0 * total.rally[i] / total.points);
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long matches;
+    unsigned long first;
+    double start;
+    pid_t pid;
+    unsigned w;
+    int status;
+    int failed = 0;
+    int option;
+
+    workers = sysconf(_SC_NPROCESSORS_ONLN);
+    while ((option = getopt(argc, argv, "j:p:e:s:")) != -1) {
+        switch (option) {
+        case 'j':
+            workers = strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            if (strspn(optarg, "rt") != BOARDS_NUM || optarg[BOARDS_NUM]) {
+                fprintf(stderr, "%s: players are two of r and t\n", argv[0]);
+                return 1;
+            }
+            memcpy(players, optarg, BOARDS_NUM);
+            break;
+        case 'e':
+            error_percent = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-j workers] [-p players] [-e error%%] [-s seed] [matches]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    matches = optind < argc ? strtoul(argv[optind], NULL, 0) : DEFAULT_MATCHES;
+    if (workers < 1) {
+        workers = 1;
+    } else if (workers > WORKERS_MAX) {
+        workers = WORKERS_MAX;
+    }
+
+    shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    for (w = 0; w < workers; w++) {
+        first = matches * w / workers;
+        atomic_init(&shared->ranges[w].packed,
+                    range_pack(first, matches * (w + 1) / workers));
+    }
+
+    start = seconds();
+    for (w = 0; w < workers; w++) {
+        pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            worker(w);
+            _exit(0);
+        }
+    }
+    while (wait(&status) > 0) {
+        failed |= !WIFEXITED(status) || WEXITSTATUS(status);
+    }
+    if (failed) {
+        fprintf(stderr, "%s: a worker failed\n", argv[0]);
+        return 1;
+    }
+    report(matches, seconds() - start);
+    return 0;
+}
@@ -0,0 +1,866 @@
+/** @file   net_sim.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Plays matches between boards running side by side on threads
+            of their own, over a simulated IR link that can be delayed,
+            jittery, noisy and lossy. Each board is a whole copy of the
+            game loaded from host/board.so with dlmopen(), as ring_sim
+            loads them, running the game's own scheduler; the players at
+            the ends of the row push the navswitch from a script, tracking
+            the ball and misjudging it by two pixels -e percent of the
+            time, so the IR exchange is the kits' own from connecting to
+            the final score.
+
+            Every byte a board sends goes to each neighbour through a
+            lock-free queue of its own, one thread putting and the other
+            taking, stamped with the tick it arrives at: sent, plus the
+            time a byte takes at 2400 baud, plus the -d delay and up to
+            the -J jitter, but never before the byte ahead of it has
+            finished arriving. On the way -l bytes in a thousand are lost
+            and -f bits in a million flipped.
+
+            Simulated time races ahead of the wall clock. Each board may
+            only move its time on as far as its neighbours have promised
+            to send nothing more before, plus the shortest time a byte
+            can take, so no byte ever arrives late; a board waiting on
+            the others promises as far as it safely can and yields. The
+            matches are played the same however the threads are scheduled,
+            so a seed picks the same matches every time. Each match runs
+            in a process of its own, -j of them at once. A board whose
+            game has ended runs on until it has ended on every board, or
+            for as long as a ball lost at the end can take to be sent
+            again, so the others can still get the final score from it.
+
+            Usage: net_sim [-b boards] [-d delay] [-J jitter] [-l loss]
+                           [-f flips] [-e error%] [-j jobs] [-s seed]
+                           [-v] [matches]
+            where the delay and jitter are in microseconds
+*/
+
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "system.h"
+#include "timer.h"
+#include "navswitch.h"
+#include "tinygl.h"
+#include "ball.h"
+#include "link.h"
+#include "state.h"
+#include "resync.h"
+#include "ring.h"
+#include "host.h"
+
+
+#define LIBRARY "host/board.so"
+#define DEFAULT_MATCHES 100
+#define DEFAULT_BOARDS 2
+#define DEFAULT_ERROR 20 // Percentage of balls a tracking player misjudges
+#define MISJUDGED_AIM 2 // Pixels a misjudged ball is off the paddle's centre
+#define BOARDS_MAX 8 // Namespaces dlmopen() can be relied on for
+#define MATCHES_MAX 100000
+#define JOBS_MAX 256
+#define END_TEXT_SIZE 16
+
+#define QUEUE_SIZE 1024 // Bytes a queue can have on the way, a power of two
+#define BYTE_TICKS (TIMER_RATE * 10 / 2400) // A byte at 2400 baud, with start and stop bits
+#define NEVER UINT32_MAX // Tick of a board that will never send again
+#define SPINS 16 // Looks at the neighbours before yielding to their threads
+
+#define US_TICKS(us) ((uint32_t) ((uint64_t) (us) * TIMER_RATE / 1000000))
+#define MS_TICKS(ms) US_TICKS((uint64_t) (ms) * 1000)
+#define MOVE_TICKS (TIMER_RATE / 20) // Between player decisions, the navswitch task's rate
+#define CONNECT_POLL_TICKS MS_TICKS(1) // Between connection steps, as the kit spins
+#define PRESS_AGAIN_TICKS MS_TICKS(500) // Before a player presses the navswitch again
+#define START_TICKS MS_TICKS(200) // From connecting to the game being started
+#define CONNECT_TICKS_MAX MS_TICKS(10000) // Before the boards are given up on
+// Game updates a ball lost at the end can take to be recovered: the
+// snapshots that find it missing, then the link sending it again
+#define END_UPDATES (RESYNC_PERIOD * (RESYNC_STRIKES + 1) + LINK_RTO_MAX * LINK_RETRIES)
+#define END_TICKS ((uint32_t) END_UPDATES * TIMER_RATE / BALL_UPDATE_RATE) // Run on at the end for, at most
+#define MATCH_TICKS_MAX MS_TICKS(600000) // Matches still going after this are abandoned
+
+
+typedef struct channel_struct
+{
+    uint32_t ticks[QUEUE_SIZE]; // Tick each byte arrives at
+    uint8_t bytes[QUEUE_SIZE];
+    _Atomic uint32_t head; // Count of bytes put, only written by the sending thread
+    _Atomic uint32_t tail; // Count of bytes taken, only written by the receiving thread
+    atomic_int closed; // True once the receiving board has stopped
+    uint32_t last; // Tick the last byte sent finishes arriving
+    uint32_t rng; // Random number state of the impairments
+} channel_t;
+
+
+typedef struct board_struct
+{
+    void *library; // This board's copy of host/board.so
+    thrd_t thread;
+    unsigned index; // Position in the row, from 0
+    game_state_t *game;
+    int (*connection_step)(void);
+    void (*game_start)(void);
+    void (*game_run)(void);
+    void (*sched_stop)(void);
+    void (*hal_sleep_until)(uint16_t deadline, volatile uint8_t *events);
+    uint32_t (*host_ticks)(void);
+    int (*discovery_serving)(void);
+    int (*link_idle)(void);
+    tinygl_point_t (*get_ball)(uint8_t id);
+    tinygl_point_t (*get_paddle_top)(void);
+    tinygl_point_t (*get_paddle_bottom)(void);
+    void (*host_navswitch_press)(uint8_t navswitch);
+    int (*host_ir_transmitted)(void);
+    void (*host_ir_receive)(uint8_t byte);
+    channel_t *out[2]; // To the neighbours on the left and right, 0 for none
+    channel_t *in[2]; // From them
+    struct board_struct *neighbours[2];
+    _Atomic uint32_t promise; // Tick this board will send nothing more before
+    atomic_int ended; // True once the game has ended on this board, for the others
+    uint32_t rng; // Random number state of the player
+    int started; // True once connected and game_start() has been called
+    int aiming; // True once the player has judged the ball on screen
+    int aim; // Pixels from the paddle's centre the player aims for
+    uint32_t press_at; // Tick the player next pushes the navswitch down
+    uint32_t move_at; // Tick the player next moves the paddle
+    uint32_t connected_at; // Tick the board connected
+    uint32_t ended_at; // Tick the game ended, 0 while it hasn't
+    uint32_t stopped_at; // Tick the board stopped
+    unsigned long sent; // Bytes sent to each neighbour, over both
+    unsigned long lost;
+    unsigned long corrupted;
+    unsigned long overflowed; // Lost as the queue was full
+} board_t;
+
+
+typedef struct result_struct
+{
+    int unconnected; // True if the boards never all connected, so the match wasn't played
+    int finished; // True if every board got to the end of the match
+    int agreed; // True if every board had the same score
+    int left_score; // Board 0's player's score, on board 0
+    int right_score; // The last board's player's score, on the last board
+    uint32_t connect_ticks; // Ticks until the last board connected
+    uint32_t ticks; // Ticks the match took, from the first board connecting to the last ending
+    unsigned long sent; // Packets sent that needed an ACK, over every board
+    unsigned long retransmits;
+    unsigned long failed;
+    unsigned long bytes; // Bytes sent over every queue
+    unsigned long lost;
+    unsigned long corrupted;
+    unsigned long overflowed;
+    char text[BOARDS_MAX][END_TEXT_SIZE]; // What each board shows at the end
+} result_t;
+
+
+static unsigned boards_num = DEFAULT_BOARDS; // Boards in the row
+static uint32_t delay; // Ticks a byte takes on top of its time on the air
+static uint32_t jitter; // Most ticks a byte is delayed by on top of that
+static unsigned loss = 0; // Bytes lost on the way, in a thousand
+static unsigned flips = 0; // Bits flipped on the way, in a million
+static unsigned error_percent = DEFAULT_ERROR; // Balls a tracking player misjudges
+static uint32_t seed = 1; // Seed the matches' random numbers are made from
+static board_t boards[BOARDS_MAX]; // This match's boards
+static channel_t channels[2 * (BOARDS_MAX - 1)]; // A queue each way across each gap
+static result_t *results; // One per match, shared with the match processes
+
+
+/*
+ * Function: rng_next
+ * --------------------
+ * Returns: the next number from a random number state, a 32 bit xorshift
+*/
+static uint32_t rng_next(uint32_t *rng)
+{
+    *rng ^= *rng << 13;
+    *rng ^= *rng >> 17;
+    *rng ^= *rng << 5;
+    return *rng;
+}
+
+
+/*
+ * Function: seconds
+ * --------------------
+ * Returns: a monotonic time stamp in seconds
+*/
+static double seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/*
+ * Function: symbol
+ * --------------------
+ * Looks up a symbol in a board's library, exiting if it isn't there
+ *
+ * board_t *board: Board to look in
+ * const char *name: Name of the symbol
+ *
+ * Returns: the address of the symbol
+*/
+static void *symbol(board_t *board, const char *name)
+{
+    void *address = dlsym(board->library, name);
+
+    if (!address) {
+        fprintf(stderr, "net_sim: %s\n", dlerror());
+        exit(1);
+    }
+    return address;
+}
+
+
+/*
+ * Function: channel_put
+ * --------------------
+ * Sends a byte down a queue, from the sending board's thread, working
+ * out when it arrives and what happens to it on the way
+ *
+ * board_t *board: Board sending it, counting what happens to it
+ * channel_t *channel: Queue to the neighbour
+ * uint32_t now: Tick it is sent at
+ * uint8_t byte: Byte sent
+ *
+*/
+static void channel_put(board_t *board, channel_t *channel, uint32_t now, uint8_t byte)
+{
+    uint32_t head = atomic_load_explicit(&channel->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&channel->tail, memory_order_acquire);
+    uint32_t arrives = now + BYTE_TICKS + delay;
+    uint8_t sent = byte;
+    uint8_t bit;
+
+    if (atomic_load_explicit(&channel->closed, memory_order_relaxed)) {
+        return;
+    }
+    board->sent++;
+    if (jitter) {
+        arrives += rng_next(&channel->rng) % (jitter + 1);
+    }
+    // Bytes arrive one after the other, whatever held each one up
+    if ((int32_t) (arrives - (channel->last + BYTE_TICKS)) < 0) {
+        arrives = channel->last + BYTE_TICKS;
+    }
+    channel->last = arrives;
+    if (loss && rng_next(&channel->rng) % 1000 < loss) {
+        board->lost++;
+        return;
+    }
+    for (bit = 0; flips && bit < 8; bit++) {
+        if (rng_next(&channel->rng) % 1000000 < flips) {
+            byte ^= BIT(bit);
+        }
+    }
+    board->corrupted += byte != sent;
+    if (head - tail >= QUEUE_SIZE) {
+        board->overflowed++;
+        return;
+    }
+    channel->ticks[head & (QUEUE_SIZE - 1)] = arrives;
+    channel->bytes[head & (QUEUE_SIZE - 1)] = byte;
+    atomic_store_explicit(&channel->head, head + 1, memory_order_release);
+}
+
+
+/*
+ * Function: channel_next
+ * --------------------
+ * Finds when the next byte down a queue arrives, from the receiving
+ * board's thread
+ *
+ * channel_t *channel: Queue from the neighbour
+ *
+ * Returns: the tick it arrives at, or NEVER if the queue is empty
+*/
+static uint32_t channel_next(channel_t *channel)
+{
+    uint32_t tail = atomic_load_explicit(&channel->tail, memory_order_relaxed);
+
+    if (tail == atomic_load_explicit(&channel->head, memory_order_acquire)) {
+        return NEVER;
+    }
+    return channel->ticks[tail & (QUEUE_SIZE - 1)];
+}
+
+
+/*
+ * Function: channel_take
+ * --------------------
+ * Takes the next byte from a queue, which channel_next() has found
+ *
+ * channel_t *channel: Queue from the neighbour
+ *
+ * Returns: the byte
+*/
+static uint8_t channel_take(channel_t *channel)
+{
+    uint32_t tail = atomic_load_explicit(&channel->tail, memory_order_relaxed);
+    uint8_t byte = channel->bytes[tail & (QUEUE_SIZE - 1)];
+
+    atomic_store_explicit(&channel->tail, tail + 1, memory_order_release);
+    return byte;
+}
+
+
+/*
+ * Function: player_move
+ * --------------------
+ * Pushes the navswitch for a player at one end of the row, tracking the
+ * ball as it comes over
+ *
+ * board_t *board: Board of the player
+ *
+ * Returns: 1 if the navswitch was pushed, 0 otherwise
+*/
+static int player_move(board_t *board)
+{
+    int target = board->get_ball(0).y;
+    int centre = (board->get_paddle_top().y + board->get_paddle_bottom().y) / 2;
+
+    if (!(board->game->ball_visible & 1)) {
+        board->aiming = 0;
+        return 0;
+    }
+    if (!board->aiming) {
+        if (rng_next(&board->rng) % 100 < error_percent) {
+            board->aim = rng_next(&board->rng) & 1 ? MISJUDGED_AIM : -MISJUDGED_AIM;
+        } else {
+            board->aim = (int) (rng_next(&board->rng) % 3) - 1;
+        }
+        board->aiming = 1;
+    }
+    target -= board->aim;
+    if (target < centre) {
+        board->host_navswitch_press(NAVSWITCH_NORTH);
+    } else if (target > centre) {
+        board->host_navswitch_press(NAVSWITCH_SOUTH);
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+
+/*
+ * Function: player_play
+ * --------------------
+ * Does whatever the board's player would at this tick: board 0's player
+ * pressing the navswitch down until a ring connects, the player who
+ * serves starting the game, and the players at the ends moving their
+ * paddles
+ *
+ * board_t *board: Board of the player
+ * uint32_t now: Current tick
+ *
+ * Returns: 1 if the navswitch was pushed, 0 otherwise
+*/
+static int player_play(board_t *board, uint32_t now)
+{
+    int end = board->index == 0 || board->index == boards_num - 1;
+
+    if (!board->started) {
+        // Board 0's player presses the navswitch down to number a ring;
+        // two boards find each other by themselves
+        if (board->index == 0 && boards_num > 2 && now >= board->press_at) {
+            board->host_navswitch_press(NAVSWITCH_PUSH);
+            board->press_at = now + PRESS_AGAIN_TICKS;
+            return 1;
+        }
+    } else if (board->game->phase == INITIALIZATION_STATE) {
+        if ((boards_num == 2 ? board->discovery_serving() : board->index == 0)
+            && now >= board->press_at) {
+            board->host_navswitch_press(NAVSWITCH_PUSH);
+            board->press_at = now + PRESS_AGAIN_TICKS;
+            return 1;
+        }
+    } else if (board->game->phase == PLAYING_STATE && end && now >= board->move_at) {
+        board->move_at = now + MOVE_TICKS;
+        return player_move(board);
+    }
+    return 0;
+}
+
+
+/*
+ * Function: every_board_ended
+ * --------------------
+ * Returns: 1 if the game has ended on every board of the match, 0
+ * otherwise
+*/
+static int every_board_ended(void)
+{
+    unsigned b;
+
+    for (b = 0; b < boards_num; b++) {
+        if (!atomic_load_explicit(&boards[b].ended, memory_order_acquire)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*
+ * Function: board_sleep
+ * --------------------
+ * The boards' sleep hook, see host_sleep_hook_set(). Passes on what the
+ * board has sent, hands it what has arrived and lets its player play,
+ * then holds it back until time can safely move on, as far as the
+ * deadline or the next byte arriving.
+ *
+ * uint32_t until: Tick the board would sleep until
+ * void *data: The board
+ *
+ * Returns: the tick to wake at
+*/
+static uint32_t board_sleep(uint32_t until, void *data)
+{
+    board_t *board = data;
+    uint32_t now = board->host_ticks();
+    uint32_t horizon;
+    uint32_t promise;
+    uint32_t wake;
+    unsigned spins = 0;
+    int woken = 0;
+    int byte;
+    int side;
+
+    while ((byte = board->host_ir_transmitted()) >= 0) {
+        for (side = 0; side < 2; side++) {
+            if (board->out[side]) {
+                channel_put(board, board->out[side], now, byte);
+            }
+        }
+    }
+    for (side = 0; side < 2; side++) {
+        while (board->in[side] && channel_next(board->in[side]) <= now) {
+            board->host_ir_receive(channel_take(board->in[side]));
+            woken = 1;
+        }
+    }
+    woken |= player_play(board, now);
+
+    if (board->started && board->game->phase == END_STATE && !board->ended_at) {
+        board->ended_at = now;
+        atomic_store_explicit(&board->ended, 1, memory_order_release);
+    }
+    // Stopping once the match is over on every board and this board's
+    // link has nothing left to send, or END_TICKS after it ended here, so
+    // a board that has ended can still send the others a ball they lost.
+    // Also stopping if the game never starts, such as when the other
+    // board never connected.
+    if (board->started && (now - board->connected_at >= MATCH_TICKS_MAX
+                           || (board->ended_at && ((every_board_ended() && board->link_idle())
+                                                   || now - board->ended_at >= END_TICKS))
+                           || (board->game->phase == INITIALIZATION_STATE
+                               && now - board->connected_at >= CONNECT_TICKS_MAX))) {
+        board->sched_stop();
+        woken = 1;
+    }
+    if (woken) {
+        atomic_store_explicit(&board->promise, now, memory_order_release);
+        return now;
+    }
+
+    for (;;) {
+        // The neighbours' promises first, so every byte sent before them
+        // is in the queues by the time they're looked at
+        horizon = NEVER;
+        for (side = 0; side < 2; side++) {
+            if (board->neighbours[side]) {
+                promise = atomic_load_explicit(&board->neighbours[side]->promise,
+                                               memory_order_acquire);
+                if (promise < NEVER - BYTE_TICKS - delay && promise + BYTE_TICKS + delay < horizon) {
+                    horizon = promise + BYTE_TICKS + delay;
+                }
+            }
+        }
+        wake = until;
+        for (side = 0; side < 2; side++) {
+            if (board->in[side] && channel_next(board->in[side]) < wake) {
+                wake = channel_next(board->in[side]);
+            }
+        }
+        if (wake <= horizon) {
+            atomic_store_explicit(&board->promise, wake, memory_order_release);
+            return wake;
+        }
+        // Nothing is sent before waking, and nothing can arrive to wake
+        // the board before the horizon
+        atomic_store_explicit(&board->promise, horizon, memory_order_release);
+        if (++spins % SPINS == 0) {
+            thrd_yield();
+        }
+    }
+}
+
+
+/*
+ * Function: board_stopped
+ * --------------------
+ * Lets the neighbours know a board has stopped, so they neither wait
+ * for it nor send it any more
+ *
+ * board_t *board: Board that has stopped
+ *
+*/
+static void board_stopped(board_t *board)
+{
+    int side;
+
+    board->stopped_at = board->host_ticks();
+    for (side = 0; side < 2; side++) {
+        if (board->in[side]) {
+            atomic_store_explicit(&board->in[side]->closed, 1, memory_order_relaxed);
+        }
+    }
+    atomic_store_explicit(&board->promise, NEVER, memory_order_release);
+}
+
+
+/*
+ * Function: board_thread
+ * --------------------
+ * Runs a board as its main() would: connecting, the connection step
+ * run every CONNECT_POLL_TICKS, then the game's tasks until the match
+ * is over
+ *
+ * void *data: The board
+ *
+ * Returns: 0
+*/
+static int board_thread(void *data)
+{
+    board_t *board = data;
+    volatile uint8_t events = 0;
+
+    while (!board->connection_step()) {
+        if (board->host_ticks() >= CONNECT_TICKS_MAX) {
+            board_stopped(board);
+            return 0;
+        }
+        board->hal_sleep_until((uint16_t) (board->host_ticks() + CONNECT_POLL_TICKS), &events);
+    }
+    board->game_start();
+    board->connected_at = board->host_ticks();
+    board->press_at = board->connected_at + START_TICKS;
+    board->started = 1;
+    board->game_run();
+    board_stopped(board);
+    return 0;
+}
+
+
+/*
+ * Function: board_load
+ * --------------------
+ * Loads a new copy of the game for a board and initializes it, ready
+ * to connect
+ *
+ * board_t *board: Board to load
+ * unsigned index: Its position in the row
+ * uint32_t match: Number of the match, seeding the player's random numbers
+ *
+*/
+static void board_load(board_t *board, unsigned index, uint32_t match)
+{
+    board->library = dlmopen(LM_ID_NEWLM, LIBRARY, RTLD_NOW);
+    if (!board->library) {
+        fprintf(stderr, "net_sim: %s\n", dlerror());
+        exit(1);
+    }
+    board->index = index;
+    board->rng = (seed ^ (match * 0x9E3779B9u) ^ (index * 0x85EBCA6Bu)) | 1;
+    board->game = symbol(board, "game");
+    board->connection_step = symbol(board, "connection_step");
+    board->game_start = symbol(board, "game_start");
+    board->game_run = symbol(board, "game_run");
+    board->sched_stop = symbol(board, "sched_stop");
+    board->hal_sleep_until = symbol(board, "hal_sleep_until");
+    board->host_ticks = symbol(board, "host_ticks");
+    board->discovery_serving = symbol(board, "discovery_serving");
+    board->link_idle = symbol(board, "link_idle");
+    board->get_ball = symbol(board, "get_ball");
+    board->get_paddle_top = symbol(board, "get_paddle_top");
+    board->get_paddle_bottom = symbol(board, "get_paddle_bottom");
+    board->host_navswitch_press = symbol(board, "host_navswitch_press");
+    board->host_ir_transmitted = symbol(board, "host_ir_transmitted");
+    board->host_ir_receive = symbol(board, "host_ir_receive");
+
+    // Each board seeds its discovery differently, as the kits do
+    ((void (*)(uint32_t)) symbol(board, "host_seed_set"))(board->rng * 0x2545F491u);
+    ((void (*)(void)) symbol(board, "game_init"))();
+    ((void (*)(uint8_t)) symbol(board, "ring_init"))(boards_num);
+    ((void (*)(bool)) symbol(board, "host_ir_loopback_set"))(0);
+    ((void (*)(bool)) symbol(board, "host_navswitch_autopilot_set"))(0);
+    ((void (*)(uint32_t)) symbol(board, "host_tick_limit_set"))(0);
+    ((void (*)(host_sleep_hook_t, void *)) symbol(board, "host_sleep_hook_set"))(board_sleep, board);
+}
+
+
+/*
+ * Function: play_match
+ * --------------------
+ * Connects a new row of boards and plays a match across it, a thread
+ * per board, in a process of its own
+ *
+ * uint32_t match: Number of the match, seeding its random numbers
+ * result_t *result: Filled in with the result
+ *
+*/
+static void play_match(uint32_t match, result_t *result)
+{
+    void (*banner_text_get)(char *text, uint8_t size);
+    void (*link_stats_get)(link_stats_t *stats);
+    link_stats_t stats;
+    uint32_t first = NEVER;
+    uint32_t end = 0;
+    const game_state_t *left;
+    const game_state_t *right;
+    const game_state_t *game;
+    board_t *board;
+    unsigned b;
+
+    for (b = 0; b < boards_num; b++) {
+        board_load(&boards[b], b, match);
+    }
+    // A queue each way across each gap, owned by the board sending
+    for (b = 0; b + 1 < boards_num; b++) {
+        channels[2 * b].rng = (seed ^ (match * 0x9E3779B9u) ^ ((2 * b + 1) * 0xC2B2AE35u)) | 1;
+        channels[2 * b + 1].rng = (seed ^ (match * 0x9E3779B9u) ^ ((2 * b + 2) * 0xC2B2AE35u)) | 1;
+        boards[b].out[RING_RIGHT] = boards[b + 1].in[RING_LEFT] = &channels[2 * b];
+        boards[b + 1].out[RING_LEFT] = boards[b].in[RING_RIGHT] = &channels[2 * b + 1];
+        boards[b].neighbours[RING_RIGHT] = &boards[b + 1];
+        boards[b + 1].neighbours[RING_LEFT] = &boards[b];
+    }
+    for (b = 0; b < boards_num; b++) {
+        if (thrd_create(&boards[b].thread, board_thread, &boards[b]) != thrd_success) {
+            fprintf(stderr, "net_sim: can't start a thread\n");
+            exit(1);
+        }
+    }
+    for (b = 0; b < boards_num; b++) {
+        thrd_join(boards[b].thread, NULL);
+    }
+
+    // Board 0 keeps its player's score as this_score, every other board
+    // keeps the right hand player's
+    left = boards[0].game;
+    right = boards[boards_num - 1].game;
+    result->left_score = left->this_score;
+    result->right_score = right->this_score;
+    result->finished = 1;
+    result->agreed = 1;
+    for (b = 0; b < boards_num; b++) {
+        board = &boards[b];
+        game = board->game;
+        if (!board->started) {
+            result->unconnected = 1;
+            continue;
+        }
+        if (board->connected_at < first) {
+            first = board->connected_at;
+        }
+        if (board->connected_at > result->connect_ticks) {
+            result->connect_ticks = board->connected_at;
+        }
+        if ((board->ended_at ? board->ended_at : board->stopped_at) > end) {
+            end = board->ended_at ? board->ended_at : board->stopped_at;
+        }
+        result->finished &= board->ended_at != 0;
+        if (b > 0 && (game->this_score != left->their_score || game->their_score != left->this_score)) {
+            result->agreed = 0;
+        }
+        banner_text_get = symbol(board, "banner_text_get");
+        link_stats_get = symbol(board, "link_stats_get");
+        banner_text_get(result->text[b], END_TEXT_SIZE);
+        link_stats_get(&stats);
+        result->sent += stats.sent;
+        result->retransmits += stats.retransmits;
+        result->failed += stats.failed;
+        result->bytes += board->sent;
+        result->lost += board->lost;
+        result->corrupted += board->corrupted;
+        result->overflowed += board->overflowed;
+    }
+    if (result->unconnected) {
+        result->finished = 0;
+    } else {
+        result->ticks = end - first;
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long matches;
+    unsigned long match;
+    unsigned long next = 0;
+    unsigned long unconnected = 0;
+    unsigned long finished = 0;
+    unsigned long agreed = 0;
+    unsigned long left_wins = 0;
+    unsigned long long connect_ticks = 0;
+    unsigned long long ticks = 0;
+    unsigned long long match_ticks = 0;
+    unsigned long sent = 0;
+    unsigned long retransmits = 0;
+    unsigned long failed = 0;
+    unsigned long long bytes = 0;
+    unsigned long long lost = 0;
+    unsigned long long corrupted = 0;
+    unsigned long long overflowed = 0;
+    unsigned jobs;
+    unsigned running = 0;
+    int verbose = 0;
+    int crashed = 0;
+    double start;
+    double elapsed;
+    result_t *result;
+    pid_t pid;
+    int status;
+    int option;
+    unsigned b;
+
+    jobs = sysconf(_SC_NPROCESSORS_ONLN) / DEFAULT_BOARDS;
+    while ((option = getopt(argc, argv, "b:d:J:l:f:e:j:s:v")) != -1) {
+        switch (option) {
+        case 'b':
+            boards_num = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            delay = US_TICKS(strtoul(optarg, NULL, 0));
+            break;
+        case 'J':
+            jitter = US_TICKS(strtoul(optarg, NULL, 0));
+            break;
+        case 'l':
+            loss = strtoul(optarg, NULL, 0);
+            break;
+        case 'f':
+            flips = strtoul(optarg, NULL, 0);
+            break;
+        case 'e':
+            error_percent = strtoul(optarg, NULL, 0);
+            break;
+        case 'j':
+            jobs = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-b boards] [-d delay] [-J jitter] [-l loss] [-f flips]"
+                    " [-e error%%] [-j jobs] [-s seed] [-v] [matches]\n", argv[0]);
+            return 1;
+        }
+    }
+    matches = optind < argc ? strtoul(argv[optind], NULL, 0) : DEFAULT_MATCHES;
+    if (boards_num < 2 || boards_num > BOARDS_MAX || boards_num > RING_BOARDS_MAX) {
+        fprintf(stderr, "%s: boards must be 2 to %d\n", argv[0],
+                BOARDS_MAX < RING_BOARDS_MAX ? BOARDS_MAX : RING_BOARDS_MAX);
+        return 1;
+    }
+    if (matches > MATCHES_MAX) {
+        matches = MATCHES_MAX;
+    }
+    if (jobs < 1) {
+        jobs = 1;
+    } else if (jobs > JOBS_MAX) {
+        jobs = JOBS_MAX;
+    }
+
+    results = mmap(NULL, matches * sizeof(*results), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    start = seconds();
+    fflush(stdout);
+    while (next < matches || running) {
+        if (next < matches && running < jobs) {
+            pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                return 1;
+            }
+            if (pid == 0) {
+                play_match(next, &results[next]);
+                _exit(0);
+            }
+            next++;
+            running++;
+        } else if (wait(&status) > 0) {
+            crashed |= !WIFEXITED(status) || WEXITSTATUS(status);
+            running--;
+        }
+    }
+    elapsed = seconds() - start;
+    if (crashed) {
+        fprintf(stderr, "%s: a match failed\n", argv[0]);
+        return 1;
+    }
+
+    for (match = 0; match < matches; match++) {
+        result = &results[match];
+        if (verbose && result->unconnected) {
+            printf("match %lu: the boards never connected\n", match);
+        } else if (verbose) {
+            printf("match %lu: connected in %.0f ms, %d-%d in %.1f s%s%s, boards show", match,
+                   result->connect_ticks * 1e3 / TIMER_RATE, result->left_score,
+                   result->right_score, (double) result->ticks / TIMER_RATE,
+                   result->finished ? "" : ", abandoned", result->agreed ? "" : ", scores disagree");
+            for (b = 0; b < boards_num; b++) {
+                printf(" \"%s\"", result->text[b]);
+            }
+            printf("\n");
+        }
+        unconnected += result->unconnected;
+        finished += result->finished;
+        agreed += result->finished && result->agreed;
+        left_wins += result->finished && result->left_score > result->right_score;
+        connect_ticks += result->connect_ticks;
+        ticks += result->ticks;
+        match_ticks += result->finished ? result->ticks : 0;
+        sent += result->sent;
+        retransmits += result->retransmits;
+        failed += result->failed;
+        bytes += result->bytes;
+        lost += result->lost;
+        corrupted += result->corrupted;
+        overflowed += result->overflowed;
+    }
+
+    printf("%u boards, %lu matches, %lu never connected, %lu finished, %lu with every board"
+           " agreeing on the score\n", boards_num, matches, unconnected, finished, agreed);
+    printf("board 0's player won %lu, mean connection %.0f ms, mean match %.1f s\n", left_wins,
+           matches > unconnected ? connect_ticks * 1e3 / TIMER_RATE / (matches - unconnected) : 0.0,
+           finished ? (double) match_ticks / TIMER_RATE / finished : 0.0);
+    printf("ir: %llu bytes, %llu lost, %llu corrupted, %llu overflowed, delay %.1f ms"
+           " + up to %.1f ms\n", bytes, lost, corrupted, overflowed,
+           (BYTE_TICKS + delay) * 1e3 / TIMER_RATE, jitter * 1e3 / TIMER_RATE);
+    printf("link: %lu sent, %lu sent again, %lu given up on\n", sent, retransmits, failed);
+    printf("%.2f s for %.0f s simulated, %.0fx real time, %.0f matches a minute with %u jobs\n",
+           elapsed, (double) ticks / TIMER_RATE, elapsed > 0 ? ticks / TIMER_RATE / elapsed : 0.0,
+           elapsed > 0 ? matches * 60 / elapsed : 0.0, jobs);
+    return finished == matches && agreed == matches ? 0 : 1;
+}
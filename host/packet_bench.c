@@ -0,0 +1,200 @@
+/** @file   packet_bench.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host benchmark for the IR packet decoder: throughput on a
+            clean stream, and how many frames survive, are rejected or
+            are wrongly accepted as bit errors and dropped bytes are
+            injected.
+
+            Usage: packet_bench [frames]
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "system.h"
+#include "packet.h"
+#include "host.h"
+
+
+#define DEFAULT_FRAMES 1000000UL
+
+
+static const uint8_t types[] = {PACKET_READY, PACKET_START, PACKET_BALL};
+
+
+/*
+ * Function: seconds
+ * --------------------
+ * Returns: a monotonic time stamp in seconds
+*/
+static double seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/*
+ * Function: build_stream
+ * --------------------
+ * Encodes random packets back to back
+ *
+ * packet_t *packets: Filled in with the packets encoded
+ * unsigned long count: Number of packets
+ * uint8_t *stream: Filled in with the frames
+ *
+ * Returns: the number of bytes in the stream
+*/
+static size_t build_stream(packet_t *packets, unsigned long count, uint8_t *stream)
+{
+    size_t size = 0;
+    unsigned long i;
+    uint8_t j;
+
+    for (i = 0; i < count; i++) {
+        packets[i].type = types[host_rand() % ARRAY_SIZE(types)];
+        packets[i].seq = i;
+        packets[i].length = host_rand() % (PACKET_PAYLOAD_MAX + 1);
+        packets[i].address = 0;
+        for (j = 0; j < packets[i].length; j++) {
+            packets[i].payload[j] = host_rand();
+        }
+        size += packet_encode(stream + size, &packets[i]);
+    }
+    return size;
+}
+
+
+/*
+ * Function: corrupt_stream
+ * --------------------
+ * Copies a stream, flipping each bit with probability ber and dropping
+ * each byte with probability drop
+ *
+ * Returns: the number of bytes in the corrupted stream
+*/
+static size_t corrupt_stream(const uint8_t *in, size_t size, uint8_t *out,
+                             double ber, double drop)
+{
+    uint32_t flip_below = ber * 0x7fffffffUL;
+    uint32_t drop_below = drop * 0x7fffffffUL;
+    size_t count = 0;
+    size_t i;
+    uint8_t bit;
+    uint8_t byte;
+
+    for (i = 0; i < size; i++) {
+        if (host_rand() < drop_below) {
+            continue;
+        }
+        byte = in[i];
+        for (bit = 0; bit < 8; bit++) {
+            if (host_rand() < flip_below) {
+                byte ^= BIT(bit);
+            }
+        }
+        out[count++] = byte;
+    }
+    return count;
+}
+
+
+/*
+ * Function: run
+ * --------------------
+ * Decodes a stream and prints one line of results, checking every
+ * accepted packet against the packet originally sent with its sequence
+ * number (sequence numbers wrap, so only the low byte is compared)
+ *
+*/
+static void run(const char *name, const packet_t *packets, unsigned long count,
+                const uint8_t *stream, size_t size)
+{
+    packet_decoder_t decoder;
+    packet_t packet;
+    unsigned long good = 0;
+    unsigned long bad = 0;
+    unsigned long rejected = 0;
+    uint16_t last_rejected = 0;
+    unsigned long next = 0;
+    unsigned long i;
+    double start, elapsed;
+    size_t j;
+
+    packet_decoder_init(&decoder);
+    start = seconds();
+    for (j = 0; j < size; j++) {
+        if (packet_decode(&decoder, stream[j], &packet)) {
+            // Find the packet it should be: the first unmatched one
+            // with the same sequence number
+            for (i = next; i < count && (uint8_t) packets[i].seq != packet.seq; i++) {
+                continue;
+            }
+            if (i < count && packets[i].type == packet.type
+                && packets[i].length == packet.length
+                && !memcmp(packets[i].payload, packet.payload, packet.length)) {
+                good++;
+                next = i + 1;
+            } else {
+                bad++;
+            }
+        }
+        // The decoder's own counters are sized for the AVR and wrap
+        rejected += (uint16_t) (decoder.rejected - last_rejected);
+        last_rejected = decoder.rejected;
+    }
+    elapsed = seconds() - start;
+
+    printf("%-12s %9lu sent %9lu ok %6lu corrupt-accepted %9lu rejected"
+           " %7.1f MB/s %7.2f ns/byte\n", name, count, good, bad,
+           rejected, size / elapsed * 1e-6, elapsed / size * 1e9);
+}
+
+
+int main(int argc, char **argv)
+{
+    static const double bers[] = {1e-4, 1e-3, 1e-2};
+    unsigned long count = DEFAULT_FRAMES;
+    packet_t *packets;
+    uint8_t *stream;
+    uint8_t *corrupted;
+    char *end;
+    char name[32];
+    size_t size;
+    size_t corrupted_size;
+    uint8_t i;
+
+    if (argc > 1) {
+        count = strtoul(argv[1], &end, 0);
+        if (argc > 2 || argv[1][0] == '-' || *end || end == argv[1] || !count) {
+            fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+            return 1;
+        }
+    }
+    packets = malloc(count * sizeof(*packets));
+    stream = malloc(count * PACKET_FRAME_MAX);
+    corrupted = malloc(count * PACKET_FRAME_MAX);
+    if (!packets || !stream || !corrupted) {
+        fprintf(stderr, "packet_bench: out of memory\n");
+        return 1;
+    }
+    size = build_stream(packets, count, stream);
+    run("clean", packets, count, stream, size);
+    for (i = 0; i < ARRAY_SIZE(bers); i++) {
+        corrupted_size = corrupt_stream(stream, size, corrupted, bers[i], 0);
+        snprintf(name, sizeof(name), "ber=%g", bers[i]);
+        run(name, packets, count, corrupted, corrupted_size);
+    }
+    corrupted_size = corrupt_stream(stream, size, corrupted, 0, 1e-3);
+    run("drop=0.001", packets, count, corrupted, corrupted_size);
+
+    free(packets);
+    free(stream);
+    free(corrupted);
+    return 0;
+}
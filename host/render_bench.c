@@ -0,0 +1,170 @@
+/** @file   render_bench.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host benchmark comparing the display task's drawing of the
+            playing grid: clearing and redrawing the paddle and ball
+            through tinygl on every frame, against rebuilding the grid's
+            column bytes only when something moved and lighting a column
+            straight from them. Both are fed the same ball and paddle
+            movement, at the rates the game tasks run at.
+
+            Usage: render_bench [frames]
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "system.h"
+#include "navswitch.h"
+#include "tinygl.h"
+#include "ball.h"
+#include "paddle.h"
+#include "render.h"
+#include "input.h"
+#include "geometry.h"
+#include "host.h"
+
+
+#define DEFAULT_FRAMES 3000000UL
+#define DISPLAY_RATE 300
+#define NAVSWITCH_RATE 20
+#define PUSH_ODDS 4 // As for the host navswitch autopilot
+
+
+/*
+ * Function: seconds
+ * --------------------
+ * Returns: a monotonic time stamp in seconds
+*/
+static double seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/*
+ * Function: redraw_frame
+ * --------------------
+ * The display task's drawing before the renderer: clear, then draw the
+ * paddle and ball
+ *
+*/
+static void redraw_frame(void)
+{
+    tinygl_clear();
+    tinygl_draw_line(get_paddle_top(), get_paddle_bottom(), 1);
+    tinygl_draw_point(get_ball(0), 1);
+}
+
+
+/*
+ * Function: render_frame
+ * --------------------
+ * The display task's drawing with the renderer, lighting the next column
+ *
+*/
+static void render_frame(void)
+{
+    static uint8_t column = 0; // Column lit this frame
+
+    render_column(column);
+    column = (column + 1) % TINYGL_WIDTH;
+    render_update();
+}
+
+
+/*
+ * Function: no_frame
+ * --------------------
+ * Draws nothing, to time the ball and paddle movement on their own
+ *
+*/
+static void no_frame(void)
+{
+}
+
+
+/*
+ * Function: run
+ * --------------------
+ * Plays the ball and paddle for a number of display frames, drawing
+ * each frame with the given function
+ *
+ * Returns: the time taken in seconds
+*/
+static double run(void (*draw)(void), unsigned long frames)
+{
+    ball_events_t events;
+    double start;
+    unsigned long i;
+
+    host_seed_set(1);
+    paddle_init();
+    set_ball_position(0, INITIAL_BALL_X_POS, INITIAL_BALL_Y_POS);
+    render_reset();
+    render_ball_show(1);
+    start = seconds();
+    for (i = 0; i < frames; i++) {
+        if (i % (DISPLAY_RATE / BALL_UPDATE_RATE) == 0) {
+            update_balls(BIT(0), &events);
+            if (events.scored | events.hit | events.crossed) {
+                set_ball_position(0, INITIAL_BALL_X_POS, INITIAL_BALL_Y_POS);
+            }
+        }
+        if (i % (DISPLAY_RATE / NAVSWITCH_RATE) == 0) {
+            if (host_rand() % PUSH_ODDS == 0) {
+                input_event_put(host_rand() % NAVSWITCH_NUM, 1);
+            }
+            paddle_update();
+        }
+        draw();
+    }
+    return seconds() - start;
+}
+
+
+/*
+ * Function: report
+ * --------------------
+ * Runs a drawing function and prints one line of results, with the time
+ * spent moving the ball and paddle taken off
+ *
+*/
+static void report(const char *name, void (*draw)(void), unsigned long frames,
+                   double baseline)
+{
+    unsigned long writes = host_pixel_writes();
+    unsigned long columns = host_column_writes();
+    double elapsed = run(draw, frames);
+
+    printf("%-8s %9lu frames %6.2f pixel writes/frame %4.2f column writes/frame %7.1f ns/frame\n",
+           name, frames, (double) (host_pixel_writes() - writes) / frames,
+           (double) (host_column_writes() - columns) / frames,
+           (elapsed - baseline) / frames * 1e9);
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long frames = DEFAULT_FRAMES;
+    char *end;
+    double baseline;
+
+    if (argc > 1) {
+        frames = strtoul(argv[1], &end, 0);
+        if (argc > 2 || argv[1][0] == '-' || *end || end == argv[1] || !frames) {
+            fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+            return 1;
+        }
+    }
+    tinygl_init(DISPLAY_RATE);
+    navswitch_init();
+    baseline = run(no_frame, frames);
+    report("redraw", redraw_frame, frames, baseline);
+    report("render", render_frame, frames, baseline);
+    return 0;
+}
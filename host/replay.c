@@ -0,0 +1,335 @@
+/** @file   replay.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host tool that replays match recordings (see record.h)
+            through the game itself, game.c and all, to reproduce bugs
+            and as a regression test. Every match starts from a freshly
+            booted board: a new copy of the game, stand-in drivers and
+            all, is loaded from host/board.so with dlopen() for each
+            replay and unloaded after it, so all run in the one process.
+
+            A replay is checked two ways: every packet the game sends
+            must match the one sent when it was recorded, and the trace
+            of the game state after each update must match LOG.trace if
+            there is one. With -w the traces are written instead.
+
+            Usage: replay [-w] [-n repeats] LOG...
+            where each LOG is an EEPROM image, as saved by
+            HOST_EEPROM=LOG ./game_host
+*/
+
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "system.h"
+#include "tinygl.h"
+#include "record.h"
+#include "state.h"
+#include "host.h"
+
+
+#define LIBRARY "host/board.so"
+#define TRAILING_FRAMES 500 // Updates run once a log without an end runs out
+#define TRACE_MAX 4096 // Longest trace line compared
+
+
+// The copy of the game being replayed, see board_load()
+typedef struct board_struct
+{
+    void *library; // The copy of host/board.so
+    int (*game_main)(void); // main() of game.c
+    void (*game_state_get)(game_state_t *snapshot);
+    tinygl_point_t (*get_ball)(uint8_t id);
+    tinygl_point_t (*get_paddle_top)(void);
+    void (*cpu_stop)(void);
+    void (*sched_stop)(void);
+    void (*host_navswitch_autopilot_set)(bool enabled);
+    void (*host_ir_loopback_set)(bool enabled);
+    void (*record_observer_set)(record_observer_t observer);
+    void (*record_replay_set)(const uint8_t *log, uint16_t length);
+    uint16_t (*record_replay_mismatches)(void);
+    int (*record_replay_done_p)(void);
+} board_t;
+
+
+static board_t board; // The game being replayed
+static FILE *trace; // Trace of the replay being run
+static unsigned trailing; // Updates run since the log ran out
+
+
+/*
+ * Function: seconds
+ * --------------------
+ * Returns: a monotonic time stamp in seconds
+*/
+static double seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/*
+ * Function: symbol
+ * --------------------
+ * Looks up a symbol in the game's library, exiting if it isn't there
+ *
+ * const char *name: Name of the symbol
+ *
+ * Returns: the address of the symbol
+*/
+static void *symbol(const char *name)
+{
+    void *address = dlsym(board.library, name);
+
+    if (!address) {
+        fprintf(stderr, "replay: %s\n", dlerror());
+        exit(2);
+    }
+    return address;
+}
+
+
+/*
+ * Function: board_load
+ * --------------------
+ * Loads a new copy of the game, its statics as a freshly booted board's.
+ * Only one is loaded at a time, so it shares this program's C library.
+ *
+*/
+static void board_load(void)
+{
+    board.library = dlopen(LIBRARY, RTLD_NOW | RTLD_LOCAL);
+    if (!board.library) {
+        fprintf(stderr, "replay: %s\n", dlerror());
+        exit(2);
+    }
+    board.game_main = symbol("game_main");
+    board.game_state_get = symbol("game_state_get");
+    board.get_ball = symbol("get_ball");
+    board.get_paddle_top = symbol("get_paddle_top");
+    board.cpu_stop = symbol("cpu_stop");
+    board.sched_stop = symbol("sched_stop");
+    board.host_navswitch_autopilot_set = symbol("host_navswitch_autopilot_set");
+    board.host_ir_loopback_set = symbol("host_ir_loopback_set");
+    board.record_observer_set = symbol("record_observer_set");
+    board.record_replay_set = symbol("record_replay_set");
+    board.record_replay_mismatches = symbol("record_replay_mismatches");
+    board.record_replay_done_p = symbol("record_replay_done_p");
+}
+
+
+/*
+ * Function: observe
+ * --------------------
+ * Traces the game state after each update, and stops the game once it
+ * ends or the log runs out. Called by record.c.
+ *
+ * uint16_t frame: Game updates so far
+ *
+*/
+static void observe(uint16_t frame)
+{
+    tinygl_point_t ball = board.get_ball(0);
+    tinygl_point_t paddle = board.get_paddle_top();
+    game_state_t game;
+
+    board.game_state_get(&game);
+    if (frame == 0) {
+        // From here on all input comes from the log, including the
+        // other player's packets, even if they came from the computer
+        board.host_navswitch_autopilot_set(0);
+        board.host_ir_loopback_set(0);
+        board.cpu_stop();
+    }
+    if (trace) {
+        fprintf(trace, "%u %c %d %d %d %d %d %d %d\n", frame,
+                STATE_PHASE_NAMES[game.phase], game.this_score, game.their_score,
+                game.ball_visible, game.ball_incoming, ball.x, ball.y, paddle.y);
+    }
+    if (game.phase == END_STATE
+        || (board.record_replay_done_p() && ++trailing > TRAILING_FRAMES)) {
+        board.sched_stop();
+    }
+}
+
+
+/*
+ * Function: load
+ * --------------------
+ * Reads the log out of a saved EEPROM image
+ *
+ * const char *name: File name of the image
+ * uint8_t *image: Filled in with the image, HOST_EEPROM_SIZE bytes
+ * uint16_t *length: Filled in with the length of the log
+ *
+ * Returns: 1 on success, 0 if the file couldn't be read or holds no log
+*/
+static int load(const char *name, uint8_t *image, uint16_t *length)
+{
+    FILE *file = fopen(name, "rb");
+    size_t size;
+
+    if (!file) {
+        perror(name);
+        return 0;
+    }
+    size = fread(image, 1, HOST_EEPROM_SIZE, file);
+    fclose(file);
+    if (size < RECORD_HEADER_SIZE
+        || image[0] != RECORD_MAGIC_0 || image[1] != RECORD_MAGIC_1) {
+        fprintf(stderr, "%s: no match recording\n", name);
+        return 0;
+    }
+    *length = image[2] << 8 | image[3];
+    if (*length > size - RECORD_HEADER_SIZE) {
+        fprintf(stderr, "%s: recording is cut short\n", name);
+        return 0;
+    }
+    if (image[4] & RECORD_FLAG_TRUNCATED) {
+        fprintf(stderr, "%s: note, the EEPROM filled up before the match ended\n", name);
+    }
+    return 1;
+}
+
+
+/*
+ * Function: compare
+ * --------------------
+ * Compares a trace with the one expected, reporting the first difference
+ *
+ * const char *name: File name of the expected trace
+ * FILE *actual: Trace of the replay, rewound
+ *
+ * Returns: 1 if they match or nothing was expected, 0 otherwise
+*/
+static int compare(const char *name, FILE *actual)
+{
+    FILE *expected = fopen(name, "r");
+    char want[TRACE_MAX];
+    char got[TRACE_MAX];
+    char *want_line;
+    char *got_line;
+    unsigned line = 0;
+
+    if (!expected) {
+        return 1;
+    }
+    do {
+        line++;
+        want_line = fgets(want, sizeof(want), expected);
+        got_line = fgets(got, sizeof(got), actual);
+        if ((want_line == 0) != (got_line == 0)
+            || (want_line && strcmp(want, got) != 0)) {
+            fprintf(stderr, "%s:%u: expected %s", name, line,
+                    want_line ? want : "end of trace\n");
+            fprintf(stderr, "%s:%u: replayed %s", name, line,
+                    got_line ? got : "end of trace\n");
+            fclose(expected);
+            return 0;
+        }
+    } while (want_line);
+    fclose(expected);
+    return 1;
+}
+
+
+/*
+ * Function: replay
+ * --------------------
+ * Replays a log through a new copy of the game
+ *
+ * const char *name: File name of the log
+ * int write: True to write the trace rather than check it
+ *
+ * Returns: 0 if the replay matched the recording, 1 otherwise
+*/
+static int replay(const char *name, int write)
+{
+    uint8_t image[HOST_EEPROM_SIZE];
+    char trace_name[FILENAME_MAX];
+    uint16_t length;
+    int ok;
+
+    if (!load(name, image, &length)) {
+        return 1;
+    }
+    snprintf(trace_name, sizeof(trace_name), "%s.trace", name);
+    trace = write ? fopen(trace_name, "w") : tmpfile();
+    if (!trace) {
+        perror(trace_name);
+        return 1;
+    }
+    trailing = 0;
+    board_load();
+    board.record_observer_set(observe);
+    board.record_replay_set(image + RECORD_HEADER_SIZE, length);
+    board.game_main();
+
+    ok = board.record_replay_mismatches() == 0;
+    if (!ok) {
+        fprintf(stderr, "%s: %u packets sent differ from the recording\n",
+                name, board.record_replay_mismatches());
+    }
+    dlclose(board.library);
+    if (!write) {
+        rewind(trace);
+        ok = compare(trace_name, trace) && ok;
+    }
+    fclose(trace);
+    return !ok;
+}
+
+
+/*
+ * Main method of replay.c.
+ * Replays each log given, each through a new copy of the game.
+ */
+int main(int argc, char **argv)
+{
+    unsigned long repeats = 1;
+    unsigned long runs = 0;
+    unsigned long failures = 0;
+    unsigned long i;
+    double start;
+    double elapsed;
+    int write = 0;
+    int option;
+    int arg;
+
+    while ((option = getopt(argc, argv, "wn:")) != -1) {
+        switch (option) {
+        case 'w':
+            write = 1;
+            break;
+        case 'n':
+            repeats = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-w] [-n repeats] LOG...\n", argv[0]);
+            return 2;
+        }
+    }
+
+    start = seconds();
+    for (arg = optind; arg < argc; arg++) {
+        for (i = 0; i < repeats; i++) {
+            runs++;
+            if (replay(argv[arg], write && i == 0)) {
+                failures++;
+                break;
+            }
+        }
+    }
+    elapsed = seconds() - start;
+
+    printf("%lu replays, %lu failed, in %.3f s (%.0f matches/s)\n", runs,
+           failures, elapsed, elapsed > 0 ? runs / elapsed : 0.0);
+    return failures != 0;
+}
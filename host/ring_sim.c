@@ -0,0 +1,536 @@
+/** @file   ring_sim.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Plays matches across a row of boards (see ring.h) on the
+            host. Every board is a whole copy of the game: host/board.so
+            is loaded once per board with dlmopen(), into a namespace of
+            its own, so each board has its own statics, drivers and all.
+            The boards are run a game update at a time, like the tasks
+            would on the kits, and the bytes each one sends are delivered
+            to both its neighbours, as the IR of boards side by side
+            would be, each byte lost on the way -l in a thousand times.
+
+            The boards connect and number themselves as on the kits,
+            board 0's player pressing the navswitch down, or two boards
+            find each other by themselves, a millisecond of each board's
+            time passing every connection step. Then board 0's player
+            starts the game, or between two boards the player who serves. The players at the two ends track the
+            ball, misjudging it by two pixels -e percent of the time.
+            Each match runs in a process of its own, and at the end every
+            board must agree on the score.
+
+            With -o the frames for spectators (see broadcast.h) that a
+            listener in range of every board would hear are written to a
+            file or pipe, for host/spectate to show; the boards only send
+            them if board.so was built with HOST_DEFINES=-DBROADCAST.
+
+            Usage: ring_sim [-b boards] [-l loss] [-e error%] [-s seed]
+                            [-o listener] [-v] [matches]
+*/
+
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "system.h"
+#include "timer.h"
+#include "navswitch.h"
+#include "tinygl.h"
+#include "packet.h"
+#include "link.h"
+#include "ball.h"
+#include "state.h"
+#include "ring.h"
+
+
+#define LIBRARY "host/board.so"
+#define DEFAULT_MATCHES 10
+#define DEFAULT_BOARDS 4
+#define DEFAULT_ERROR 20 // Percentage of balls a tracking player misjudges
+#define MISJUDGED_AIM 2 // Pixels a misjudged ball is off the paddle's centre
+#define BOARDS_MAX 8 // Namespaces dlmopen() can be relied on for
+#define MATCHES_MAX 10000
+#define END_TEXT_SIZE 16
+
+#define NAVSWITCH_RATE 20 // Player decisions per second, the navswitch task's rate
+#define IR_TASK_RUNS 4 // IR task runs a game update, each taking a packet at most
+#define CONNECT_STEP_TICKS (TIMER_RATE / 1000) // Time each connection step takes
+#define CONNECT_STEPS_MAX 10000 // Connection steps before the boards are given up on
+#define PRESS_AGAIN_STEPS 50 // Connection steps before a player presses the navswitch again
+#define MATCH_SECONDS_MAX 600 // Matches still going after this are abandoned
+#define MATCH_FRAMES_MAX (MATCH_SECONDS_MAX * BALL_UPDATE_RATE)
+
+
+typedef struct board_struct
+{
+    void *library; // This board's copy of host/board.so
+    game_state_t *game;
+    void (*game_init)(void);
+    void (*ring_init)(uint8_t boards);
+    int (*connection_step)(void);
+    void (*game_start)(void);
+    void (*navswitch_task)(void *data);
+    void (*game_task)(void *data);
+    void (*ir_task)(void *data);
+    void (*display_task)(void *data);
+    uint8_t (*ring_position)(void);
+    int (*discovery_serving)(void);
+    void (*hal_sleep_until)(uint16_t deadline, volatile uint8_t *events);
+    uint32_t (*host_ticks)(void);
+    tinygl_point_t (*get_ball)(uint8_t id);
+    tinygl_point_t (*get_paddle_top)(void);
+    tinygl_point_t (*get_paddle_bottom)(void);
+    int (*input_event_put)(uint8_t navswitch, uint8_t pressed);
+    void (*paddle_update)(void);
+    void (*host_navswitch_press)(uint8_t navswitch);
+    int (*host_ir_transmitted)(void);
+    void (*host_ir_receive)(uint8_t byte);
+    void (*banner_text_get)(char *text, uint8_t size);
+    void (*link_stats_get)(link_stats_t *stats);
+    int started; // True once connected and game_start() has been called
+    int aiming; // True once the player has judged the ball on screen
+    int aim; // Pixels from the paddle's centre the player aims for
+} board_t;
+
+
+typedef struct result_struct
+{
+    int unconnected; // True if the boards never all connected, so the match wasn't played
+    int finished; // True if every board got to the end of the match
+    int agreed; // True if every board had the same score
+    int left_score; // Board 0's player's score, on board 0
+    int right_score; // The last board's player's score, on the last board
+    unsigned long frames; // Game updates the match took
+    unsigned long sent; // Packets sent that needed an ACK, over every board
+    unsigned long retransmits;
+    unsigned long failed;
+    unsigned long balls[BOARDS_MAX - 1]; // Ball frames sent across each gap, repeats too
+    unsigned long spectated; // Frames sent for spectators, over every board
+    char text[BOARDS_MAX][END_TEXT_SIZE]; // What each board shows at the end
+} result_t;
+
+
+static unsigned boards_num = DEFAULT_BOARDS; // Boards in the ring
+static unsigned loss = 0; // Bytes lost on the way, in a thousand
+static unsigned error_percent = DEFAULT_ERROR; // Balls a tracking player misjudges
+static uint32_t seed = 1; // Seed the matches' random numbers are made from
+static uint32_t rng; // This match's random number state
+static result_t *results; // One per match, shared with the match processes
+static FILE *listener; // Frames for spectators are written to it, see -o
+
+
+/*
+ * Function: rng_next
+ * --------------------
+ * Returns: the next of this match's random numbers, a 32 bit xorshift
+*/
+static uint32_t rng_next(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+
+/*
+ * Function: symbol
+ * --------------------
+ * Looks up a symbol in a board's library, exiting if it isn't there
+ *
+ * board_t *board: Board to look in
+ * const char *name: Name of the symbol
+ *
+ * Returns: the address of the symbol
+*/
+static void *symbol(board_t *board, const char *name)
+{
+    void *address = dlsym(board->library, name);
+
+    if (!address) {
+        fprintf(stderr, "ring_sim: %s\n", dlerror());
+        exit(1);
+    }
+    return address;
+}
+
+
+/*
+ * Function: board_load
+ * --------------------
+ * Loads a new copy of the game for a board and initializes it, ready
+ * to connect
+ *
+ * board_t *board: Board to load
+ * uint32_t board_seed: Seed of the board's random numbers, for discovery
+ *
+*/
+static void board_load(board_t *board, uint32_t board_seed)
+{
+    memset(board, 0, sizeof(*board));
+    board->library = dlmopen(LM_ID_NEWLM, LIBRARY, RTLD_NOW);
+    if (!board->library) {
+        fprintf(stderr, "ring_sim: %s\n", dlerror());
+        exit(1);
+    }
+    board->game = symbol(board, "game");
+    board->game_init = symbol(board, "game_init");
+    board->ring_init = symbol(board, "ring_init");
+    board->connection_step = symbol(board, "connection_step");
+    board->game_start = symbol(board, "game_start");
+    board->navswitch_task = symbol(board, "navswitch_task_");
+    board->game_task = symbol(board, "game_task_");
+    board->ir_task = symbol(board, "ir_task_");
+    board->display_task = symbol(board, "display_task_");
+    board->ring_position = symbol(board, "ring_position");
+    board->discovery_serving = symbol(board, "discovery_serving");
+    board->hal_sleep_until = symbol(board, "hal_sleep_until");
+    board->host_ticks = symbol(board, "host_ticks");
+    board->get_ball = symbol(board, "get_ball");
+    board->get_paddle_top = symbol(board, "get_paddle_top");
+    board->get_paddle_bottom = symbol(board, "get_paddle_bottom");
+    board->input_event_put = symbol(board, "input_event_put");
+    board->paddle_update = symbol(board, "paddle_update");
+    board->host_navswitch_press = symbol(board, "host_navswitch_press");
+    board->host_ir_transmitted = symbol(board, "host_ir_transmitted");
+    board->host_ir_receive = symbol(board, "host_ir_receive");
+    board->banner_text_get = symbol(board, "banner_text_get");
+    board->link_stats_get = symbol(board, "link_stats_get");
+
+    ((void (*)(uint32_t)) symbol(board, "host_seed_set"))(board_seed);
+    board->game_init();
+    board->ring_init(boards_num);
+    ((void (*)(bool)) symbol(board, "host_ir_loopback_set"))(0);
+    ((void (*)(bool)) symbol(board, "host_navswitch_autopilot_set"))(0);
+}
+
+
+/*
+ * Function: player_move
+ * --------------------
+ * Pushes the navswitch for a player at one end of the ring
+ *
+ * board_t *board: Board of the player
+ *
+*/
+static void player_move(board_t *board)
+{
+    int target = board->get_ball(0).y;
+    int centre = (board->get_paddle_top().y + board->get_paddle_bottom().y) / 2;
+
+    if (!(board->game->ball_visible & 1)) {
+        board->aiming = 0;
+    } else {
+        if (!board->aiming) {
+            if (rng_next() % 100 < error_percent) {
+                board->aim = rng_next() & 1 ? MISJUDGED_AIM : -MISJUDGED_AIM;
+            } else {
+                board->aim = (int) (rng_next() % 3) - 1;
+            }
+            board->aiming = 1;
+        }
+        target -= board->aim;
+        if (target < centre) {
+            board->input_event_put(NAVSWITCH_NORTH, 1);
+        } else if (target > centre) {
+            board->input_event_put(NAVSWITCH_SOUTH, 1);
+        }
+    }
+    board->paddle_update();
+}
+
+
+/*
+ * Function: deliver
+ * --------------------
+ * Passes the bytes a board has sent to its neighbours, losing some,
+ * and counts the ball frames among them
+ *
+ * board_t *boards: Every board
+ * unsigned b: Board that sent them
+ * packet_decoder_t *decoders: A decoder for each board, of what it sent
+ * int (*decode)(packet_decoder_t *, uint8_t, packet_t *): packet_decode()
+ * uint8_t (*encode)(uint8_t *, const packet_t *): packet_encode()
+ * result_t *result: Result of the match, counting the ball frames
+ *
+*/
+static void deliver(board_t *boards, unsigned b, packet_decoder_t *decoders,
+                    int (*decode)(packet_decoder_t *, uint8_t, packet_t *),
+                    uint8_t (*encode)(uint8_t *, const packet_t *), result_t *result)
+{
+    uint8_t frame[PACKET_FRAME_MAX];
+    packet_t packet;
+    int byte;
+
+    while ((byte = boards[b].host_ir_transmitted()) >= 0) {
+        if (!decode(&decoders[b], byte, &packet)) {
+            // Not the end of a frame yet
+        } else if (packet.type == PACKET_BALL) {
+            // Between two boards frames have no address
+            if (packet.address && PACKET_SIDE_TO(packet.address) == RING_LEFT) {
+                result->balls[b - 1]++;
+            } else {
+                result->balls[b == boards_num - 1 ? b - 1 : b]++;
+            }
+        } else if (packet.type == PACKET_SPECTATE) {
+            result->spectated++;
+            if (listener) {
+                fwrite(frame, 1, encode(frame, &packet), listener);
+            }
+        }
+        if (b > 0 && rng_next() % 1000 >= loss) {
+            boards[b - 1].host_ir_receive(byte);
+        }
+        if (b < boards_num - 1 && rng_next() % 1000 >= loss) {
+            boards[b + 1].host_ir_receive(byte);
+        }
+    }
+}
+
+
+/*
+ * Function: play_match
+ * --------------------
+ * Connects a new ring of boards and plays a match across it, in a
+ * process of its own
+ *
+ * uint32_t match: Number of the match, seeding its random numbers
+ * result_t *result: Filled in with the result
+ *
+*/
+static void play_match(uint32_t match, result_t *result)
+{
+    board_t boards[BOARDS_MAX];
+    packet_decoder_t decoders[BOARDS_MAX];
+    int (*decode)(packet_decoder_t *, uint8_t, packet_t *);
+    uint8_t (*encode)(uint8_t *, const packet_t *);
+    link_stats_t stats;
+    unsigned long frame;
+    volatile uint8_t events = 0;
+    unsigned started = 0;
+    unsigned ended = 0;
+    unsigned step;
+    unsigned b;
+    unsigned i;
+    const game_state_t *left;
+    const game_state_t *right;
+
+    rng = (seed ^ (match * 0x9E3779B9u)) | 1;
+    for (b = 0; b < boards_num; b++) {
+        board_load(&boards[b], (seed ^ (match * 0x9E3779B9u) ^ (b * 0x85EBCA6Bu)) | 1);
+        ((void (*)(packet_decoder_t *)) symbol(&boards[b], "packet_decoder_init"))(&decoders[b]);
+    }
+    decode = symbol(&boards[0], "packet_decode");
+    encode = symbol(&boards[0], "packet_encode");
+
+    // Board 0's player presses the navswitch down, and again every so
+    // often until a ring connects; two boards find each other, and go
+    // on until they agree who serves
+    for (step = 0; step < CONNECT_STEPS_MAX
+                   && (started < boards_num
+                       || (boards_num == 2 && !boards[0].discovery_serving()
+                           && !boards[1].discovery_serving())); step++) {
+        for (b = 0; b < boards_num; b++) {
+            if (step % PRESS_AGAIN_STEPS == 0 && !boards[b].started && b == 0 && boards_num > 2) {
+                boards[b].host_navswitch_press(NAVSWITCH_PUSH);
+            }
+            if (boards[b].started) {
+                boards[b].ir_task(0);
+            } else if (boards[b].connection_step()) {
+                boards[b].game_start();
+                boards[b].started = 1;
+                started++;
+            }
+            deliver(boards, b, decoders, decode, encode, result);
+            boards[b].hal_sleep_until((uint16_t) (boards[b].host_ticks() + CONNECT_STEP_TICKS), &events);
+        }
+    }
+    for (b = 0; b < boards_num; b++) {
+        if (!boards[b].started || (boards_num > 2 && boards[b].ring_position() != b)) {
+            result->unconnected = 1;
+            return;
+        }
+    }
+
+    // Board 0's player starts the game, or the one who serves
+    b = boards_num == 2 && boards[1].discovery_serving();
+    boards[b].input_event_put(NAVSWITCH_PUSH, 1);
+    boards[b].navswitch_task(0);
+    for (frame = 0; frame < MATCH_FRAMES_MAX && ended < boards_num; frame++) {
+        ended = 0;
+        for (b = 0; b < boards_num; b++) {
+            if ((b == 0 || b == boards_num - 1) && boards[b].game->phase == PLAYING_STATE
+                && (frame + 1) * NAVSWITCH_RATE / BALL_UPDATE_RATE
+                   != frame * NAVSWITCH_RATE / BALL_UPDATE_RATE) {
+                player_move(&boards[b]);
+            }
+            boards[b].game_task(0);
+            deliver(boards, b, decoders, decode, encode, result);
+        }
+        for (b = 0; b < boards_num; b++) {
+            for (i = 0; i < IR_TASK_RUNS; i++) {
+                boards[b].ir_task(0);
+            }
+            ended += boards[b].game->phase == END_STATE;
+        }
+    }
+    result->frames = frame;
+    result->finished = ended == boards_num;
+
+    // Board 0 keeps its player's score as this_score, every other board
+    // keeps the right hand player's
+    left = boards[0].game;
+    right = boards[boards_num - 1].game;
+    result->left_score = left->this_score;
+    result->right_score = right->this_score;
+    result->agreed = 1;
+    for (b = 0; b < boards_num; b++) {
+        const game_state_t *game = boards[b].game;
+
+        if (b > 0 && (game->this_score != left->their_score || game->their_score != left->this_score)) {
+            result->agreed = 0;
+        }
+        boards[b].display_task(0);
+        boards[b].banner_text_get(result->text[b], END_TEXT_SIZE);
+        boards[b].link_stats_get(&stats);
+        result->sent += stats.sent;
+        result->retransmits += stats.retransmits;
+        result->failed += stats.failed;
+    }
+    if (listener) {
+        fflush(listener);
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long matches;
+    unsigned long match;
+    unsigned long unconnected = 0;
+    unsigned long finished = 0;
+    unsigned long agreed = 0;
+    unsigned long left_wins = 0;
+    unsigned long long frames = 0;
+    unsigned long sent = 0;
+    unsigned long retransmits = 0;
+    unsigned long failed = 0;
+    unsigned long balls[BOARDS_MAX - 1] = {0};
+    unsigned long spectated = 0;
+    int verbose = 0;
+    result_t *result;
+    pid_t pid;
+    int status;
+    int option;
+    unsigned b;
+
+    while ((option = getopt(argc, argv, "b:l:e:s:o:v")) != -1) {
+        switch (option) {
+        case 'b':
+            boards_num = strtoul(optarg, NULL, 0);
+            break;
+        case 'l':
+            loss = strtoul(optarg, NULL, 0);
+            break;
+        case 'e':
+            error_percent = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        case 'o':
+            listener = fopen(optarg, "wb");
+            if (!listener) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-b boards] [-l loss] [-e error%%] [-s seed] [-o listener] [-v]"
+                    " [matches]\n", argv[0]);
+            return 1;
+        }
+    }
+    matches = optind < argc ? strtoul(argv[optind], NULL, 0) : DEFAULT_MATCHES;
+    if (boards_num < 2 || boards_num > BOARDS_MAX || boards_num > RING_BOARDS_MAX) {
+        fprintf(stderr, "%s: boards must be 2 to %d\n", argv[0],
+                BOARDS_MAX < RING_BOARDS_MAX ? BOARDS_MAX : RING_BOARDS_MAX);
+        return 1;
+    }
+    if (matches > MATCHES_MAX) {
+        matches = MATCHES_MAX;
+    }
+
+    results = mmap(NULL, matches * sizeof(*results), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    for (match = 0; match < matches; match++) {
+        result = &results[match];
+        memset(result, 0, sizeof(*result));
+        fflush(stdout);
+        pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            play_match(match, result);
+            _exit(0);
+        }
+        if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status)) {
+            fprintf(stderr, "%s: match %lu failed\n", argv[0], match);
+            return 1;
+        }
+
+        if (verbose && result->unconnected) {
+            printf("match %lu: the boards never connected\n", match);
+        } else if (verbose) {
+            printf("match %lu: %d-%d in %.1f s%s%s, boards show", match, result->left_score,
+                   result->right_score, (double) result->frames / BALL_UPDATE_RATE,
+                   result->finished ? "" : ", abandoned", result->agreed ? "" : ", scores disagree");
+            for (b = 0; b < boards_num; b++) {
+                printf(" \"%s\"", result->text[b]);
+            }
+            printf("\n");
+        }
+        unconnected += result->unconnected;
+        finished += result->finished;
+        agreed += result->finished && result->agreed;
+        left_wins += result->finished && result->left_score > result->right_score;
+        frames += result->frames;
+        sent += result->sent;
+        retransmits += result->retransmits;
+        failed += result->failed;
+        for (b = 0; b + 1 < boards_num; b++) {
+            balls[b] += result->balls[b];
+        }
+        spectated += result->spectated;
+    }
+
+    printf("%u boards, %lu matches, %lu never connected, %lu finished, %lu with every board"
+           " agreeing on the score\n", boards_num, matches, unconnected, finished, agreed);
+    printf("board 0's player won %lu, mean match %.1f s\n", left_wins,
+           matches ? (double) frames / matches / BALL_UPDATE_RATE : 0.0);
+    printf("link: %lu sent, %lu sent again, %lu given up on (%u bytes in 1000 lost)\n",
+           sent, retransmits, failed, loss);
+    printf("ball frames across each gap, per match:");
+    for (b = 0; b + 1 < boards_num; b++) {
+        printf(" %.1f", matches ? (double) balls[b] / matches : 0.0);
+    }
+    printf("\n");
+    if (spectated) {
+        printf("frames for spectators, per match: %.1f\n", (double) spectated / matches);
+    }
+    return finished == matches && agreed == matches ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+/** @file   spectate.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host tool that watches a match as a spectator would, from
+            the frames the boards broadcast (see broadcast.h). It reads
+            the bytes a listener heard from a file, or a pipe with the
+            match still going, such as ring_sim -o writes, and draws the
+            two players' screens side by side as one court, with the
+            scores, each time a frame arrives.
+
+            Board 0, whose player started the game, is drawn on the left
+            and the other player's on the right. Each board only knows
+            where its own paddle is, so a paddle is drawn where the last
+            frame from its board put it.
+
+            Usage: spectate [-a] [LISTENER]
+            where -a redraws the court in place, as an animation, and
+            LISTENER defaults to the standard input
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "system.h"
+#include "tinygl.h"
+#include "packet.h"
+#include "ball.h"
+#include "state.h"
+#include "broadcast.h"
+#include "geometry.h"
+
+
+#define COURT_WIDTH (2 * GRID_WIDTH) // Columns of the two screens, side by side
+#define PADDLE_LENGTH (PADDLE_TOP_INIT_Y - PADDLE_BOTTOM_INIT_Y + 1)
+#define LEFT 0 // The board whose player started the game
+#define RIGHT 1
+#define NO_PADDLE 0xFF // Row of a paddle no frame has placed yet
+
+
+static uint8_t paddle_bottom[2] = {NO_PADDLE, NO_PADDLE}; // Last known row of each paddle
+
+
+/*
+ * Function: draw
+ * --------------------
+ * Draws the court as the latest frame has it
+ *
+ * const broadcast_frame_t *frame: Latest frame
+ * int animate: True to draw over the last court, false to draw below it
+ *
+*/
+static void draw(const broadcast_frame_t *frame, int animate)
+{
+    const game_state_t *state = &frame->state;
+    uint8_t side = state->player_num ? LEFT : RIGHT;
+    uint8_t left_score = side == LEFT ? state->this_score : state->their_score;
+    uint8_t right_score = side == LEFT ? state->their_score : state->this_score;
+    int ball_column = -1;
+    int ball_row = -1;
+    int column;
+    int row;
+    uint8_t bottom;
+
+    // The sending board's screen is turned to face the court, the right
+    // hand one upside down as it faces the left
+    if (state->ball_visible && side == LEFT) {
+        ball_column = GOAL_X - frame->ball_x;
+        ball_row = frame->ball_y;
+    } else if (state->ball_visible) {
+        ball_column = GRID_WIDTH + frame->ball_x;
+        ball_row = TOP_WALL_Y - frame->ball_y;
+    }
+
+    if (animate) {
+        printf("\033[H\033[J");
+    }
+    printf("%u - %u  at %.1f s%s\n", left_score, right_score,
+           (double) frame->tick / BALL_UPDATE_RATE, state->phase == END_STATE ? ", finished" : "");
+    for (row = TOP_WALL_Y; row >= BOTTOM_WALL_Y; row--) {
+        putchar('|');
+        for (column = 0; column < COURT_WIDTH; column++) {
+            bottom = paddle_bottom[column < GRID_WIDTH ? LEFT : RIGHT];
+            if (column == ball_column && row == ball_row) {
+                putchar('o');
+            } else if (bottom != NO_PADDLE && column == 0 && row >= bottom
+                       && row < bottom + PADDLE_LENGTH) {
+                putchar(']');
+            } else if (bottom != NO_PADDLE && column == COURT_WIDTH - 1
+                       && TOP_WALL_Y - row >= bottom && TOP_WALL_Y - row < bottom + PADDLE_LENGTH) {
+                putchar('[');
+            } else {
+                putchar(column == GRID_WIDTH - 1 || column == GRID_WIDTH ? ':' : ' ');
+            }
+        }
+        printf("|\n");
+    }
+    if (!animate) {
+        putchar('\n');
+    }
+    fflush(stdout);
+}
+
+
+int main(int argc, char **argv)
+{
+    FILE *input = stdin;
+    packet_decoder_t decoder;
+    packet_t packet;
+    broadcast_frame_t frame;
+    unsigned long frames = 0;
+    unsigned long games = 0;
+    uint16_t last_tick = 0;
+    int animate = 0;
+    int option;
+    int byte;
+
+    while ((option = getopt(argc, argv, "a")) != -1) {
+        switch (option) {
+        case 'a':
+            animate = 1;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-a] [LISTENER]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind < argc) {
+        input = fopen(argv[optind], "rb");
+        if (!input) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    packet_decoder_init(&decoder);
+    while ((byte = getc(input)) != EOF) {
+        if (!packet_decode(&decoder, byte, &packet) || !broadcast_unpack(&packet, &frame)) {
+            continue;
+        }
+        // The tick starts again with each game; the two boards' ticks are
+        // only a hand-off apart
+        if (!frames || frame.tick + BALL_UPDATE_RATE < last_tick) {
+            games++;
+            paddle_bottom[LEFT] = NO_PADDLE;
+            paddle_bottom[RIGHT] = NO_PADDLE;
+        }
+        last_tick = frame.tick;
+        frames++;
+        paddle_bottom[frame.state.player_num ? LEFT : RIGHT] = frame.state.paddle_bottom;
+        draw(&frame, animate);
+    }
+    printf("%lu frames, %lu games\n", frames, games);
+    return 0;
+}
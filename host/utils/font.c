@@ -0,0 +1,35 @@
+/** @file   font.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 font lookup
+*/
+
+
+#include "system.h"
+#include "font.h"
+
+
+/*
+ * Function: font_pixel_get
+ * --------------------
+ * Finds whether a pixel of a glyph is lit
+ *
+ * font_t *font: Font the glyph is in
+ * char ch: Character of the glyph
+ * uint8_t col: Column of the pixel, below the font's width
+ * uint8_t row: Row of the pixel, below the font's height
+ *
+ * Returns: true if it is lit, false if not or the font has no glyph for ch
+*/
+bool font_pixel_get(font_t *font, char ch, uint8_t col, uint8_t row)
+{
+    int index = ch - font->offset;
+    unsigned int offset;
+
+    if (index < 0 || index >= font->size || !font->data) {
+        return false;
+    }
+    // Packed fonts run the rows together, a bit per pixel
+    offset = row * font->width + col;
+    return (font->data[index * font->bytes + offset / 8] >> (offset % 8)) & 1;
+}
@@ -0,0 +1,38 @@
+/** @file   font.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 font definitions
+*/
+
+#ifndef FONT_H
+#define FONT_H
+
+#include "system.h"
+
+typedef struct font_struct
+{
+    uint8_t flags; // Font flags
+    uint8_t width; // Glyph width in pixels
+    uint8_t height; // Glyph height in pixels
+    uint8_t offset; // Character code of the first glyph
+    uint8_t size; // Number of glyphs
+    uint8_t bytes; // Bytes per glyph
+    const uint8_t *data; // Glyph bitmaps
+} font_t;
+
+
+/*
+ * Function: font_pixel_get
+ * --------------------
+ * Finds whether a pixel of a glyph is lit
+ *
+ * font_t *font: Font the glyph is in
+ * char ch: Character of the glyph
+ * uint8_t col: Column of the pixel, below the font's width
+ * uint8_t row: Row of the pixel, below the font's height
+ *
+ * Returns: true if it is lit, false if not or the font has no glyph for ch
+*/
+bool font_pixel_get(font_t *font, char ch, uint8_t col, uint8_t row);
+
+#endif
@@ -0,0 +1,228 @@
+/** @file   tinygl.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 tiny graphics library
+*/
+
+
+#include <string.h>
+#include "system.h"
+#include "tinygl.h"
+#include "host.h"
+
+
+#define TEXT_SIZE 32
+
+
+static tinygl_pixel_value_t frame[TINYGL_WIDTH][TINYGL_HEIGHT]; // Simulated matrix
+static char text[TEXT_SIZE]; // Text most recently displayed
+static unsigned long pixel_writes; // Number of pixels written
+
+
+/*
+ * Function: tinygl_point
+ * --------------------
+ * Returns: a point with the given co-ordinates
+*/
+tinygl_point_t tinygl_point(tinygl_coord_t x, tinygl_coord_t y)
+{
+    tinygl_point_t point = {x, y};
+
+    return point;
+}
+
+
+/*
+ * Function: tinygl_init
+ * --------------------
+ * Initializes the simulated display
+ *
+ * uint16_t update_rate: Rate tinygl_update() will be called at
+ *
+*/
+void tinygl_init(__unused__ uint16_t update_rate)
+{
+    tinygl_clear();
+}
+
+
+/*
+ * Function: tinygl_update
+ * --------------------
+ * Refreshes the simulated display, there is nothing to scan off-board
+ *
+*/
+void tinygl_update(void)
+{
+}
+
+
+/*
+ * Function: tinygl_clear
+ * --------------------
+ * Clears the simulated display and any text
+ *
+*/
+void tinygl_clear(void)
+{
+    memset(frame, 0, sizeof(frame));
+    text[0] = '\0';
+}
+
+
+/*
+ * Function: tinygl_pixel_set
+ * --------------------
+ * Sets a single pixel, ignoring points off the display
+ *
+*/
+void tinygl_pixel_set(tinygl_point_t point, tinygl_pixel_value_t value)
+{
+    if (point.x >= 0 && point.x < TINYGL_WIDTH
+        && point.y >= 0 && point.y < TINYGL_HEIGHT) {
+        frame[point.x][point.y] = value;
+        pixel_writes++;
+    }
+}
+
+
+/*
+ * Function: tinygl_pixel_get
+ * --------------------
+ * Returns: the value of a single pixel, 0 for points off the display
+*/
+tinygl_pixel_value_t tinygl_pixel_get(tinygl_point_t point)
+{
+    if (point.x >= 0 && point.x < TINYGL_WIDTH
+        && point.y >= 0 && point.y < TINYGL_HEIGHT) {
+        return frame[point.x][point.y];
+    }
+    return 0;
+}
+
+
+/*
+ * Function: tinygl_draw_point
+ * --------------------
+ * Draws a single point
+ *
+*/
+void tinygl_draw_point(tinygl_point_t point, tinygl_pixel_value_t value)
+{
+    tinygl_pixel_set(point, value);
+}
+
+
+/*
+ * Function: tinygl_draw_line
+ * --------------------
+ * Draws a line between two points, inclusive, using Bresenham's
+ * algorithm like the kit library
+ *
+*/
+void tinygl_draw_line(tinygl_point_t point1, tinygl_point_t point2,
+                      tinygl_pixel_value_t value)
+{
+    int dx = point2.x > point1.x ? point2.x - point1.x : point1.x - point2.x;
+    int dy = point2.y > point1.y ? point2.y - point1.y : point1.y - point2.y;
+    int step_x = point2.x > point1.x ? 1 : -1;
+    int step_y = point2.y > point1.y ? 1 : -1;
+    int error = dx - dy;
+    int error2;
+
+    while (1) {
+        tinygl_pixel_set(point1, value);
+        if (point1.x == point2.x && point1.y == point2.y) {
+            break;
+        }
+        error2 = 2 * error;
+        if (error2 > -dy) {
+            error -= dy;
+            point1.x += step_x;
+        }
+        if (error2 < dx) {
+            error += dx;
+            point1.y += step_y;
+        }
+    }
+}
+
+
+/*
+ * Function: tinygl_font_set
+ * --------------------
+ * Sets the font used for text
+ *
+*/
+void tinygl_font_set(__unused__ font_t *font)
+{
+}
+
+
+/*
+ * Function: tinygl_text_mode_set
+ * --------------------
+ * Sets the text mode
+ *
+*/
+void tinygl_text_mode_set(__unused__ tinygl_text_mode_t mode)
+{
+}
+
+
+/*
+ * Function: tinygl_text_speed_set
+ * --------------------
+ * Sets the text scroll speed in characters per 10 seconds
+ *
+*/
+void tinygl_text_speed_set(__unused__ uint8_t speed)
+{
+}
+
+
+/*
+ * Function: tinygl_text
+ * --------------------
+ * Displays a string, the host only records it for host_text_get()
+ *
+*/
+void tinygl_text(const char *string)
+{
+    strncpy(text, string, TEXT_SIZE - 1);
+    text[TEXT_SIZE - 1] = '\0';
+}
+
+
+/*
+ * Function: host_pixel_get
+ * --------------------
+ * Returns: the value last drawn to a pixel of the simulated matrix
+*/
+uint8_t host_pixel_get(uint8_t x, uint8_t y)
+{
+    return tinygl_pixel_get(tinygl_point(x, y));
+}
+
+
+/*
+ * Function: host_pixel_writes
+ * --------------------
+ * Returns: the number of pixels written to the simulated matrix so far,
+ * a hardware independent measure of drawing cost
+*/
+unsigned long host_pixel_writes(void)
+{
+    return pixel_writes;
+}
+
+
+/*
+ * Function: host_text_get
+ * --------------------
+ * Returns: the text most recently passed to tinygl_text()
+*/
+const char *host_text_get(void)
+{
+    return text;
+}
@@ -0,0 +1,143 @@
+/** @file   tinygl.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  Host (Linux) stand-in for the UCFK4 tiny graphics library.
+            Drawing goes to an in-memory frame the size of the LED
+            matrix that host tools can inspect with host_pixel_get().
+*/
+
+#ifndef TINYGL_H
+#define TINYGL_H
+
+#include "system.h"
+#include "font.h"
+
+#define TINYGL_WIDTH LEDMAT_COLS_NUM
+#define TINYGL_HEIGHT LEDMAT_ROWS_NUM
+
+typedef int8_t tinygl_coord_t;
+
+typedef uint8_t tinygl_pixel_value_t;
+
+typedef struct tinygl_point
+{
+    tinygl_coord_t x;
+    tinygl_coord_t y;
+} tinygl_point_t;
+
+typedef enum
+{
+    TINYGL_TEXT_MODE_STEP,
+    TINYGL_TEXT_MODE_SCROLL
+} tinygl_text_mode_t;
+
+
+/*
+ * Function: tinygl_point
+ * --------------------
+ * Returns: a point with the given co-ordinates
+*/
+tinygl_point_t tinygl_point(tinygl_coord_t x, tinygl_coord_t y);
+
+
+/*
+ * Function: tinygl_init
+ * --------------------
+ * Initializes the simulated display
+ *
+ * uint16_t update_rate: Rate tinygl_update() will be called at
+ *
+*/
+void tinygl_init(uint16_t update_rate);
+
+
+/*
+ * Function: tinygl_update
+ * --------------------
+ * Refreshes the simulated display, there is nothing to scan off-board
+ *
+*/
+void tinygl_update(void);
+
+
+/*
+ * Function: tinygl_clear
+ * --------------------
+ * Clears the simulated display and any text
+ *
+*/
+void tinygl_clear(void);
+
+
+/*
+ * Function: tinygl_pixel_set
+ * --------------------
+ * Sets a single pixel, ignoring points off the display
+ *
+*/
+void tinygl_pixel_set(tinygl_point_t point, tinygl_pixel_value_t value);
+
+
+/*
+ * Function: tinygl_pixel_get
+ * --------------------
+ * Returns: the value of a single pixel, 0 for points off the display
+*/
+tinygl_pixel_value_t tinygl_pixel_get(tinygl_point_t point);
+
+
+/*
+ * Function: tinygl_draw_point
+ * --------------------
+ * Draws a single point
+ *
+*/
+void tinygl_draw_point(tinygl_point_t point, tinygl_pixel_value_t value);
+
+
+/*
+ * Function: tinygl_draw_line
+ * --------------------
+ * Draws a line between two points, inclusive
+ *
+*/
+void tinygl_draw_line(tinygl_point_t point1, tinygl_point_t point2,
+                      tinygl_pixel_value_t value);
+
+
+/*
+ * Function: tinygl_font_set
+ * --------------------
+ * Sets the font used for text
+ *
+*/
+void tinygl_font_set(font_t *font);
+
+
+/*
+ * Function: tinygl_text_mode_set
+ * --------------------
+ * Sets the text mode
+ *
+*/
+void tinygl_text_mode_set(tinygl_text_mode_t mode);
+
+
+/*
+ * Function: tinygl_text_speed_set
+ * --------------------
+ * Sets the text scroll speed in characters per 10 seconds
+ *
+*/
+void tinygl_text_speed_set(uint8_t speed);
+
+
+/*
+ * Function: tinygl_text
+ * --------------------
+ * Displays a string, the host only records it for host_text_get()
+ *
+*/
+void tinygl_text(const char *string);
+
+#endif
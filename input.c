@@ -0,0 +1,266 @@
+/** @file   input.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module handles the interrupt driven navswitch input of
+            the pong game. Like the IR receive buffer the event queue is
+            single producer (the interrupt), single consumer (the tasks),
+            so no locking is needed to take events from it.
+*/
+
+
+#include <string.h>
+#include "system.h"
+#include "timer.h"
+#include "navswitch.h"
+#include "hal.h"
+#include "sched.h"
+#include "record.h"
+#include "input.h"
+
+
+#define INPUT_INDEX_MASK (INPUT_QUEUE_SIZE - 1)
+#define INPUT_DEBOUNCE_TICKS (TIMER_RATE / 200) // 5 ms
+
+// Stages of measuring a latency
+enum {LATENCY_IDLE, LATENCY_MOVED, LATENCY_DRAWN};
+
+
+static volatile input_event_t queue[INPUT_QUEUE_SIZE]; // Queued transitions
+static volatile uint8_t head; // Count of events queued, only written by the interrupt
+static volatile uint8_t tail; // Count of events taken, only written by the tasks
+static uint8_t debounced; // Directions held down, as last queued
+static uint16_t last_change[NAVSWITCH_NUM]; // Tick of each direction's last transition
+
+static uint8_t latency_stage; // Stage of the latency being measured
+static uint8_t latency_column; // Display column waited for
+static uint16_t latency_start; // Tick of the transition being measured
+static uint16_t latency_samples[INPUT_LATENCY_SAMPLES]; // Latest latencies
+static input_latency_t latency; // Latencies measured so far
+
+
+/*
+ * Function: input_init
+ * --------------------
+ * Empties the event queue and enables the navswitch pin change
+ * interrupts. Must be called after navswitch_init().
+ *
+*/
+void input_init(void)
+{
+    uint8_t i;
+
+    head = 0;
+    tail = 0;
+    debounced = 0;
+    for (i = 0; i < NAVSWITCH_NUM; i++) {
+        last_change[i] = hal_timer_get() - INPUT_DEBOUNCE_TICKS;
+    }
+    latency_stage = LATENCY_IDLE;
+    hal_navswitch_interrupt_enable();
+}
+
+
+/*
+ * Function: input_isr
+ * --------------------
+ * Queues the navswitch transitions, called from the pin change
+ * interrupts, and wakes the tasks waiting on SCHED_EVENT_INPUT. A
+ * direction is debounced by ignoring it for INPUT_DEBOUNCE_TICKS after
+ * each transition, so the first edge is acted on straight away.
+ *
+ * uint8_t down: Bitmask of the directions held down
+ *
+*/
+void input_isr(uint8_t down)
+{
+    uint16_t now = hal_timer_get();
+    uint8_t changed = down ^ debounced;
+    uint8_t next_head = head;
+    uint8_t i;
+
+    for (i = 0; i < NAVSWITCH_NUM; i++) {
+        if (!(changed & BIT(i))
+            || (uint16_t) (now - last_change[i]) < INPUT_DEBOUNCE_TICKS) {
+            continue;
+        }
+        last_change[i] = now;
+        debounced ^= BIT(i);
+        if ((uint8_t) (next_head - tail) < INPUT_QUEUE_SIZE) {
+            queue[next_head & INPUT_INDEX_MASK].navswitch = i;
+            queue[next_head & INPUT_INDEX_MASK].pressed = (down & BIT(i)) != 0;
+            queue[next_head & INPUT_INDEX_MASK].time = now;
+            next_head++;
+        }
+    }
+    if (next_head != head) {
+        // Publish the events only once they have been stored
+        head = next_head;
+        sched_event_post(SCHED_EVENT_INPUT);
+    }
+}
+
+
+/*
+ * Function: input_poll
+ * --------------------
+ * Reads the navswitch and queues any transition the debouncing hid, for
+ * when it settles in a different state than its last edge. Should be
+ * called periodically.
+ *
+*/
+void input_poll(void)
+{
+    uint8_t state = hal_interrupts_disable();
+
+    input_isr(hal_navswitch_down());
+    hal_interrupts_restore(state);
+}
+
+
+/*
+ * Function: input_event_get
+ * --------------------
+ * Takes the oldest navswitch transition from the queue, logging it for
+ * replay if it is a push
+ *
+ * input_event_t *event: Filled in with the transition
+ *
+ * Returns: 1 if there was a transition, 0 if the queue is empty
+*/
+int input_event_get(input_event_t *event)
+{
+    uint8_t next_tail = tail;
+
+    if (head == next_tail) {
+        return 0;
+    }
+    event->navswitch = queue[next_tail & INPUT_INDEX_MASK].navswitch;
+    event->pressed = queue[next_tail & INPUT_INDEX_MASK].pressed;
+    event->time = queue[next_tail & INPUT_INDEX_MASK].time;
+    // Free the slot only once the event has been read out of it
+    tail = next_tail + 1;
+    if (event->pressed) {
+        record_navswitch(event->navswitch);
+    }
+    return 1;
+}
+
+
+/*
+ * Function: input_event_put
+ * --------------------
+ * Queues a transition as if the interrupt had, without debouncing, for
+ * replaying recorded input. Must not be used while the pin change
+ * interrupts can queue transitions too.
+ *
+ * uint8_t navswitch: Direction, one of the NAVSWITCH_* directions
+ * uint8_t pressed: 1 if pushed, 0 if released
+ *
+ * Returns: 1 if it was queued, 0 if the queue is full
+*/
+int input_event_put(uint8_t navswitch, uint8_t pressed)
+{
+    uint8_t next_head = head;
+
+    if ((uint8_t) (next_head - tail) >= INPUT_QUEUE_SIZE) {
+        return 0;
+    }
+    queue[next_head & INPUT_INDEX_MASK].navswitch = navswitch;
+    queue[next_head & INPUT_INDEX_MASK].pressed = pressed;
+    queue[next_head & INPUT_INDEX_MASK].time = hal_timer_get();
+    head = next_head + 1;
+    sched_event_post(SCHED_EVENT_INPUT);
+    return 1;
+}
+
+
+/*
+ * Function: input_latency_start
+ * --------------------
+ * Starts measuring the latency of a transition that changed a pixel,
+ * unless one is being measured already
+ *
+ * uint16_t time: Timer tick of the transition
+ * uint8_t column: Display column of the changed pixel
+ *
+*/
+void input_latency_start(uint16_t time, uint8_t column)
+{
+    if (latency_stage == LATENCY_IDLE) {
+        // The stage last, as the display's timer interrupt reads it first
+        latency_start = time;
+        latency_column = column;
+        latency_stage = LATENCY_MOVED;
+    }
+}
+
+
+/*
+ * Function: input_latency_display
+ * --------------------
+ * Finishes measuring the latency once the changed pixel is lit. Must be
+ * called after each tinygl_update(), which lights a display column at a
+ * time, and before the frame is redrawn.
+ *
+ * uint8_t column: Display column tinygl_update() just lit
+ *
+*/
+void input_latency_display(uint8_t column)
+{
+    uint16_t time;
+
+    if (latency_stage == LATENCY_DRAWN && column == latency_column) {
+        time = hal_timer_get() - latency_start;
+        if (!latency.count || time < latency.min) {
+            latency.min = time;
+        }
+        if (time > latency.max) {
+            latency.max = time;
+        }
+        latency_samples[latency.count % INPUT_LATENCY_SAMPLES] = time;
+        latency.count++;
+        latency_stage = LATENCY_IDLE;
+    } else if (latency_stage == LATENCY_MOVED) {
+        // The frame is redrawn straight after, so the pixel is lit the
+        // next time its column is
+        latency_stage = LATENCY_DRAWN;
+    }
+}
+
+
+/*
+ * Function: input_latency_get
+ * --------------------
+ * Gets the latencies measured from a transition to its pixel being lit
+ *
+ * input_latency_t *result: Filled in with the latencies
+ *
+*/
+void input_latency_get(input_latency_t *result)
+{
+    uint16_t sorted[INPUT_LATENCY_SAMPLES];
+    uint8_t samples;
+    uint16_t sample;
+    uint8_t state;
+    uint8_t i;
+    uint8_t j;
+
+    // The display refresh interrupt adds samples, so the count and the
+    // samples are copied together before sorting the copy
+    state = hal_interrupts_disable();
+    *result = latency;
+    memcpy(sorted, latency_samples, sizeof(sorted));
+    hal_interrupts_restore(state);
+    samples = result->count < INPUT_LATENCY_SAMPLES
+        ? result->count : INPUT_LATENCY_SAMPLES;
+
+    // Insertion sort, there are only a handful of samples
+    for (i = 1; i < samples; i++) {
+        sample = sorted[i];
+        for (j = i; j > 0 && sorted[j - 1] > sample; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = sample;
+    }
+    result->median = samples ? sorted[samples / 2] : 0;
+}
@@ -0,0 +1,136 @@
+/** @file   input.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for the interrupt driven navswitch
+            input of the pong game. Pin change interrupts timestamp each
+            navswitch transition and queue it, so a push is acted on as
+            soon as the navswitch task wakes rather than at its next
+            poll. It also measures the time from a push to the paddle
+            pixel it moved being lit.
+*/
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "system.h"
+
+#define INPUT_QUEUE_SIZE 8 // Must be a power of two, at most 128
+#define INPUT_LATENCY_SAMPLES 16 // Recent latencies kept for the median
+
+
+typedef struct input_event_struct
+{
+    uint8_t navswitch; // Direction, one of the NAVSWITCH_* directions
+    uint8_t pressed; // 1 if pushed, 0 if released
+    uint16_t time; // Timer tick of the transition
+} input_event_t;
+
+typedef struct input_latency_struct
+{
+    uint16_t min; // Shortest latency, in timer ticks
+    uint16_t median; // Median of the last INPUT_LATENCY_SAMPLES latencies
+    uint16_t max; // Longest latency
+    uint16_t count; // Number of latencies measured
+} input_latency_t;
+
+
+/*
+ * Function: input_init
+ * --------------------
+ * Empties the event queue and enables the navswitch pin change
+ * interrupts. Must be called after navswitch_init().
+ *
+*/
+void input_init(void);
+
+
+/*
+ * Function: input_isr
+ * --------------------
+ * Queues the navswitch transitions, called from the pin change
+ * interrupts, and wakes the tasks waiting on SCHED_EVENT_INPUT. A
+ * direction is debounced by ignoring it for INPUT_DEBOUNCE_TICKS after
+ * each transition, so the first edge is acted on straight away.
+ *
+ * uint8_t down: Bitmask of the directions held down
+ *
+*/
+void input_isr(uint8_t down);
+
+
+/*
+ * Function: input_poll
+ * --------------------
+ * Reads the navswitch and queues any transition the debouncing hid, for
+ * when it settles in a different state than its last edge. Should be
+ * called periodically.
+ *
+*/
+void input_poll(void);
+
+
+/*
+ * Function: input_event_get
+ * --------------------
+ * Takes the oldest navswitch transition from the queue, logging it for
+ * replay if it is a push
+ *
+ * input_event_t *event: Filled in with the transition
+ *
+ * Returns: 1 if there was a transition, 0 if the queue is empty
+*/
+int input_event_get(input_event_t *event);
+
+
+/*
+ * Function: input_event_put
+ * --------------------
+ * Queues a transition as if the interrupt had, without debouncing, for
+ * replaying recorded input. Must not be used while the pin change
+ * interrupts can queue transitions too.
+ *
+ * uint8_t navswitch: Direction, one of the NAVSWITCH_* directions
+ * uint8_t pressed: 1 if pushed, 0 if released
+ *
+ * Returns: 1 if it was queued, 0 if the queue is full
+*/
+int input_event_put(uint8_t navswitch, uint8_t pressed);
+
+
+/*
+ * Function: input_latency_start
+ * --------------------
+ * Starts measuring the latency of a transition that changed a pixel,
+ * unless one is being measured already
+ *
+ * uint16_t time: Timer tick of the transition
+ * uint8_t column: Display column of the changed pixel
+ *
+*/
+void input_latency_start(uint16_t time, uint8_t column);
+
+
+/*
+ * Function: input_latency_display
+ * --------------------
+ * Finishes measuring the latency once the changed pixel is lit. Must be
+ * called after each tinygl_update(), which lights a display column at a
+ * time, and before the frame is redrawn.
+ *
+ * uint8_t column: Display column tinygl_update() just lit
+ *
+*/
+void input_latency_display(uint8_t column);
+
+
+/*
+ * Function: input_latency_get
+ * --------------------
+ * Gets the latencies measured from a transition to its pixel being lit
+ *
+ * input_latency_t *result: Filled in with the latencies
+ *
+*/
+void input_latency_get(input_latency_t *result);
+
+#endif
@@ -0,0 +1,113 @@
+/** @file   ir_rx.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module handles the interrupt fed IR receive buffer in
+            the pong game. It is a single producer (the interrupt),
+            single consumer (the tasks) ring buffer: each side only
+            writes its own index, and the indices are single bytes so
+            reading them is atomic, so no locking is needed.
+*/
+
+
+#include "system.h"
+#include "hal.h"
+#include "sched.h"
+#include "ir_rx.h"
+
+
+#define IR_RX_INDEX_MASK (IR_RX_BUFFER_SIZE - 1)
+
+
+static volatile uint8_t buffer[IR_RX_BUFFER_SIZE]; // Received bytes
+static volatile uint8_t head; // Count of bytes stored, only written by the interrupt
+static volatile uint8_t tail; // Count of bytes taken, only written by the tasks
+static volatile uint16_t overruns; // Bytes dropped, only written by the interrupt
+
+
+/*
+ * Function: ir_rx_init
+ * --------------------
+ * Empties the receive buffer and enables the IR receive interrupt.
+ * Must be called after ir_uart_init().
+ *
+*/
+void ir_rx_init(void)
+{
+    head = 0;
+    tail = 0;
+    overruns = 0;
+    hal_ir_rx_interrupt_enable();
+}
+
+
+/*
+ * Function: ir_rx_isr
+ * --------------------
+ * Stores a received byte, called from the IR receive interrupt, and
+ * wakes the tasks waiting on SCHED_EVENT_IR_RX. If the buffer is full
+ * the byte is dropped and counted as an overrun.
+ *
+ * uint8_t byte: Byte received
+ *
+*/
+void ir_rx_isr(uint8_t byte)
+{
+    uint8_t next_head = head;
+
+    if ((uint8_t) (next_head - tail) >= IR_RX_BUFFER_SIZE) {
+        overruns++;
+    } else {
+        buffer[next_head & IR_RX_INDEX_MASK] = byte;
+        // Publish the byte only once it has been stored
+        head = next_head + 1;
+    }
+    sched_event_post(SCHED_EVENT_IR_RX);
+}
+
+
+/*
+ * Function: ir_rx_ready_p
+ * --------------------
+ * Returns: 1 if a received byte is waiting, 0 otherwise
+*/
+int ir_rx_ready_p(void)
+{
+    return head != tail;
+}
+
+
+/*
+ * Function: ir_rx_getc
+ * --------------------
+ * Takes the oldest byte from the receive buffer, without blocking
+ *
+ * Returns: the byte, or -1 if nothing has been received
+*/
+int ir_rx_getc(void)
+{
+    uint8_t next_tail = tail;
+    uint8_t byte;
+
+    if (head == next_tail) {
+        return -1;
+    }
+    byte = buffer[next_tail & IR_RX_INDEX_MASK];
+    // Free the slot only once the byte has been read out of it
+    tail = next_tail + 1;
+    return byte;
+}
+
+
+/*
+ * Function: ir_rx_overruns
+ * --------------------
+ * Returns: the number of bytes dropped because the buffer was full
+*/
+uint16_t ir_rx_overruns(void)
+{
+    uint8_t state = hal_interrupts_disable();
+    uint16_t count = overruns;
+
+    hal_interrupts_restore(state);
+    return count;
+}
@@ -0,0 +1,66 @@
+/** @file   ir_rx.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for the interrupt fed IR receive
+            buffer in the pong game. Bytes are stored by the receive
+            interrupt the moment they arrive and read back by the tasks
+            whenever they run, without either side ever waiting.
+*/
+
+#ifndef IR_RX_H
+#define IR_RX_H
+
+#include "system.h"
+
+#define IR_RX_BUFFER_SIZE 32 // Must be a power of two, at most 128
+
+
+/*
+ * Function: ir_rx_init
+ * --------------------
+ * Empties the receive buffer and enables the IR receive interrupt.
+ * Must be called after ir_uart_init().
+ *
+*/
+void ir_rx_init(void);
+
+
+/*
+ * Function: ir_rx_isr
+ * --------------------
+ * Stores a received byte, called from the IR receive interrupt, and
+ * wakes the tasks waiting on SCHED_EVENT_IR_RX. If the buffer is full
+ * the byte is dropped and counted as an overrun.
+ *
+ * uint8_t byte: Byte received
+ *
+*/
+void ir_rx_isr(uint8_t byte);
+
+
+/*
+ * Function: ir_rx_ready_p
+ * --------------------
+ * Returns: 1 if a received byte is waiting, 0 otherwise
+*/
+int ir_rx_ready_p(void);
+
+
+/*
+ * Function: ir_rx_getc
+ * --------------------
+ * Takes the oldest byte from the receive buffer, without blocking
+ *
+ * Returns: the byte, or -1 if nothing has been received
+*/
+int ir_rx_getc(void);
+
+
+/*
+ * Function: ir_rx_overruns
+ * --------------------
+ * Returns: the number of bytes dropped because the buffer was full
+*/
+uint16_t ir_rx_overruns(void);
+
+#endif
@@ -0,0 +1,479 @@
+/** @file   link.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module acknowledges and sends again the IR packets that
+            can't be lost, and measures how well the link is doing.
+*/
+
+
+#include <string.h>
+#include "system.h"
+#include "fixed.h"
+#include "packet.h"
+#include "link.h"
+
+
+typedef struct link_slot_struct
+{
+    packet_t packet; // Packet waiting for an ACK
+    uint8_t sent_at; // Game update it was first sent at
+    uint8_t timer; // Game updates left until it's sent again
+    uint8_t tries; // Times it has been sent again
+    uint8_t used; // True while the slot holds a packet
+} link_slot_t;
+
+
+// What has been received from one neighbour, which numbers the frames it
+// sends this board on its own
+typedef struct link_peer_struct
+{
+    uint8_t address; // Address its ACKs and NACKs are sent with
+    uint8_t seen_seq[LINK_SEEN]; // Sequence numbers of packets received lately
+    uint8_t seen_age[LINK_SEEN]; // Game updates each is remembered for yet, 0 if free
+    uint8_t last_seq; // Sequence number of the last packet received
+    uint8_t receiving; // True once a packet has been received
+    uint8_t acks[LINK_ACKS]; // Sequence numbers to acknowledge next update
+    uint8_t acks_num; // Number of acks
+    uint8_t nack_first; // First sequence number to NACK next update
+    uint8_t nack_count; // Number to NACK, 0 for none
+} link_peer_t;
+
+
+static int reliable; // True to acknowledge and send again, see link_init()
+static uint8_t now; // Game updates since link_init(), wrapping
+static link_slot_t slots[LINK_SLOTS]; // Packets waiting for an ACK
+static link_peer_t peers[PACKET_SIDES]; // Each neighbour, by PACKET_SIDE_FROM()
+static uint8_t led_phase; // Game update within LINK_LED_PERIOD
+static uint8_t timed; // True once a round trip has been measured
+static link_stats_t measured; // Statistics, see link_stats_get()
+
+
+/*
+ * Function: needs_ack
+ * --------------------
+ * Returns: 1 if packets of a type are acknowledged, 0 otherwise
+*/
+static int needs_ack(uint8_t type)
+{
+    return type == PACKET_BALL || type == PACKET_START;
+}
+
+
+/*
+ * Function: is_waiting
+ * --------------------
+ * Returns: 1 if a slot holds a packet sent to a side, see
+ * PACKET_SIDE_TO(), that is waiting for an ACK, 0 otherwise
+*/
+static int is_waiting(const link_slot_t *slot, uint8_t side)
+{
+    return slot->used && PACKET_SIDE_TO(slot->packet.address) == side;
+}
+
+
+/*
+ * Function: count_send
+ * --------------------
+ * Adds whether a send was lost to the rolling loss rate
+ *
+ * int lost: True if the send was lost
+ *
+*/
+static void count_send(int lost)
+{
+    measured.loss += ((lost ? FIXED_ONE : 0) - measured.loss) >> LINK_LOSS_SHIFT;
+}
+
+
+/*
+ * Function: measure_rtt
+ * --------------------
+ * Folds a round trip time into the smoothed time and its deviation,
+ * and works out the timeout from them, as TCP does
+ *
+ * uint8_t rtt: Round trip time measured, in game updates
+ *
+*/
+static void measure_rtt(uint8_t rtt)
+{
+    int16_t delta;
+    uint16_t rto;
+
+    if (!timed) {
+        measured.srtt = rtt << 3;
+        measured.rttvar = rtt << 1;
+        timed = 1;
+    } else {
+        delta = rtt - (measured.srtt >> 3);
+        measured.srtt += delta;
+        if (delta < 0) {
+            delta = -delta;
+        }
+        measured.rttvar += delta - (measured.rttvar >> 2);
+    }
+    rto = (measured.srtt >> 3) + measured.rttvar;
+    measured.rto = rto < LINK_RTO_MIN ? LINK_RTO_MIN : rto > LINK_RTO_MAX ? LINK_RTO_MAX : rto;
+}
+
+
+/*
+ * Function: retransmit
+ * --------------------
+ * Sends a waiting packet again, or gives up on it after LINK_RETRIES
+ * repeats. The timeout doubles each time.
+ *
+ * link_slot_t *slot: Slot of the packet
+ *
+*/
+static void retransmit(link_slot_t *slot)
+{
+    uint16_t timeout;
+
+    count_send(1);
+    if (slot->tries >= LINK_RETRIES) {
+        measured.failed++;
+        slot->used = 0;
+        return;
+    }
+    slot->tries++;
+    timeout = (uint16_t) measured.rto << slot->tries;
+    slot->timer = timeout > LINK_RTO_MAX ? LINK_RTO_MAX : timeout;
+    measured.retransmits++;
+    packet_resend(&slot->packet);
+}
+
+
+/*
+ * Function: send_stats
+ * --------------------
+ * Replies to a PACKET_LINK_QUERY with a PACKET_LINK_STATS packet: the
+ * packets sent, sent again and given up on as 16 bit words, most
+ * significant byte first, then the timeout in game updates and the loss
+ * rate out of 255
+ *
+*/
+static void send_stats(void)
+{
+    uint8_t payload[LINK_STATS_SIZE];
+
+    payload[0] = measured.sent >> 8;
+    payload[1] = measured.sent;
+    payload[2] = measured.retransmits >> 8;
+    payload[3] = measured.retransmits;
+    payload[4] = measured.failed >> 8;
+    payload[5] = measured.failed;
+    payload[6] = measured.rto;
+    payload[7] = measured.loss >= FIXED_ONE ? FIXED_ONE - 1 : measured.loss;
+    packet_send(PACKET_LINK_STATS, payload, LINK_STATS_SIZE);
+}
+
+
+/*
+ * Function: link_init
+ * --------------------
+ * Clears the link, for a new game
+ *
+ * int enable: True to acknowledge and send again, false to pass
+ * packets straight through, for a peer that can't lose them
+ *
+*/
+void link_init(int enable)
+{
+    uint8_t i;
+
+    reliable = enable;
+    now = 0;
+    for (i = 0; i < LINK_SLOTS; i++) {
+        slots[i].used = 0;
+    }
+    memset(peers, 0, sizeof(peers));
+    led_phase = 0;
+    timed = 0;
+    measured = (link_stats_t) {.rto = LINK_RTO_INIT};
+}
+
+
+/*
+ * Function: link_send
+ * --------------------
+ * Sends a packet to the board across the border, keeping it to send
+ * again until it's acknowledged if its type is one that needs to be
+ *
+ * uint8_t type: One of the PACKET_* types
+ * const uint8_t *payload: Message data, may be 0 if length is 0
+ * uint8_t length: Number of payload bytes, at most PACKET_PAYLOAD_MAX
+ *
+*/
+void link_send(uint8_t type, const uint8_t *payload, uint8_t length)
+{
+    link_send_to(packet_address_get(), type, payload, length);
+}
+
+
+/*
+ * Function: link_send_to
+ * --------------------
+ * Sends a packet as link_send() does, to a given board in a ring
+ *
+ * uint8_t address: PACKET_ADDRESS() of this board and the board to
+ * send to, 0 between two boards
+ * uint8_t type: One of the PACKET_* types
+ * const uint8_t *payload: Message data, may be 0 if length is 0
+ * uint8_t length: Number of payload bytes, at most PACKET_PAYLOAD_MAX
+ *
+*/
+void link_send_to(uint8_t address, uint8_t type, const uint8_t *payload, uint8_t length)
+{
+    link_slot_t *slot = &slots[0];
+    uint8_t seq;
+    uint8_t i;
+
+    seq = packet_send_to(address, type, payload, length);
+    if (!reliable || !needs_ack(type)) {
+        return;
+    }
+    // A free slot, or else the one sent longest ago is given up on
+    for (i = 0; i < LINK_SLOTS && slot->used; i++) {
+        if (!slots[i].used || (uint8_t) (now - slots[i].sent_at) > (uint8_t) (now - slot->sent_at)) {
+            slot = &slots[i];
+        }
+    }
+    if (slot->used) {
+        measured.failed++;
+        count_send(1);
+    }
+    slot->packet.type = type;
+    slot->packet.seq = seq;
+    slot->packet.length = length;
+    slot->packet.address = address;
+    for (i = 0; i < length; i++) {
+        slot->packet.payload[i] = payload[i];
+    }
+    slot->sent_at = now;
+    slot->timer = measured.rto;
+    slot->tries = 0;
+    slot->used = 1;
+    measured.sent++;
+}
+
+
+/*
+ * Function: link_send_again
+ * --------------------
+ * Sends a packet that was sent before and may have been lost, as
+ * link_send() does. If the link is still sending the first copy again it
+ * is given fresh retries instead, keeping its sequence number, so the
+ * receiver drops whichever copy arrives second rather than taking it
+ * twice.
+ *
+ * uint8_t type: One of the PACKET_* types
+ * const uint8_t *payload: Message data, as first sent
+ * uint8_t length: Number of payload bytes, as first sent
+ *
+*/
+void link_send_again(uint8_t type, const uint8_t *payload, uint8_t length)
+{
+    link_slot_t *slot;
+
+    for (slot = slots; slot < slots + LINK_SLOTS; slot++) {
+        if (slot->used && slot->packet.type == type && slot->packet.length == length
+            && !memcmp(slot->packet.payload, payload, length)) {
+            // Sent again next update, like a NACKed packet
+            slot->tries = 0;
+            slot->timer = 1;
+            return;
+        }
+    }
+    link_send(type, payload, length);
+}
+
+
+/*
+ * Function: link_receive
+ * --------------------
+ * Handles a packet received: takes ACKs, NACKs and queries for the link
+ * statistics, and drops repeats. A packet that needs it is acknowledged,
+ * and any gap before it NACKed, by the next link_update().
+ *
+ * const packet_t *packet: Packet from packet_receive()
+ *
+ * Returns: 1 if the packet is for the game, 0 if the link has dealt
+ * with it
+*/
+int link_receive(const packet_t *packet)
+{
+    uint8_t side = PACKET_SIDE_FROM(packet->address); // Neighbour the packet is from
+    link_peer_t *peer = &peers[side];
+    uint8_t missed; // Frames missing before this one
+    uint8_t oldest; // Packet received that has the least time left to be remembered
+    uint8_t i;
+
+    if (packet->type == PACKET_LINK_QUERY) {
+        send_stats();
+        return 0;
+    }
+    if (!reliable) {
+        return 1;
+    }
+    peer->address = PACKET_ADDRESS(PACKET_TO(packet->address), PACKET_FROM(packet->address));
+
+    // Frames missing between this one and the last are asked for again,
+    // those that weren't waiting for an ACK are ignored by the sender
+    missed = packet->seq - peer->last_seq - 1;
+    if (peer->receiving && packet->seq != peer->last_seq && missed && missed < LINK_GAP_MAX) {
+        if (!peer->nack_count) {
+            peer->nack_first = peer->last_seq + 1;
+        }
+        peer->nack_count = packet->seq - peer->nack_first;
+    }
+    if (!peer->receiving || missed < LINK_GAP_MAX) {
+        peer->last_seq = packet->seq;
+        peer->receiving = 1;
+    }
+
+    switch (packet->type) {
+    case PACKET_ACK:
+        for (i = 0; i < LINK_SLOTS; i++) {
+            if (is_waiting(&slots[i], side) && memchr(packet->payload, slots[i].packet.seq, packet->length)) {
+                // Only a packet sent once times the round trip
+                if (!slots[i].tries) {
+                    measure_rtt(now - slots[i].sent_at);
+                }
+                count_send(0);
+                measured.acked++;
+                slots[i].used = 0;
+            }
+        }
+        return 0;
+    case PACKET_NACK:
+        // Sent again next update, like every other packet from the link
+        for (i = 0; i < LINK_SLOTS; i++) {
+            if (is_waiting(&slots[i], side)
+                && (uint8_t) (slots[i].packet.seq - packet->payload[0]) < packet->payload[1]) {
+                slots[i].timer = 1;
+            }
+        }
+        return 0;
+    }
+
+    if (!needs_ack(packet->type)) {
+        return 1;
+    }
+    if (peer->acks_num < LINK_ACKS) {
+        peer->acks[peer->acks_num++] = packet->seq;
+    }
+    for (i = 0; i < LINK_SEEN; i++) {
+        if (peer->seen_age[i] && peer->seen_seq[i] == packet->seq) {
+            measured.repeats++;
+            return 0;
+        }
+    }
+    // Remembered in place of the one that has the least time left
+    oldest = 0;
+    for (i = 1; i < LINK_SEEN; i++) {
+        if (peer->seen_age[i] < peer->seen_age[oldest]) {
+            oldest = i;
+        }
+    }
+    peer->seen_seq[oldest] = packet->seq;
+    peer->seen_age[oldest] = LINK_SEEN_UPDATES;
+    return 1;
+}
+
+
+/*
+ * Function: link_update
+ * --------------------
+ * Called every game update, sends the ACKs and NACK for the packets
+ * received since the last update, and again any packet whose ACK is
+ * late. Sending from here rather than as packets arrive keeps the
+ * packets sent in the same order when a match is replayed.
+ *
+*/
+void link_update(void)
+{
+    link_peer_t *peer;
+    uint8_t payload[2];
+    uint8_t i;
+
+    for (peer = peers; peer < peers + PACKET_SIDES; peer++) {
+        if (peer->acks_num) {
+            packet_send_to(peer->address, PACKET_ACK, peer->acks, peer->acks_num);
+            peer->acks_num = 0;
+        }
+        if (peer->nack_count) {
+            payload[0] = peer->nack_first;
+            payload[1] = peer->nack_count;
+            packet_send_to(peer->address, PACKET_NACK, payload, sizeof(payload));
+            measured.nacks++;
+            peer->nack_count = 0;
+        }
+        for (i = 0; i < LINK_SEEN; i++) {
+            if (peer->seen_age[i]) {
+                peer->seen_age[i]--;
+            }
+        }
+    }
+    now++;
+    led_phase = (led_phase + 1) % LINK_LED_PERIOD;
+    for (i = 0; i < LINK_SLOTS; i++) {
+        if (slots[i].used && !--slots[i].timer) {
+            retransmit(&slots[i]);
+        }
+    }
+}
+
+
+/*
+ * Function: link_idle
+ * --------------------
+ * Returns: 1 if no packet is waiting for an ACK and no ACK or NACK is
+ * waiting to be sent, so link_update() has nothing left to do, 0
+ * otherwise
+*/
+int link_idle(void)
+{
+    const link_peer_t *peer;
+    uint8_t i;
+
+    for (i = 0; i < LINK_SLOTS; i++) {
+        if (slots[i].used) {
+            return 0;
+        }
+    }
+    for (peer = peers; peer < peers + PACKET_SIDES; peer++) {
+        if (peer->acks_num || peer->nack_count) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*
+ * Function: link_led
+ * --------------------
+ * Shows the quality of the link on LED1: it's lit for the share of the
+ * sends lost, out of every LINK_LED_PERIOD game updates, and never on a
+ * clean link
+ *
+ * Returns: 1 if LED1 should be lit this game update, 0 otherwise
+*/
+int link_led(void)
+{
+    return (int32_t) led_phase * FIXED_ONE < (int32_t) measured.loss * LINK_LED_PERIOD;
+}
+
+
+/*
+ * Function: link_stats_get
+ * --------------------
+ * Gets the statistics of the link
+ *
+ * link_stats_t *stats: Filled in with the statistics
+ *
+*/
+void link_stats_get(link_stats_t *stats)
+{
+    *stats = measured;
+}
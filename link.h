@@ -0,0 +1,177 @@
+/** @file   link.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for the reliable part of the IR link.
+            Ball hand-offs, the start of the game and state snapshots are
+            acknowledged with a PACKET_ACK, which can carry the sequence
+            numbers of several packets, and sent again with the same
+            sequence number if the ACK doesn't come back within a timeout
+            worked out from the measured round trip time, or straight
+            away if the receiver sends a PACKET_NACK for a gap in the
+            sequence numbers it has received. Repeats that arrive are
+            acknowledged again but not passed on.
+
+            In a ring each neighbour numbers the frames it sends this
+            board on its own, so what has been received is kept for
+            each side.
+
+            Time is counted in game updates, so a replayed match sends
+            the same packets. The round trip time, loss rate and counts
+            of the packets sent again are kept for diagnostics, and sent
+            in reply to a PACKET_LINK_QUERY.
+*/
+
+#ifndef LINK_H
+#define LINK_H
+
+#include "system.h"
+#include "fixed.h"
+#include "packet.h"
+
+#define LINK_SLOTS 4 // Packets that can be waiting for an ACK at once
+#define LINK_RETRIES 3 // Times a packet is sent again before giving up on it
+#define LINK_RTO_INIT 10 // Timeout before a round trip has been measured, in game updates
+#define LINK_RTO_MIN 2 // Shortest timeout, in game updates
+#define LINK_RTO_MAX 25 // Longest timeout, in game updates, after backing off
+#define LINK_GAP_MAX 16 // Most frames missing before one received that are NACKed
+#define LINK_ACKS PACKET_PAYLOAD_MAX // Packets acknowledged by one PACKET_ACK
+#define LINK_SEEN 4 // Packets received that repeats are dropped of
+#define LINK_SEEN_UPDATES 150 // Game updates a packet received is remembered for
+#define LINK_LOSS_SHIFT 3 // The loss rate is averaged over about 2^3 sends
+#define LINK_LED_PERIOD 50 // Game updates LED1 shows the loss rate over, lit for the share lost
+#define LINK_STATS_SIZE 8 // Bytes in a PACKET_LINK_STATS payload
+
+
+typedef struct link_stats_struct
+{
+    uint16_t sent; // Packets sent that need an ACK, not counting repeats
+    uint16_t acked; // Packets acknowledged
+    uint16_t retransmits; // Packets sent again, after a timeout or a NACK
+    uint16_t failed; // Packets given up on after LINK_RETRIES repeats
+    uint16_t repeats; // Repeats received and dropped
+    uint16_t nacks; // NACKs sent for gaps in the sequence numbers received
+    uint16_t srtt; // Smoothed round trip time, in eighths of a game update
+    uint16_t rttvar; // Its mean deviation, in quarters of a game update
+    uint8_t rto; // Retransmit timeout, in game updates
+    fixed_t loss; // Rolling share of sends lost, FIXED_ONE if all of them are
+} link_stats_t;
+
+
+/*
+ * Function: link_init
+ * --------------------
+ * Clears the link, for a new game
+ *
+ * int enable: True to acknowledge and send again, false to pass
+ * packets straight through, for a peer that can't lose them
+ *
+*/
+void link_init(int enable);
+
+
+/*
+ * Function: link_send
+ * --------------------
+ * Sends a packet to the board across the border, keeping it to send
+ * again until it's acknowledged if its type is one that needs to be
+ *
+ * uint8_t type: One of the PACKET_* types
+ * const uint8_t *payload: Message data, may be 0 if length is 0
+ * uint8_t length: Number of payload bytes, at most PACKET_PAYLOAD_MAX
+ *
+*/
+void link_send(uint8_t type, const uint8_t *payload, uint8_t length);
+
+
+/*
+ * Function: link_send_to
+ * --------------------
+ * Sends a packet as link_send() does, to a given board in a ring
+ *
+ * uint8_t address: PACKET_ADDRESS() of this board and the board to
+ * send to, 0 between two boards
+ * uint8_t type: One of the PACKET_* types
+ * const uint8_t *payload: Message data, may be 0 if length is 0
+ * uint8_t length: Number of payload bytes, at most PACKET_PAYLOAD_MAX
+ *
+*/
+void link_send_to(uint8_t address, uint8_t type, const uint8_t *payload, uint8_t length);
+
+
+/*
+ * Function: link_send_again
+ * --------------------
+ * Sends a packet that was sent before and may have been lost, as
+ * link_send() does. If the link is still sending the first copy again it
+ * is given fresh retries instead, keeping its sequence number, so the
+ * receiver drops whichever copy arrives second rather than taking it
+ * twice.
+ *
+ * uint8_t type: One of the PACKET_* types
+ * const uint8_t *payload: Message data, as first sent
+ * uint8_t length: Number of payload bytes, as first sent
+ *
+*/
+void link_send_again(uint8_t type, const uint8_t *payload, uint8_t length);
+
+
+/*
+ * Function: link_receive
+ * --------------------
+ * Handles a packet received: takes ACKs, NACKs and queries for the link
+ * statistics, and drops repeats. A packet that needs it is acknowledged,
+ * and any gap before it NACKed, by the next link_update().
+ *
+ * const packet_t *packet: Packet from packet_receive()
+ *
+ * Returns: 1 if the packet is for the game, 0 if the link has dealt
+ * with it
+*/
+int link_receive(const packet_t *packet);
+
+
+/*
+ * Function: link_update
+ * --------------------
+ * Called every game update, sends the ACKs and NACK for the packets
+ * received since the last update, and again any packet whose ACK is
+ * late. Sending from here rather than as packets arrive keeps the
+ * packets sent in the same order when a match is replayed.
+ *
+*/
+void link_update(void);
+
+
+/*
+ * Function: link_idle
+ * --------------------
+ * Returns: 1 if no packet is waiting for an ACK and no ACK or NACK is
+ * waiting to be sent, so link_update() has nothing left to do, 0
+ * otherwise
+*/
+int link_idle(void);
+
+
+/*
+ * Function: link_led
+ * --------------------
+ * Shows the quality of the link on LED1: it's lit for the share of the
+ * sends lost, out of every LINK_LED_PERIOD game updates, and never on a
+ * clean link
+ *
+ * Returns: 1 if LED1 should be lit this game update, 0 otherwise
+*/
+int link_led(void);
+
+
+/*
+ * Function: link_stats_get
+ * --------------------
+ * Gets the statistics of the link
+ *
+ * link_stats_t *stats: Filled in with the statistics
+ *
+*/
+void link_stats_get(link_stats_t *stats);
+
+#endif
@@ -0,0 +1,370 @@
+/** @file   packet.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module handles framing, checking and sequencing of all
+            the messages sent between the two boards in the pong game.
+*/
+
+
+#include <string.h>
+#include "system.h"
+#include "ir_uart.h"
+#include "ir_rx.h"
+#include "packet.h"
+#include "record.h"
+
+
+#define PACKET_TYPE_INDEX 1
+#define PACKET_SEQ_INDEX 2
+#define PACKET_LENGTH_INDEX 3
+#define PACKET_ADDRESS_INDEX 4 // In a frame starting PACKET_SYNC_ADDRESSED
+
+
+// CRC-8 (polynomial 0x07) of each nibble, so a byte takes two lookups
+// without spending 256 bytes on a full table
+static const uint8_t crc8_nibble_table[16] = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+    0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+};
+
+static uint8_t tx_seq[PACKET_SIDES]; // Sequence number of the next frame sent to each side
+static uint8_t address; // Address packet_send() sends with, see packet_address_set()
+static packet_decoder_t ir_decoder; // Decoder for bytes arriving via ir_rx
+static const packet_peer_t *peer; // Stands in for IR when set, see packet_peer_set()
+
+
+/*
+ * Function: packet_crc8
+ * --------------------
+ * Updates a CRC-8 (polynomial 0x07) with a block of bytes
+ *
+ * uint8_t crc: CRC so far, 0 to start
+ * const uint8_t *data: Bytes to add
+ * uint8_t length: Number of bytes
+ *
+ * Returns: the updated CRC
+*/
+uint8_t packet_crc8(uint8_t crc, const uint8_t *data, uint8_t length)
+{
+    while (length--) {
+        crc ^= *data++;
+        crc = (crc << 4) ^ crc8_nibble_table[crc >> 4];
+        crc = (crc << 4) ^ crc8_nibble_table[crc >> 4];
+    }
+    return crc;
+}
+
+
+/*
+ * Function: packet_encode
+ * --------------------
+ * Builds a frame for a packet
+ *
+ * uint8_t *frame: Buffer of at least PACKET_FRAME_MAX bytes
+ * const packet_t *packet: Packet to encode, length at most
+ * PACKET_PAYLOAD_MAX
+ *
+ * Returns: the number of bytes in the frame
+*/
+uint8_t packet_encode(uint8_t *frame, const packet_t *packet)
+{
+    uint8_t length = packet->length;
+    uint8_t header = PACKET_HEADER_SIZE;
+
+    frame[0] = PACKET_SYNC;
+    frame[PACKET_TYPE_INDEX] = packet->type;
+    frame[PACKET_SEQ_INDEX] = packet->seq;
+    frame[PACKET_LENGTH_INDEX] = length;
+    if (packet->address) {
+        frame[0] = PACKET_SYNC_ADDRESSED;
+        frame[PACKET_ADDRESS_INDEX] = packet->address;
+        header = PACKET_ADDRESSED_HEADER_SIZE;
+    }
+    memcpy(frame + header, packet->payload, length);
+    // The CRC covers everything after SYNC
+    frame[header + length] = packet_crc8(0, frame + 1, header - 1 + length);
+    return header + length + 1;
+}
+
+
+/*
+ * Function: packet_decoder_init
+ * --------------------
+ * Resets a decoder, discarding any partial frame and its counters
+ *
+*/
+void packet_decoder_init(packet_decoder_t *decoder)
+{
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+
+/*
+ * Function: decoder_discard
+ * --------------------
+ * Drops bytes from the front of a decoder's frame buffer
+ *
+ * uint8_t count: Number of bytes to drop
+ *
+*/
+static void decoder_discard(packet_decoder_t *decoder, uint8_t count)
+{
+    decoder->count -= count;
+    memmove(decoder->frame, decoder->frame + count, decoder->count);
+}
+
+
+/*
+ * Function: decoder_resync
+ * --------------------
+ * Drops the frame being decoded up to the next SYNC after its start,
+ * which may be the start of a real frame hidden inside a corrupt one
+ *
+*/
+static void decoder_resync(packet_decoder_t *decoder)
+{
+    uint8_t i = 1;
+
+    while (i < decoder->count && !PACKET_IS_SYNC(decoder->frame[i])) {
+        i++;
+    }
+    decoder_discard(decoder, i);
+}
+
+
+/*
+ * Function: packet_decode
+ * --------------------
+ * Feeds one received byte to a decoder. Never blocks and does a bounded
+ * amount of work per byte; after a corrupt frame the bytes following its
+ * SYNC are rescanned so the next good frame is never lost.
+ *
+ * packet_decoder_t *decoder: Decoder to feed
+ * uint8_t byte: Byte received
+ * packet_t *packet: Filled in when a frame completes
+ *
+ * Returns: 1 if a valid packet was decoded, 0 otherwise. A frame sent
+ * twice is decoded both times, as only link.c knows which frames are
+ * sent again on purpose.
+*/
+int packet_decode(packet_decoder_t *decoder, uint8_t byte, packet_t *packet)
+{
+    uint8_t *frame = decoder->frame;
+    uint8_t header;
+    uint8_t length;
+    uint8_t size;
+    uint8_t seq;
+
+    frame[decoder->count++] = byte;
+    while (decoder->count) {
+        if (!PACKET_IS_SYNC(frame[0])) {
+            // Hunting for the start of a frame
+            decoder_resync(decoder);
+            continue;
+        }
+        header = frame[0] == PACKET_SYNC ? PACKET_HEADER_SIZE : PACKET_ADDRESSED_HEADER_SIZE;
+        if (decoder->count < header) {
+            return 0;
+        }
+        length = frame[PACKET_LENGTH_INDEX];
+        if (length > PACKET_PAYLOAD_MAX) {
+            // Can't be a real frame, no need to wait for the rest of it
+            decoder->rejected++;
+            decoder_resync(decoder);
+            continue;
+        }
+        size = header + length + 1;
+        if (decoder->count < size) {
+            return 0;
+        }
+        if (packet_crc8(0, frame + 1, size - 2) != frame[size - 1]) {
+            decoder->rejected++;
+            decoder_resync(decoder);
+            continue;
+        }
+
+        seq = frame[PACKET_SEQ_INDEX];
+        if (decoder->synced && seq == decoder->last_seq) {
+            // The same frame received twice
+            decoder->duplicates++;
+        } else if (decoder->synced) {
+            decoder->missed += (uint8_t) (seq - decoder->last_seq - 1);
+        }
+        decoder->last_seq = seq;
+        decoder->synced = 1;
+        decoder->accepted++;
+
+        packet->type = frame[PACKET_TYPE_INDEX];
+        packet->seq = seq;
+        packet->length = length;
+        packet->address = header == PACKET_HEADER_SIZE ? 0 : frame[PACKET_ADDRESS_INDEX];
+        memcpy(packet->payload, frame + header, length);
+        decoder_discard(decoder, size);
+        return 1;
+    }
+    return 0;
+}
+
+
+/*
+ * Function: is_for_this_board
+ * --------------------
+ * Returns: 1 if a packet received is addressed to this board, or has no
+ * address, 0 if it is between other boards in the ring
+*/
+static int is_for_this_board(const packet_t *packet)
+{
+    return !address || !packet->address || PACKET_TO(packet->address) == PACKET_FROM(address);
+}
+
+
+/*
+ * Function: packet_send
+ * --------------------
+ * Frames a message with the next sequence number and sends it via
+ * ir_uart serial communications, logging it for replay (see record.h)
+ *
+ * uint8_t type: One of the PACKET_* types
+ * const uint8_t *payload: Message data, may be 0 if length is 0
+ * uint8_t length: Number of payload bytes, at most PACKET_PAYLOAD_MAX
+ *
+ * Returns: the sequence number the message was sent with
+*/
+uint8_t packet_send(uint8_t type, const uint8_t *payload, uint8_t length)
+{
+    return packet_send_to(address, type, payload, length);
+}
+
+
+/*
+ * Function: packet_send_to
+ * --------------------
+ * Sends a message as packet_send() does, to a given board. Sequence
+ * numbers are counted separately for each side, so each neighbour sees
+ * the frames sent to it numbered without gaps.
+ *
+ * uint8_t to_address: PACKET_ADDRESS() of this board and the board to
+ * send to, 0 between two boards
+ * uint8_t type: One of the PACKET_* types
+ * const uint8_t *payload: Message data, may be 0 if length is 0
+ * uint8_t length: Number of payload bytes, at most PACKET_PAYLOAD_MAX
+ *
+ * Returns: the sequence number the message was sent with
+*/
+uint8_t packet_send_to(uint8_t to_address, uint8_t type, const uint8_t *payload, uint8_t length)
+{
+    packet_t packet;
+
+    packet.type = type;
+    packet.seq = tx_seq[PACKET_SIDE_TO(to_address)]++;
+    packet.length = length;
+    packet.address = to_address;
+    if (length) {
+        memcpy(packet.payload, payload, length);
+    }
+    packet_resend(&packet);
+    return packet.seq;
+}
+
+
+/*
+ * Function: packet_resend
+ * --------------------
+ * Sends a packet again with the sequence number it was first sent with,
+ * so the receiver can tell it's a repeat, see link.h
+ *
+ * const packet_t *packet: Packet to send again
+ *
+*/
+void packet_resend(const packet_t *packet)
+{
+    uint8_t frame[PACKET_FRAME_MAX];
+    uint8_t size;
+    uint8_t i;
+
+    if (peer) {
+        peer->send(packet);
+    } else {
+        size = packet_encode(frame, packet);
+        for (i = 0; i < size; i++) {
+            ir_uart_putc(frame[i]);
+        }
+    }
+    record_ir_out(packet);
+}
+
+
+/*
+ * Function: packet_receive
+ * --------------------
+ * Decodes whatever bytes the IR receive buffer holds so far, without
+ * waiting for the rest of a frame. A packet received is logged for
+ * replay (see record.h).
+ *
+ * packet_t *packet: Filled in when a packet is received
+ *
+ * Returns: 1 if a packet was received, 0 otherwise
+*/
+int packet_receive(packet_t *packet)
+{
+    int byte;
+
+    if (peer) {
+        if (peer->receive(packet)) {
+            record_ir_in(packet);
+            return 1;
+        }
+        return 0;
+    }
+    while ((byte = ir_rx_getc()) >= 0) {
+        if (packet_decode(&ir_decoder, byte, packet) && is_for_this_board(packet)) {
+            record_ir_in(packet);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * Function: packet_peer_set
+ * --------------------
+ * Sends and receives packets through a peer in software instead of IR,
+ * for playing without a second board. Packets are still logged for
+ * replay.
+ *
+ * const packet_peer_t *new_peer: Peer to use, 0 to go back to IR
+ *
+*/
+void packet_peer_set(const packet_peer_t *new_peer)
+{
+    peer = new_peer;
+}
+
+
+/*
+ * Function: packet_address_set
+ * --------------------
+ * Sets the address packet_send() sends with. Once it isn't 0, frames
+ * addressed to other boards are dropped by packet_receive(); frames with
+ * no address, from host tools, are still taken.
+ *
+ * uint8_t new_address: PACKET_ADDRESS() of this board and the board
+ * across its border, 0 between two boards
+ *
+*/
+void packet_address_set(uint8_t new_address)
+{
+    address = new_address;
+}
+
+
+/*
+ * Function: packet_address_get
+ * --------------------
+ * Returns: the address packet_send() sends with
+*/
+uint8_t packet_address_get(void)
+{
+    return address;
+}
@@ -0,0 +1,240 @@
+/** @file   packet.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for the framed IR packet protocol used
+            for every message between the two boards in the pong game.
+
+            A frame is: SYNC, type, sequence number, payload length,
+            payload, then a CRC-8 of everything after SYNC. Frames are
+            decoded a byte at a time, so a corrupt or partial frame is
+            simply dropped and the decoder picks up at the next SYNC.
+
+            In a ring of more than two boards (see ring.h) a board
+            hears both its neighbours, so frames start with
+            PACKET_SYNC_ADDRESSED instead and carry the boards they are
+            from and to after the payload length.
+*/
+
+#ifndef PACKET_H
+#define PACKET_H
+
+#include "system.h"
+
+#define PACKET_SYNC 0xA5
+#define PACKET_SYNC_ADDRESSED 0xA4 // Starts a frame with an address, see packet_t
+#define PACKET_IS_SYNC(BYTE) (((BYTE) | 1) == PACKET_SYNC) // Either SYNC, one test
+#define PACKET_PAYLOAD_MAX 8
+#define PACKET_HEADER_SIZE 4 // SYNC, type, sequence number, length
+#define PACKET_ADDRESSED_HEADER_SIZE (PACKET_HEADER_SIZE + 1) // And the address
+#define PACKET_FRAME_MAX (PACKET_ADDRESSED_HEADER_SIZE + PACKET_PAYLOAD_MAX + 1)
+
+// Addresses of frames between boards in a ring, the board a frame is from
+// in the high nibble and the board it is to in the low nibble. A frame
+// between two boards has address 0, as a board never sends to itself.
+#define PACKET_ADDRESS(FROM, TO) ((FROM) << 4 | (TO))
+#define PACKET_FROM(ADDRESS) ((ADDRESS) >> 4)
+#define PACKET_TO(ADDRESS) ((ADDRESS) & 0x0F)
+// Which neighbour a frame is to, or is from: 1 for the one further round
+// the ring, 0 for the one before and for the other board of two
+#define PACKET_SIDE_TO(ADDRESS) (PACKET_TO(ADDRESS) > PACKET_FROM(ADDRESS))
+#define PACKET_SIDE_FROM(ADDRESS) (PACKET_FROM(ADDRESS) > PACKET_TO(ADDRESS))
+#define PACKET_SIDES 2
+
+// Packet types
+#define PACKET_READY 'R' // Board is present, sent while connecting a ring
+#define PACKET_BEACON 'D' // Looking for the other board, see discovery.h
+#define PACKET_START 'P' // Player has started the game
+#define PACKET_BALL 'B' // Ball crossing the border, with the scores
+#define PACKET_PROBE_QUERY 'Q' // Asks for the task timings, see probe.h
+#define PACKET_PROBE_STATS 'T' // Part of the task timings, see probe.h
+#define PACKET_RESYNC 'Y' // Snapshot and ball hand-offs, see resync.h
+#define PACKET_ACK 'A' // Packet received, see link.h
+#define PACKET_NACK 'N' // Packets missed, see link.h
+#define PACKET_LINK_QUERY 'L' // Asks for the link statistics, see link.h
+#define PACKET_LINK_STATS 'K' // The link statistics, see link.h
+#define PACKET_SPECTATE 'V' // The match for spectators, see broadcast.h
+
+
+typedef struct packet_struct
+{
+    uint8_t type; // One of the PACKET_* types
+    uint8_t seq; // Sequence number, incremented for every frame sent to the same side
+    uint8_t length; // Number of payload bytes
+    uint8_t address; // PACKET_ADDRESS() of the boards in a ring, 0 between two boards
+    uint8_t payload[PACKET_PAYLOAD_MAX]; // Message specific data
+} packet_t;
+
+
+typedef struct packet_decoder_struct
+{
+    uint8_t frame[PACKET_FRAME_MAX]; // Bytes of the frame being decoded
+    uint8_t count; // Number of bytes in frame
+    uint8_t last_seq; // Sequence number of the last accepted frame
+    uint8_t synced; // True once a frame has been accepted
+    uint16_t accepted; // Number of frames accepted
+    uint16_t rejected; // Number of frames rejected as corrupt
+    uint16_t duplicates; // Number of repeated frames, passed on for link.c to drop
+    uint16_t missed; // Number of frames skipped over, from sequence gaps
+} packet_decoder_t;
+
+
+// Stands in for the other board at the far end of the link, see
+// packet_peer_set()
+typedef struct packet_peer_struct
+{
+    void (*send)(const packet_t *packet); // Takes a packet this board sent
+    int (*receive)(packet_t *packet); // Gives a packet to this board, returns 1 if there was one
+} packet_peer_t;
+
+
+/*
+ * Function: packet_crc8
+ * --------------------
+ * Updates a CRC-8 (polynomial 0x07) with a block of bytes
+ *
+ * uint8_t crc: CRC so far, 0 to start
+ * const uint8_t *data: Bytes to add
+ * uint8_t length: Number of bytes
+ *
+ * Returns: the updated CRC
+*/
+uint8_t packet_crc8(uint8_t crc, const uint8_t *data, uint8_t length);
+
+
+/*
+ * Function: packet_encode
+ * --------------------
+ * Builds a frame for a packet
+ *
+ * uint8_t *frame: Buffer of at least PACKET_FRAME_MAX bytes
+ * const packet_t *packet: Packet to encode, length at most
+ * PACKET_PAYLOAD_MAX
+ *
+ * Returns: the number of bytes in the frame
+*/
+uint8_t packet_encode(uint8_t *frame, const packet_t *packet);
+
+
+/*
+ * Function: packet_decoder_init
+ * --------------------
+ * Resets a decoder, discarding any partial frame and its counters
+ *
+*/
+void packet_decoder_init(packet_decoder_t *decoder);
+
+
+/*
+ * Function: packet_decode
+ * --------------------
+ * Feeds one received byte to a decoder. Never blocks and does a bounded
+ * amount of work per byte; after a corrupt frame the bytes following its
+ * SYNC are rescanned so the next good frame is never lost.
+ *
+ * packet_decoder_t *decoder: Decoder to feed
+ * uint8_t byte: Byte received
+ * packet_t *packet: Filled in when a frame completes
+ *
+ * Returns: 1 if a valid packet was decoded, 0 otherwise. A frame sent
+ * twice is decoded both times, as only link.c knows which frames are
+ * sent again on purpose.
+*/
+int packet_decode(packet_decoder_t *decoder, uint8_t byte, packet_t *packet);
+
+
+/*
+ * Function: packet_send
+ * --------------------
+ * Frames a message with the next sequence number and sends it via
+ * ir_uart serial communications, logging it for replay (see record.h).
+ * It goes to the board across the border, see packet_address_set().
+ *
+ * uint8_t type: One of the PACKET_* types
+ * const uint8_t *payload: Message data, may be 0 if length is 0
+ * uint8_t length: Number of payload bytes, at most PACKET_PAYLOAD_MAX
+ *
+ * Returns: the sequence number the message was sent with
+*/
+uint8_t packet_send(uint8_t type, const uint8_t *payload, uint8_t length);
+
+
+/*
+ * Function: packet_send_to
+ * --------------------
+ * Sends a message as packet_send() does, to a given board. Sequence
+ * numbers are counted separately for each side, so each neighbour sees
+ * the frames sent to it numbered without gaps.
+ *
+ * uint8_t to_address: PACKET_ADDRESS() of this board and the board to
+ * send to, 0 between two boards
+ * uint8_t type: One of the PACKET_* types
+ * const uint8_t *payload: Message data, may be 0 if length is 0
+ * uint8_t length: Number of payload bytes, at most PACKET_PAYLOAD_MAX
+ *
+ * Returns: the sequence number the message was sent with
+*/
+uint8_t packet_send_to(uint8_t to_address, uint8_t type, const uint8_t *payload, uint8_t length);
+
+
+/*
+ * Function: packet_address_set
+ * --------------------
+ * Sets the address packet_send() sends with. Once it isn't 0, frames
+ * addressed to other boards are dropped by packet_receive(); frames with
+ * no address, from host tools, are still taken.
+ *
+ * uint8_t new_address: PACKET_ADDRESS() of this board and the board
+ * across its border, 0 between two boards
+ *
+*/
+void packet_address_set(uint8_t new_address);
+
+
+/*
+ * Function: packet_address_get
+ * --------------------
+ * Returns: the address packet_send() sends with
+*/
+uint8_t packet_address_get(void);
+
+
+/*
+ * Function: packet_resend
+ * --------------------
+ * Sends a packet again with the sequence number it was first sent with,
+ * so the receiver can tell it's a repeat, see link.h
+ *
+ * const packet_t *packet: Packet to send again
+ *
+*/
+void packet_resend(const packet_t *packet);
+
+
+/*
+ * Function: packet_receive
+ * --------------------
+ * Decodes whatever bytes the IR receive buffer holds so far, without
+ * waiting for the rest of a frame. A packet received is logged for
+ * replay (see record.h). In a ring, packets to other boards are passed
+ * over.
+ *
+ * packet_t *packet: Filled in when a packet is received
+ *
+ * Returns: 1 if a packet was received, 0 otherwise
+*/
+int packet_receive(packet_t *packet);
+
+
+/*
+ * Function: packet_peer_set
+ * --------------------
+ * Sends and receives packets through a peer in software instead of IR,
+ * for playing without a second board. Packets are still logged for
+ * replay.
+ *
+ * const packet_peer_t *new_peer: Peer to use, 0 to go back to IR
+ *
+*/
+void packet_peer_set(const packet_peer_t *new_peer);
+
+#endif
@@ -9,14 +9,9 @@
 #include "system.h"
 #include "navswitch.h"
 #include "tinygl.h"
-
-
-#define PADDLE_X 4
-#define PADDLE_TOP_INIT_Y 4
-#define PADDLE_BOTTOM_INIT_Y 2
-
-#define TOP_WALL_Y 6
-#define BOTTOM_WALL_Y 0
+#include "input.h"
+#include "render.h"
+#include "geometry.h"
 
 
 static tinygl_point_t paddle_top; //Tinygl_point_t for the top of the paddle
@@ -53,6 +48,40 @@ struct tinygl_point get_paddle_bottom(void)
 }
 
 
+/*
+ * Function: get_paddle_rows
+ * --------------------
+ * Getter for the rows the paddle covers, as a column of the playing grid
+ *
+ * Returns: a bitmask with BIT(y) set for each row y the paddle covers,
+ * none once it has been removed
+ *
+*/
+uint8_t get_paddle_rows(void)
+{
+    if (paddle_top.x != PADDLE_X) {
+        return 0;
+    }
+    return (uint8_t) (BIT(paddle_top.y + 1) - BIT(paddle_bottom.y));
+}
+
+
+/*
+ * Function: set_paddle_position
+ * --------------------
+ * Moves the paddle, keeping its length
+ *
+ * int bottom: Row for the bottom of the paddle
+ *
+*/
+void set_paddle_position(int bottom)
+{
+    paddle_top.y = bottom + (paddle_top.y - paddle_bottom.y);
+    paddle_bottom.y = bottom;
+    render_paddle(paddle_top, paddle_bottom);
+}
+
+
 /*
  * Function: paddle_init
  * --------------------
@@ -65,26 +94,48 @@ void paddle_init(void)
     paddle_bottom.y = PADDLE_BOTTOM_INIT_Y;
     paddle_top.x = PADDLE_X;
     paddle_top.y = PADDLE_TOP_INIT_Y;
+    render_paddle(paddle_top, paddle_bottom);
 }
 
 
 /*
  * Function: paddle_update
  * --------------------
- * Updates the paddle when the player moves the navswitch up or down
+ * Updates the paddle for each time the player has pushed the navswitch
+ * up or down since the last update, taking every queued navswitch event
  *
 */
 void paddle_update(void)
 {
-    if (navswitch_push_event_p (NAVSWITCH_NORTH)) {
-        if(paddle_bottom.y > BOTTOM_WALL_Y) {
+    input_event_t event; // Navswitch transition from the input queue
+    while (input_event_get(&event)) {
+        if (!event.pressed || paddle_top.x != PADDLE_X) {
+            continue;
+        }
+        if (event.navswitch == NAVSWITCH_NORTH && paddle_bottom.y > BOTTOM_WALL_Y) {
             paddle_bottom.y--;
             paddle_top.y--;
-        }
-    } else if (navswitch_push_event_p (NAVSWITCH_SOUTH)) {
-        if(paddle_top.y < TOP_WALL_Y) {
+            input_latency_start(event.time, PADDLE_X);
+        } else if (event.navswitch == NAVSWITCH_SOUTH && paddle_top.y < TOP_WALL_Y) {
             paddle_bottom.y++;
             paddle_top.y++;
+            input_latency_start(event.time, PADDLE_X);
         }
     }
+    render_paddle(paddle_top, paddle_bottom);
+}
+
+
+/*
+ * Function: paddle_remove
+ * --------------------
+ * Takes the paddle off the grid, for a board in the middle of a ring
+ * that has no player; balls pass it by and the navswitch is ignored
+ *
+*/
+void paddle_remove(void)
+{
+    paddle_bottom.x = GRID_WIDTH;
+    paddle_top.x = GRID_WIDTH;
+    render_paddle(paddle_top, paddle_bottom);
 }
@@ -36,6 +36,29 @@ struct tinygl_point get_paddle_top(void);
 struct tinygl_point get_paddle_bottom(void);
 
 
+/*
+ * Function: get_paddle_rows
+ * --------------------
+ * Getter for the rows the paddle covers, as a column of the playing grid
+ *
+ * Returns: a bitmask with BIT(y) set for each row y the paddle covers,
+ * none once it has been removed
+ *
+*/
+uint8_t get_paddle_rows(void);
+
+
+/*
+ * Function: set_paddle_position
+ * --------------------
+ * Moves the paddle, keeping its length
+ *
+ * int bottom: Row for the bottom of the paddle
+ *
+*/
+void set_paddle_position(int bottom);
+
+
 /*
  * Function: paddle_init
  * --------------------
@@ -48,10 +71,21 @@ void paddle_init(void);
 /*
  * Function: paddle_update
  * --------------------
- * Updates the paddle when the player moves the navswitch up or down
+ * Updates the paddle for each time the player has pushed the navswitch
+ * up or down since the last update, taking every queued navswitch event
  *
 */
 void paddle_update(void);
 
+
+/*
+ * Function: paddle_remove
+ * --------------------
+ * Takes the paddle off the grid, for a board in the middle of a ring
+ * that has no player; balls pass it by and the navswitch is ignored
+ *
+*/
+void paddle_remove(void);
+
 #endif
 
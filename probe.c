@@ -0,0 +1,244 @@
+/** @file   probe.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module handles timing the tasks and hot functions of the
+            pong game. Everything compiles away unless PROBE is defined.
+*/
+
+
+#include "system.h"
+#include "hal.h"
+#include "packet.h"
+#include "input.h"
+#include "probe.h"
+
+#ifdef PROBE
+
+
+static probe_stats_t probes[PROBE_NUM]; // Statistics of each probe
+static uint16_t starts[PROBE_NUM]; // Time each probe was started
+static uint8_t dump_probe; // Probe being dumped, then PROBE_NUM for the input latency
+static uint8_t dump_packet; // Next packet of the probe being dumped
+
+
+/*
+ * Function: bucket_of
+ * --------------------
+ * Returns: the histogram bucket for a time, a bucket per power of two
+*/
+static uint8_t bucket_of(uint16_t time)
+{
+    uint8_t bucket = 0;
+
+    while (time && bucket < PROBE_BUCKETS - 1) {
+        time >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+
+/*
+ * Function: probe_start
+ * --------------------
+ * Starts timing, use PROBE_START() so it compiles away without PROBE
+ *
+ * uint8_t probe: One of the PROBE_* probes
+ *
+*/
+void probe_start(uint8_t probe)
+{
+    starts[probe] = hal_timestamp();
+}
+
+
+/*
+ * Function: probe_stop
+ * --------------------
+ * Stops timing and records the time taken, use PROBE_STOP() so it
+ * compiles away without PROBE
+ *
+ * uint8_t probe: One of the PROBE_* probes
+ *
+*/
+void probe_stop(uint8_t probe)
+{
+    probe_record(probe, hal_timestamp() - starts[probe]);
+}
+
+
+/*
+ * Function: probe_record
+ * --------------------
+ * Records a time measured some other way, use PROBE_RECORD() so it
+ * compiles away without PROBE
+ *
+ * uint8_t probe: One of the PROBE_* probes
+ * uint16_t time: Time to record
+ *
+*/
+void probe_record(uint8_t probe, uint16_t time)
+{
+    probe_stats_t *stats = &probes[probe];
+    uint8_t bucket = bucket_of(time);
+
+    if (!stats->count || time < stats->min) {
+        stats->min = time;
+    }
+    if (time > stats->max) {
+        stats->max = time;
+    }
+    stats->count++;
+    stats->total += time;
+    if (stats->buckets[bucket] != UINT16_MAX) {
+        stats->buckets[bucket]++;
+    }
+}
+
+
+/*
+ * Function: probe_get
+ * --------------------
+ * Gets the statistics recorded by a probe
+ *
+ * uint8_t probe: One of the PROBE_* probes
+ * probe_stats_t *stats: Filled in with the statistics
+ *
+*/
+void probe_get(uint8_t probe, probe_stats_t *stats)
+{
+    // The display refresh records from an interrupt
+    uint8_t state = hal_interrupts_disable();
+
+    *stats = probes[probe];
+    hal_interrupts_restore(state);
+}
+
+
+/*
+ * Function: probe_reset
+ * --------------------
+ * Clears the statistics of every probe
+ *
+*/
+void probe_reset(void)
+{
+    uint8_t i;
+    uint8_t j;
+
+    for (i = 0; i < PROBE_NUM; i++) {
+        probes[i].min = 0;
+        probes[i].max = 0;
+        probes[i].count = 0;
+        probes[i].total = 0;
+        for (j = 0; j < PROBE_BUCKETS; j++) {
+            probes[i].buckets[j] = 0;
+        }
+    }
+}
+
+
+/*
+ * Function: probe_dump_start
+ * --------------------
+ * Starts sending the statistics of every probe over IR, in reply to a
+ * PACKET_PROBE_QUERY packet. Each probe takes PROBE_PACKETS
+ * PACKET_PROBE_STATS packets, sent a packet at a time by
+ * probe_dump_step() so other tasks still get to run.
+ *
+*/
+void probe_dump_start(void)
+{
+    dump_probe = 0;
+    dump_packet = 0;
+}
+
+
+/*
+ * Function: stats_word
+ * --------------------
+ * Returns: a word of a probe's statistics, in the order they are dumped
+*/
+static uint16_t stats_word(const probe_stats_t *stats, uint8_t word)
+{
+    switch (word) {
+    case 0:
+        return stats->min;
+    case 1:
+        return stats->max;
+    case 2:
+        return stats->count ? stats->total / stats->count : 0;
+    case 3:
+        return stats->count >> 16;
+    case 4:
+        return stats->count;
+    default:
+        return word - 5 < PROBE_BUCKETS ? stats->buckets[word - 5] : 0;
+    }
+}
+
+
+/*
+ * Function: probe_dump_step
+ * --------------------
+ * Sends the next packet of a dump started by probe_dump_start(). The
+ * payload is the probe number, the packet number, then
+ * PROBE_PACKET_WORDS 16 bit words, most significant byte first, from:
+ * min, max, mean, count (2 words), buckets. A last packet numbered
+ * PROBE_NUM holds the input latency min, median and max, in timer ticks.
+ *
+ * Returns: 1 if there is more to send, 0 once the dump is finished
+*/
+int probe_dump_step(void)
+{
+    uint8_t payload[2 + 2 * PROBE_PACKET_WORDS];
+    input_latency_t latency;
+    uint16_t word;
+    uint8_t i;
+
+    if (dump_probe > PROBE_NUM) {
+        return 0;
+    }
+    payload[0] = dump_probe;
+    payload[1] = dump_packet;
+    if (dump_probe == PROBE_NUM) {
+        input_latency_get(&latency);
+        payload[2] = latency.min >> 8;
+        payload[3] = latency.min;
+        payload[4] = latency.median >> 8;
+        payload[5] = latency.median;
+        payload[6] = latency.max >> 8;
+        payload[7] = latency.max;
+        packet_send(PACKET_PROBE_STATS, payload, sizeof(payload));
+        dump_probe++;
+        return 0;
+    }
+    for (i = 0; i < PROBE_PACKET_WORDS; i++) {
+        word = stats_word(&probes[dump_probe], dump_packet * PROBE_PACKET_WORDS + i);
+        payload[2 + 2 * i] = word >> 8;
+        payload[3 + 2 * i] = word;
+    }
+    packet_send(PACKET_PROBE_STATS, payload, sizeof(payload));
+
+    if (++dump_packet == PROBE_PACKETS) {
+        dump_packet = 0;
+        dump_probe++;
+    }
+    return 1;
+}
+
+#else
+
+/*
+ * Without PROBE there is nothing to time or dump
+ */
+void probe_dump_start(void)
+{
+}
+
+int probe_dump_step(void)
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,137 @@
+/** @file   probe.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for timing the tasks and hot functions
+            of the pong game. Each probe keeps the minimum, maximum and
+            mean time between PROBE_START() and PROBE_STOP(), and a
+            histogram with a bucket per power of two.
+
+            Probes are only compiled in when PROBE is defined (make
+            PROBE=1, always on in the host build), as their statistics
+            take a good part of the kit's RAM. Times are in counts of
+            hal_timestamp(): 256 CPU cycles on the kit, nanoseconds on
+            the host. PROBE_REFRESH_JITTER isn't a time taken but how
+            late each display refresh is, recorded by the scheduler in
+            timer ticks, which are the same 256 CPU cycles on the kit.
+*/
+
+#ifndef PROBE_H
+#define PROBE_H
+
+#include "system.h"
+
+#define PROBE_BUCKETS 16 // Bucket 0 holds 0, bucket n holds 2^(n-1) to 2^n - 1
+
+// Words sent per PACKET_PROBE_STATS packet, and packets per probe
+#define PROBE_PACKET_WORDS 3
+#define PROBE_PACKETS ((5 + PROBE_BUCKETS + PROBE_PACKET_WORDS - 1) / PROBE_PACKET_WORDS)
+
+enum {PROBE_DISPLAY_TASK, PROBE_NAVSWITCH_TASK, PROBE_GAME_TASK, PROBE_IR_TASK,
+      PROBE_UPDATE_BALLS, PROBE_SEND_BALL_POSITION, PROBE_GET_BALL_POSITION,
+      PROBE_REFRESH_JITTER, PROBE_NUM};
+
+
+typedef struct probe_stats_struct
+{
+    uint16_t min; // Shortest time recorded
+    uint16_t max; // Longest time recorded
+    uint32_t count; // Number of times recorded
+    uint32_t total; // Sum of the times recorded
+    uint16_t buckets[PROBE_BUCKETS]; // Histogram, each bucket saturating
+} probe_stats_t;
+
+
+#ifdef PROBE
+#define PROBE_START(PROBE_ID) probe_start(PROBE_ID)
+#define PROBE_STOP(PROBE_ID) probe_stop(PROBE_ID)
+#define PROBE_RECORD(PROBE_ID, TIME) probe_record(PROBE_ID, TIME)
+#else
+#define PROBE_START(PROBE_ID)
+#define PROBE_STOP(PROBE_ID)
+#define PROBE_RECORD(PROBE_ID, TIME)
+#endif
+
+
+/*
+ * Function: probe_start
+ * --------------------
+ * Starts timing, use PROBE_START() so it compiles away without PROBE
+ *
+ * uint8_t probe: One of the PROBE_* probes
+ *
+*/
+void probe_start(uint8_t probe);
+
+
+/*
+ * Function: probe_stop
+ * --------------------
+ * Stops timing and records the time taken, use PROBE_STOP() so it
+ * compiles away without PROBE
+ *
+ * uint8_t probe: One of the PROBE_* probes
+ *
+*/
+void probe_stop(uint8_t probe);
+
+
+/*
+ * Function: probe_record
+ * --------------------
+ * Records a time measured some other way, use PROBE_RECORD() so it
+ * compiles away without PROBE
+ *
+ * uint8_t probe: One of the PROBE_* probes
+ * uint16_t time: Time to record
+ *
+*/
+void probe_record(uint8_t probe, uint16_t time);
+
+
+/*
+ * Function: probe_get
+ * --------------------
+ * Gets the statistics recorded by a probe
+ *
+ * uint8_t probe: One of the PROBE_* probes
+ * probe_stats_t *stats: Filled in with the statistics
+ *
+*/
+void probe_get(uint8_t probe, probe_stats_t *stats);
+
+
+/*
+ * Function: probe_reset
+ * --------------------
+ * Clears the statistics of every probe
+ *
+*/
+void probe_reset(void);
+
+
+/*
+ * Function: probe_dump_start
+ * --------------------
+ * Starts sending the statistics of every probe over IR, in reply to a
+ * PACKET_PROBE_QUERY packet. Each probe takes PROBE_PACKETS
+ * PACKET_PROBE_STATS packets, sent a packet at a time by
+ * probe_dump_step() so other tasks still get to run.
+ *
+*/
+void probe_dump_start(void);
+
+
+/*
+ * Function: probe_dump_step
+ * --------------------
+ * Sends the next packet of a dump started by probe_dump_start(). The
+ * payload is the probe number, the packet number, then
+ * PROBE_PACKET_WORDS 16 bit words, most significant byte first, from:
+ * min, max, mean, count (2 words), buckets. A last packet numbered
+ * PROBE_NUM holds the input latency min, median and max, in timer ticks.
+ *
+ * Returns: 1 if there is more to send, 0 once the dump is finished
+*/
+int probe_dump_step(void);
+
+#endif
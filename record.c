@@ -0,0 +1,460 @@
+/** @file   record.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module handles recording matches of the pong game to
+            EEPROM, and replaying them through the game logic.
+*/
+
+
+#include "system.h"
+#include "timer.h"
+#include "hal.h"
+#include "ir_rx.h"
+#include "input.h"
+#include "packet.h"
+#include "record.h"
+
+
+#define RECORD_INDEX_MASK (RECORD_BUFFER_SIZE - 1)
+#define RECORD_NAVSWITCH_MASK 0x07
+#define RECORD_IR_IN_SIZE 3 // Header byte, type and sequence number, then payload
+#define RECORD_IR_OUT_SIZE 4 // Header byte, type, sequence number and CRC-8
+
+
+static uint8_t buffer[RECORD_BUFFER_SIZE]; // Log not yet written to EEPROM
+static uint8_t head; // Count of bytes added to the buffer
+static uint8_t tail; // Count of bytes written out of the buffer
+static uint16_t logged; // Length of the log so far
+static uint16_t written; // Bytes of the log written to EEPROM
+static uint8_t flags; // RECORD_FLAG_* flags for the header
+static uint8_t recording; // True while records are being added
+static uint8_t writing; // True until the log and its header are all in EEPROM
+static uint8_t header_left; // Header bytes left to write once the match is over, 0 before
+static uint16_t frame; // Game updates so far
+static uint16_t logged_frame; // Game update the log has been brought up to
+
+static const uint8_t *replay_log; // Log to replay, 0 to record
+static uint8_t replaying; // True once replaying has started
+static uint16_t replay_length; // Length of the log being replayed
+static uint16_t replay_pos; // Next record to queue
+static uint16_t replay_frame; // Game update that record comes after
+static uint16_t replay_out_pos; // Where to look for the next packet sent
+static uint16_t mismatches; // Packets sent that differ from the log
+static record_observer_t observer; // Called after each game update
+
+
+/*
+ * Function: eeprom_put
+ * --------------------
+ * Writes a byte to EEPROM, waiting for any write in progress to finish
+ *
+ * uint16_t address: Address to write to
+ * uint8_t byte: Byte to write
+ *
+*/
+static void eeprom_put(uint16_t address, uint8_t byte)
+{
+    while (!hal_eeprom_write(address, byte)) {
+        continue;
+    }
+}
+
+
+/*
+ * Function: log_record
+ * --------------------
+ * Adds a record to the log, after a record for the game updates since
+ * the last one. If either doesn't fit, recording stops there so the log
+ * stays whole.
+ *
+ * const uint8_t *record: Bytes of the record
+ * uint8_t size: Number of bytes, 0 to only log the game updates
+ *
+*/
+static void log_record(const uint8_t *record, uint8_t size)
+{
+    uint16_t frames = frame - logged_frame;
+    uint16_t needed = size + (frames + RECORD_ARG_MASK - 1) / RECORD_ARG_MASK;
+    uint8_t count;
+    uint8_t i;
+
+    if (!recording) {
+        return;
+    }
+    if (needed > RECORD_BUFFER_SIZE - (uint8_t) (head - tail)
+        || logged + needed > RECORD_LOG_MAX) {
+        flags |= RECORD_FLAG_TRUNCATED;
+        recording = 0;
+        return;
+    }
+    while (frames) {
+        count = frames < RECORD_ARG_MASK ? frames : RECORD_ARG_MASK;
+        buffer[head++ & RECORD_INDEX_MASK] = RECORD_FRAMES | count;
+        frames -= count;
+    }
+    logged_frame = frame;
+    for (i = 0; i < size; i++) {
+        buffer[head++ & RECORD_INDEX_MASK] = record[i];
+    }
+    logged += needed;
+}
+
+
+/*
+ * Function: write_step
+ * --------------------
+ * Starts writing the next byte of the log to EEPROM, unless the last
+ * write is still going. Once the match is over and the whole log is
+ * written the header follows, its first magic byte last, as the header
+ * is only valid once that is written.
+ *
+*/
+static void write_step(void)
+{
+    uint8_t header[RECORD_HEADER_SIZE];
+    uint8_t i;
+
+    if (!writing) {
+        return;
+    }
+    if (head != tail) {
+        if (hal_eeprom_write(RECORD_HEADER_SIZE + written, buffer[tail & RECORD_INDEX_MASK])) {
+            tail++;
+            written++;
+        }
+        return;
+    }
+    if (!header_left) {
+        return;
+    }
+    header[0] = RECORD_MAGIC_0;
+    header[1] = RECORD_MAGIC_1;
+    header[2] = written >> 8;
+    header[3] = written;
+    header[4] = flags;
+    i = (RECORD_HEADER_SIZE + 1 - header_left) % RECORD_HEADER_SIZE;
+    if (hal_eeprom_write(i, header[i])) {
+        header_left--;
+        writing = header_left != 0;
+    }
+}
+
+
+/*
+ * Function: replay_queue
+ * --------------------
+ * Queues the navswitch pushes and received packets of the log being
+ * replayed up to the current game update, as if they had just happened
+ *
+*/
+static void replay_queue(void)
+{
+    uint8_t frame_bytes[PACKET_FRAME_MAX];
+    packet_t packet;
+    uint8_t type;
+    uint8_t arg;
+    uint8_t size;
+    uint8_t i;
+
+    while (replay_pos < replay_length) {
+        type = replay_log[replay_pos] & RECORD_TYPE_MASK;
+        arg = replay_log[replay_pos] & RECORD_ARG_MASK;
+        switch (type) {
+        case RECORD_FRAMES:
+            if ((uint16_t) (replay_frame + arg) > frame) {
+                return;
+            }
+            replay_frame += arg;
+            replay_pos++;
+            break;
+        case RECORD_NAVSWITCH:
+            if (!input_event_put(arg & RECORD_NAVSWITCH_MASK, 1)) {
+                // Held back until the navswitch task has made room
+                return;
+            }
+            replay_pos++;
+            break;
+        case RECORD_IR_IN:
+            if (arg > PACKET_PAYLOAD_MAX
+                || replay_pos + RECORD_IR_IN_SIZE + arg > replay_length) {
+                replay_pos = replay_length;
+                return;
+            }
+            packet.type = replay_log[replay_pos + 1];
+            packet.seq = replay_log[replay_pos + 2];
+            packet.length = arg;
+            packet.address = 0;
+            for (i = 0; i < arg; i++) {
+                packet.payload[i] = replay_log[replay_pos + RECORD_IR_IN_SIZE + i];
+            }
+            size = packet_encode(frame_bytes, &packet);
+            for (i = 0; i < size; i++) {
+                ir_rx_isr(frame_bytes[i]);
+            }
+            replay_pos += RECORD_IR_IN_SIZE + arg;
+            break;
+        default:
+            // Packets sent are checked by record_ir_out()
+            replay_pos += RECORD_IR_OUT_SIZE;
+            break;
+        }
+    }
+}
+
+
+/*
+ * Function: record_init
+ * --------------------
+ * Starts recording, or replaying if record_replay_set() has been
+ * called, from game update 0
+ *
+*/
+void record_init(void)
+{
+    head = 0;
+    tail = 0;
+    logged = 0;
+    written = 0;
+    flags = 0;
+    frame = 0;
+    logged_frame = 0;
+    header_left = 0;
+    mismatches = 0;
+    replaying = replay_log != 0;
+    if (replaying) {
+        recording = 0;
+        writing = 0;
+        replay_pos = 0;
+        replay_frame = 0;
+        replay_out_pos = 0;
+    } else {
+        recording = 1;
+        writing = 1;
+        // Until it is finished there is no log, rather than a stale one
+        eeprom_put(0, 0xFF);
+    }
+    if (observer) {
+        observer(frame);
+    }
+    if (replaying) {
+        replay_queue();
+    }
+}
+
+
+/*
+ * Function: record_frame
+ * --------------------
+ * Counts a game update, called after each one. Starts writing a byte of
+ * the log, or once the match is over of its header, to EEPROM, or when
+ * replaying queues the input that came before the next update.
+ *
+*/
+void record_frame(void)
+{
+    frame++;
+    if (frame - logged_frame >= RECORD_ARG_MASK) {
+        log_record(0, 0);
+    }
+    write_step();
+    if (replaying) {
+        replay_queue();
+    }
+    if (observer) {
+        observer(frame);
+    }
+}
+
+
+/*
+ * Function: record_navswitch
+ * --------------------
+ * Logs the navswitch being pushed, when the tasks take the push. Only
+ * pushes are logged as releases never change the game.
+ *
+ * uint8_t navswitch: Direction pushed
+ *
+*/
+void record_navswitch(uint8_t navswitch)
+{
+    uint8_t record = RECORD_NAVSWITCH | navswitch;
+
+    log_record(&record, 1);
+}
+
+
+/*
+ * Function: record_ir_in
+ * --------------------
+ * Logs a packet being received, when the tasks take it
+ *
+ * const packet_t *packet: Packet received
+ *
+*/
+void record_ir_in(const packet_t *packet)
+{
+    uint8_t record[RECORD_IR_IN_SIZE + PACKET_PAYLOAD_MAX];
+    uint8_t i;
+
+    record[0] = RECORD_IR_IN | packet->length;
+    record[1] = packet->type;
+    record[2] = packet->seq;
+    for (i = 0; i < packet->length; i++) {
+        record[RECORD_IR_IN_SIZE + i] = packet->payload[i];
+    }
+    log_record(record, RECORD_IR_IN_SIZE + packet->length);
+}
+
+
+/*
+ * Function: record_ir_out
+ * --------------------
+ * Logs a packet being sent. When replaying, checks it against the one
+ * sent at this point of the recording instead.
+ *
+ * const packet_t *packet: Packet sent
+ *
+*/
+void record_ir_out(const packet_t *packet)
+{
+    uint8_t record[RECORD_IR_OUT_SIZE];
+    uint8_t arg;
+
+    record[0] = RECORD_IR_OUT | packet->length;
+    record[1] = packet->type;
+    record[2] = packet->seq;
+    record[3] = packet_crc8(0, packet->payload, packet->length);
+    if (!replaying) {
+        log_record(record, RECORD_IR_OUT_SIZE);
+        return;
+    }
+
+    // Find the next packet sent in the log
+    while (replay_out_pos < replay_length) {
+        arg = replay_log[replay_out_pos] & RECORD_ARG_MASK;
+        switch (replay_log[replay_out_pos] & RECORD_TYPE_MASK) {
+        case RECORD_IR_IN:
+            replay_out_pos += RECORD_IR_IN_SIZE + arg;
+            continue;
+        case RECORD_IR_OUT:
+            break;
+        default:
+            replay_out_pos++;
+            continue;
+        }
+        break;
+    }
+    if (replay_out_pos + RECORD_IR_OUT_SIZE > replay_length
+        || replay_log[replay_out_pos] != record[0]
+        || replay_log[replay_out_pos + 1] != record[1]
+        || replay_log[replay_out_pos + 2] != record[2]
+        || replay_log[replay_out_pos + 3] != record[3]) {
+        mismatches++;
+    }
+    replay_out_pos += RECORD_IR_OUT_SIZE;
+}
+
+
+/*
+ * Function: record_finish
+ * --------------------
+ * Stops recording, called when the game ends. The rest of the log and
+ * its header are written by the next calls to record_frame(), a byte
+ * each, see record_written_p(), so the game isn't held up while the
+ * EEPROM is slowly written.
+ *
+*/
+void record_finish(void)
+{
+    if (!writing || header_left) {
+        return;
+    }
+    // Log the updates since the last record, so a replay runs as long
+    log_record(0, 0);
+    recording = 0;
+    header_left = RECORD_HEADER_SIZE;
+}
+
+
+/*
+ * Function: record_written_p
+ * --------------------
+ * Returns: 1 once the log and its header are all in EEPROM, or nothing
+ * is being recorded, 0 while record_frame() still has some to write
+*/
+int record_written_p(void)
+{
+    return !writing;
+}
+
+
+/*
+ * Function: record_replay_set
+ * --------------------
+ * Makes the next record_init() replay a log instead of recording. Its
+ * navswitch pushes and received packets are queued as if they had just
+ * happened, after the same game updates as when it was recorded.
+ *
+ * const uint8_t *log: Log to replay, without the EEPROM header
+ * uint16_t length: Length of the log in bytes
+ *
+*/
+void record_replay_set(const uint8_t *log, uint16_t length)
+{
+    replay_log = log;
+    replay_length = length;
+}
+
+
+/*
+ * Function: record_replay_resume
+ * --------------------
+ * Queues the navswitch pushes of the log being replayed that were held
+ * back while the input queue was full, as many pushes can come before
+ * the first game update. Does nothing unless replaying.
+ *
+*/
+void record_replay_resume(void)
+{
+    if (replaying) {
+        replay_queue();
+    }
+}
+
+
+/*
+ * Function: record_replay_mismatches
+ * --------------------
+ * Returns: the number of packets sent during a replay that differ from
+ * those sent when it was recorded
+*/
+uint16_t record_replay_mismatches(void)
+{
+    return mismatches;
+}
+
+
+/*
+ * Function: record_replay_done_p
+ * --------------------
+ * Returns: 1 if everything in the log being replayed has been queued
+*/
+int record_replay_done_p(void)
+{
+    return replay_pos >= replay_length;
+}
+
+
+/*
+ * Function: record_observer_set
+ * --------------------
+ * Sets a function called after each game update is counted, and once
+ * from record_init() with update 0, for tools to trace the game
+ *
+ * record_observer_t new_observer: Function to call, 0 for none
+ *
+*/
+void record_observer_set(record_observer_t new_observer)
+{
+    observer = new_observer;
+}
@@ -0,0 +1,182 @@
+/** @file   record.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for recording matches of the pong game
+            so they can be replayed exactly. Everything that reaches the
+            game logic from outside is logged against the game update it
+            happened after: navswitch pushes as the tasks take them, and
+            packets as they are received and sent. The log is buffered in
+            RAM and written out to EEPROM a byte per game update, the
+            rest of it and the header following once the game ends.
+
+            A log is a series of records, each starting with a byte
+            whose top two bits give its type:
+              00nnnnnn  n game updates passed, 1 to 63
+              01000ddd  navswitch pushed in direction d
+              10llllll  packet received: type, sequence number, then l
+                        payload bytes
+              11llllll  packet sent: type, sequence number, CRC-8 of the
+                        l payload bytes
+            In EEPROM it follows a RECORD_HEADER_SIZE byte header: the
+            magic bytes 'P' 'L', the log length (most significant byte
+            first) and flags.
+*/
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#include "system.h"
+#include "packet.h"
+
+#define RECORD_EEPROM_SIZE 1024 // EEPROM of the ATmega32U2
+#define RECORD_HEADER_SIZE 5
+#define RECORD_LOG_MAX (RECORD_EEPROM_SIZE - RECORD_HEADER_SIZE)
+#define RECORD_BUFFER_SIZE 64 // Must be a power of two, at most 128
+
+#define RECORD_MAGIC_0 'P'
+#define RECORD_MAGIC_1 'L'
+#define RECORD_FLAG_TRUNCATED BIT(0) // The EEPROM or buffer filled up
+
+// Record types, in the top two bits of their first byte
+#define RECORD_FRAMES 0x00
+#define RECORD_NAVSWITCH 0x40
+#define RECORD_IR_IN 0x80
+#define RECORD_IR_OUT 0xC0
+#define RECORD_TYPE_MASK 0xC0
+#define RECORD_ARG_MASK 0x3F
+
+
+typedef void (* record_observer_t)(uint16_t frame);
+
+
+/*
+ * Function: record_init
+ * --------------------
+ * Starts recording, or replaying if record_replay_set() has been
+ * called, from game update 0
+ *
+*/
+void record_init(void);
+
+
+/*
+ * Function: record_frame
+ * --------------------
+ * Counts a game update, called after each one. Writes a byte of the log
+ * to EEPROM, or when replaying queues the input that came before the
+ * next update.
+ *
+*/
+void record_frame(void);
+
+
+/*
+ * Function: record_navswitch
+ * --------------------
+ * Logs the navswitch being pushed, when the tasks take the push. Only
+ * pushes are logged as releases never change the game.
+ *
+ * uint8_t navswitch: Direction pushed
+ *
+*/
+void record_navswitch(uint8_t navswitch);
+
+
+/*
+ * Function: record_ir_in
+ * --------------------
+ * Logs a packet being received, when the tasks take it
+ *
+ * const packet_t *packet: Packet received
+ *
+*/
+void record_ir_in(const packet_t *packet);
+
+
+/*
+ * Function: record_ir_out
+ * --------------------
+ * Logs a packet being sent. When replaying, checks it against the one
+ * sent at this point of the recording instead.
+ *
+ * const packet_t *packet: Packet sent
+ *
+*/
+void record_ir_out(const packet_t *packet);
+
+
+/*
+ * Function: record_finish
+ * --------------------
+ * Stops recording, called when the game ends. The rest of the log and
+ * its header are written by the next calls to record_frame(), a byte
+ * each, see record_written_p(), so the game isn't held up while the
+ * EEPROM is slowly written.
+ *
+*/
+void record_finish(void);
+
+
+/*
+ * Function: record_written_p
+ * --------------------
+ * Returns: 1 once the log and its header are all in EEPROM, or nothing
+ * is being recorded, 0 while record_frame() still has some to write
+*/
+int record_written_p(void);
+
+
+/*
+ * Function: record_replay_set
+ * --------------------
+ * Makes the next record_init() replay a log instead of recording. Its
+ * navswitch pushes and received packets are queued as if they had just
+ * happened, after the same game updates as when it was recorded.
+ *
+ * const uint8_t *log: Log to replay, without the EEPROM header
+ * uint16_t length: Length of the log in bytes
+ *
+*/
+void record_replay_set(const uint8_t *log, uint16_t length);
+
+
+/*
+ * Function: record_replay_resume
+ * --------------------
+ * Queues the navswitch pushes of the log being replayed that were held
+ * back while the input queue was full, as many pushes can come before
+ * the first game update. Does nothing unless replaying.
+ *
+*/
+void record_replay_resume(void);
+
+
+/*
+ * Function: record_replay_mismatches
+ * --------------------
+ * Returns: the number of packets sent during a replay that differ from
+ * those sent when it was recorded
+*/
+uint16_t record_replay_mismatches(void);
+
+
+/*
+ * Function: record_replay_done_p
+ * --------------------
+ * Returns: 1 if everything in the log being replayed has been queued
+*/
+int record_replay_done_p(void);
+
+
+/*
+ * Function: record_observer_set
+ * --------------------
+ * Sets a function called after each game update is counted, and once
+ * from record_init() with update 0, for tools to trace the game
+ *
+ * record_observer_t new_observer: Function to call, 0 for none
+ *
+*/
+void record_observer_set(record_observer_t new_observer);
+
+#endif
@@ -0,0 +1,159 @@
+/** @file   render.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module handles drawing the playing grid in the pong
+            game. The grid is kept as a byte per column, a bit per row,
+            which is built from the published objects with a few ORs
+            and scanned straight out to the LED matrix.
+*/
+
+
+#include "system.h"
+#include "tinygl.h"
+#include "ledmat.h"
+#include "hal.h"
+#include "geometry.h"
+#include "render.h"
+
+
+static uint8_t shown[GRID_WIDTH]; // Pixels lit on the display, a bit per row
+static tinygl_point_t balls[RENDER_BALLS]; // Last published ball positions
+static uint8_t balls_shown; // Bitmask of the balls that should be drawn
+static uint8_t paddle_x; // Column of the last published paddle
+static uint8_t paddle_rows; // Rows of the last published paddle, a bit per row
+static int dirty; // True if anything has been published since the last update
+
+
+/*
+ * Function: render_reset
+ * --------------------
+ * Clears the display, including any text, and redraws everything that
+ * has been published on the next render_update(). Used when play starts.
+ *
+*/
+void render_reset(void)
+{
+    uint8_t x;
+
+    tinygl_clear();
+    for (x = 0; x < GRID_WIDTH; x++) {
+        shown[x] = 0;
+    }
+    dirty = 1;
+}
+
+
+/*
+ * Function: render_ball
+ * --------------------
+ * Publishes the position of a ball
+ *
+ * uint8_t id: Ball that moved, below RENDER_BALLS
+ * tinygl_point_t point: Grid position of the ball
+ *
+*/
+void render_ball(uint8_t id, tinygl_point_t point)
+{
+    uint8_t state;
+
+    if (point.x != balls[id].x || point.y != balls[id].y) {
+        // The display is refreshed from the timer interrupt, which
+        // mustn't see half a position
+        state = hal_interrupts_disable();
+        balls[id] = point;
+        dirty |= (balls_shown >> id) & 1;
+        hal_interrupts_restore(state);
+    }
+}
+
+
+/*
+ * Function: render_ball_show
+ * --------------------
+ * Publishes which balls are on this screen
+ *
+ * uint8_t visible: Bitmask of the balls to draw, BIT(id) for each
+ *
+*/
+void render_ball_show(uint8_t visible)
+{
+    uint8_t state;
+
+    if (visible != balls_shown) {
+        state = hal_interrupts_disable();
+        balls_shown = visible;
+        dirty = 1;
+        hal_interrupts_restore(state);
+    }
+}
+
+
+/*
+ * Function: render_paddle
+ * --------------------
+ * Publishes the position of the paddle, which is always vertical
+ *
+ * tinygl_point_t top: Top of the paddle
+ * tinygl_point_t bottom: Bottom of the paddle
+ *
+*/
+void render_paddle(tinygl_point_t top, tinygl_point_t bottom)
+{
+    uint8_t rows = (uint8_t) (BIT(top.y + 1) - BIT(bottom.y));
+    uint8_t state;
+
+    if (rows != paddle_rows || top.x != paddle_x) {
+        state = hal_interrupts_disable();
+        paddle_x = top.x;
+        paddle_rows = rows;
+        dirty = 1;
+        hal_interrupts_restore(state);
+    }
+}
+
+
+/*
+ * Function: render_update
+ * --------------------
+ * Builds the grid from what has been published, a column at a time.
+ * Does nothing at all if nothing has been published since the last
+ * update.
+ *
+*/
+void render_update(void)
+{
+    uint8_t x;
+    uint8_t id;
+
+    if (!dirty) {
+        return;
+    }
+
+    for (x = 0; x < GRID_WIDTH; x++) {
+        shown[x] = 0;
+    }
+    if (paddle_x < GRID_WIDTH) {
+        shown[paddle_x] = paddle_rows;
+    }
+    for (id = 0; id < RENDER_BALLS; id++) {
+        if ((balls_shown >> id) & 1 && balls[id].x >= 0 && balls[id].x < GRID_WIDTH) {
+            shown[balls[id].x] |= BIT(balls[id].y);
+        }
+    }
+    dirty = 0;
+}
+
+
+/*
+ * Function: render_column
+ * --------------------
+ * Lights a column of the grid on the LED matrix, in place of
+ * tinygl_update() while the grid is shown
+ *
+ * uint8_t column: Column to light, below GRID_WIDTH
+ *
+*/
+void render_column(uint8_t column)
+{
+    ledmat_display_column(shown[column], column);
+}
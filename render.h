@@ -0,0 +1,87 @@
+/** @file   render.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for drawing the playing grid in the
+            pong game. The ball and paddle modules publish where they
+            are whenever they move, and the grid is rebuilt as a byte
+            per column only when something has, then scanned out to the
+            LED matrix a column at a time without going through tinygl.
+*/
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "system.h"
+#include "tinygl.h"
+
+#define RENDER_BALLS 4 // Most balls that can be drawn at once
+
+
+/*
+ * Function: render_reset
+ * --------------------
+ * Clears the display, including any text, and redraws everything that
+ * has been published on the next render_update(). Used when play starts.
+ *
+*/
+void render_reset(void);
+
+
+/*
+ * Function: render_ball
+ * --------------------
+ * Publishes the position of a ball
+ *
+ * uint8_t id: Ball that moved, below RENDER_BALLS
+ * tinygl_point_t point: Grid position of the ball
+ *
+*/
+void render_ball(uint8_t id, tinygl_point_t point);
+
+
+/*
+ * Function: render_ball_show
+ * --------------------
+ * Publishes which balls are on this screen
+ *
+ * uint8_t visible: Bitmask of the balls to draw, BIT(id) for each
+ *
+*/
+void render_ball_show(uint8_t visible);
+
+
+/*
+ * Function: render_paddle
+ * --------------------
+ * Publishes the position of the paddle, which is always vertical
+ *
+ * tinygl_point_t top: Top of the paddle
+ * tinygl_point_t bottom: Bottom of the paddle
+ *
+*/
+void render_paddle(tinygl_point_t top, tinygl_point_t bottom);
+
+
+/*
+ * Function: render_update
+ * --------------------
+ * Builds the grid from what has been published, a column at a time.
+ * Does nothing at all if nothing has been published since the last
+ * update.
+ *
+*/
+void render_update(void);
+
+
+/*
+ * Function: render_column
+ * --------------------
+ * Lights a column of the grid on the LED matrix, in place of
+ * tinygl_update() while the grid is shown
+ *
+ * uint8_t column: Column to light, below GRID_WIDTH
+ *
+*/
+void render_column(uint8_t column);
+
+#endif
@@ -0,0 +1,188 @@
+/** @file   resync.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module keeps the two boards in step when IR packets are
+            lost, by swapping snapshots and rolling lost balls back to
+            where they were last hit.
+*/
+
+
+#include "system.h"
+#include "packet.h"
+#include "link.h"
+#include "ball.h"
+#include "state.h"
+#include "resync.h"
+
+#if BALL_POOL_SIZE > 4
+#error "The hand-off counts only have room for four balls"
+#endif
+
+#define HANDOFF_BITS 2
+#define HANDOFF_MASK 0b11
+
+
+static uint8_t updates; // Game updates since the last snapshot was sent
+static uint8_t handoffs; // Times each ball has changed screen, HANDOFF_BITS a ball
+static uint8_t strikes[BALL_POOL_SIZE]; // Snapshots in a row the other board was a ball behind
+static uint8_t sent_payload[BALL_POOL_SIZE][BALL_PAYLOAD_MAX]; // Last packet sent for each ball
+static uint8_t sent_length[BALL_POOL_SIZE]; // Length of sent_payload, 0 if never sent
+
+
+/*
+ * Function: handoff_count
+ * --------------------
+ * Gets the hand-off count for a ball from a byte of counts
+ *
+ * uint8_t counts: Counts for every ball
+ * uint8_t id: Ball to get the count for
+ *
+ * Returns: the count, modulo 4
+*/
+static uint8_t handoff_count(uint8_t counts, uint8_t id)
+{
+    return (counts >> (id * HANDOFF_BITS)) & HANDOFF_MASK;
+}
+
+
+/*
+ * Function: handoff_add
+ * --------------------
+ * Counts a ball changing screen
+ *
+ * uint8_t id: Ball that changed screen
+ *
+*/
+static void handoff_add(uint8_t id)
+{
+    uint8_t count = (handoff_count(handoffs, id) + 1) & HANDOFF_MASK;
+
+    handoffs = (handoffs & ~(HANDOFF_MASK << (id * HANDOFF_BITS))) | count << (id * HANDOFF_BITS);
+}
+
+
+/*
+ * Function: resync_init
+ * --------------------
+ * Forgets the balls sent and the hand-offs counted, for a new game
+ *
+*/
+void resync_init(void)
+{
+    uint8_t id;
+
+    updates = 0;
+    handoffs = 0;
+    for (id = 0; id < BALL_POOL_SIZE; id++) {
+        strikes[id] = 0;
+        sent_length[id] = 0;
+    }
+}
+
+
+/*
+ * Function: resync_ball_sent
+ * --------------------
+ * Keeps a copy of a ball packet just sent by send_ball_position(), to
+ * roll the ball back to if the packet is lost, and counts the hand-off
+ *
+ * uint8_t id: Ball that was sent
+ * int their_score: The score that was sent with it
+ *
+*/
+void resync_ball_sent(uint8_t id, int their_score)
+{
+    ball_state_t state;
+
+    get_ball_state(id, &state);
+    sent_length[id] = ball_pack(&state, id, their_score, sent_payload[id]);
+    handoff_add(id);
+}
+
+
+/*
+ * Function: resync_ball_received
+ * --------------------
+ * Counts a ball packet received from the other board
+ *
+ * uint8_t id: Ball that was received
+ *
+*/
+void resync_ball_received(uint8_t id)
+{
+    handoff_add(id);
+}
+
+
+/*
+ * Function: resync_update
+ * --------------------
+ * Called every game update, sends a PACKET_RESYNC snapshot every
+ * RESYNC_PERIOD updates
+ *
+ * const game_state_t *game: State of this board
+ *
+*/
+void resync_update(const game_state_t *game)
+{
+    uint8_t payload[RESYNC_PAYLOAD_SIZE];
+
+    updates++;
+    if (updates >= RESYNC_PERIOD) {
+        updates = 0;
+        state_pack(game, payload);
+        payload[STATE_SIZE] = handoffs;
+        packet_send(PACKET_RESYNC, payload, RESYNC_PAYLOAD_SIZE);
+    }
+}
+
+
+/*
+ * Function: resync_receive
+ * --------------------
+ * Compares a PACKET_RESYNC snapshot from the other board with this one,
+ * taking this player's score from it if it's ahead and sending again any
+ * ball the other board is still missing after RESYNC_STRIKES snapshots
+ *
+ * const packet_t *packet: The PACKET_RESYNC packet received
+ * game_state_t *game: State of this board, corrected in place
+ *
+ * Returns: 1 if anything was corrected, 0 if the boards agree
+*/
+int resync_receive(const packet_t *packet, game_state_t *game)
+{
+    game_state_t theirs; // Snapshot of the other board
+    uint8_t behind; // Hand-offs of a ball the other board hasn't seen
+    uint8_t id;
+    int corrected = 0;
+
+    if (packet->length != RESYNC_PAYLOAD_SIZE || !state_unpack(packet->payload, &theirs)) {
+        return 0;
+    }
+    // The other board counts the points it concedes itself, and this
+    // board only hears about them with the next ball it sends
+    if (theirs.their_score > game->this_score) {
+        game->this_score = theirs.their_score;
+        corrected = 1;
+    }
+    // A ball the other board is a hand-off behind on was last sent by
+    // this board, and the packet hasn't arrived. Waiting for a second
+    // snapshot lets a packet that was only in flight get there first. The
+    // link may still be sending it again too, so the two copies share a
+    // sequence number and the other board can't take the ball twice.
+    for (id = 0; id < BALL_POOL_SIZE; id++) {
+        behind = (handoff_count(handoffs, id) - handoff_count(packet->payload[STATE_SIZE], id))
+                 & HANDOFF_MASK;
+        if (behind == 1 && sent_length[id]) {
+            strikes[id]++;
+            if (strikes[id] >= RESYNC_STRIKES) {
+                link_send_again(PACKET_BALL, sent_payload[id], sent_length[id]);
+                strikes[id] = 0;
+                corrected = 1;
+            }
+        } else {
+            strikes[id] = 0;
+        }
+    }
+    return corrected;
+}
@@ -0,0 +1,86 @@
+/** @file   resync.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for keeping the two boards in step when
+            IR packets are lost. About once a second each board sends a
+            snapshot of its state with a count of how many times each
+            ball has changed screen. The boards only disagree about the
+            things the lost packets carried, so each one rolls back what
+            it sent: a board a ball behind the other is sent that ball
+            again from where it was hit, and the scores are taken from
+            the board that conceded them. Nothing else is sent while
+            the boards agree.
+*/
+
+#ifndef RESYNC_H
+#define RESYNC_H
+
+#include "system.h"
+#include "packet.h"
+#include "state.h"
+
+#define RESYNC_PERIOD 50 // Game updates between snapshots, a second
+#define RESYNC_STRIKES 2 // Snapshots in a row a ball must be missing from before it's sent again
+#define RESYNC_PAYLOAD_SIZE (STATE_SIZE + 1) // Snapshot, then the hand-off counts
+
+
+/*
+ * Function: resync_init
+ * --------------------
+ * Forgets the balls sent and the hand-offs counted, for a new game
+ *
+*/
+void resync_init(void);
+
+
+/*
+ * Function: resync_ball_sent
+ * --------------------
+ * Keeps a copy of a ball packet just sent by send_ball_position(), to
+ * roll the ball back to if the packet is lost, and counts the hand-off
+ *
+ * uint8_t id: Ball that was sent
+ * int their_score: The score that was sent with it
+ *
+*/
+void resync_ball_sent(uint8_t id, int their_score);
+
+
+/*
+ * Function: resync_ball_received
+ * --------------------
+ * Counts a ball packet received from the other board
+ *
+ * uint8_t id: Ball that was received
+ *
+*/
+void resync_ball_received(uint8_t id);
+
+
+/*
+ * Function: resync_update
+ * --------------------
+ * Called every game update, sends a PACKET_RESYNC snapshot every
+ * RESYNC_PERIOD updates
+ *
+ * const game_state_t *game: State of this board
+ *
+*/
+void resync_update(const game_state_t *game);
+
+
+/*
+ * Function: resync_receive
+ * --------------------
+ * Compares a PACKET_RESYNC snapshot from the other board with this one,
+ * taking this player's score from it if it's ahead and sending again any
+ * ball the other board is still missing after RESYNC_STRIKES snapshots
+ *
+ * const packet_t *packet: The PACKET_RESYNC packet received
+ * game_state_t *game: State of this board, corrected in place
+ *
+ * Returns: 1 if anything was corrected, 0 if the boards agree
+*/
+int resync_receive(const packet_t *packet, game_state_t *game);
+
+#endif
@@ -0,0 +1,225 @@
+/** @file   ring.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module numbers the boards in a row of more than two and
+            works out how each one talks to its neighbours.
+*/
+
+
+#include "system.h"
+#include "packet.h"
+#include "ball.h"
+#include "ring.h"
+
+#define READY_POSITION_INDEX 0
+#define READY_BOARDS_INDEX 1
+#define READY_CONNECTED_INDEX 2 // True once the boards from the sender on are all numbered
+#define READY_PAYLOAD_SIZE 3
+
+
+static uint8_t boards; // Number of boards in the ring
+static uint8_t position; // Number of this board, RING_UNNUMBERED until it has one
+static uint8_t next_connected; // True once the boards after this one are all numbered
+
+
+/*
+ * Function: announce
+ * --------------------
+ * Tells both neighbours this board's number and whether the boards from
+ * it on are all numbered. Unaddressed, as the next board along may not
+ * know its number yet.
+ *
+*/
+static void announce(void)
+{
+    uint8_t payload[READY_PAYLOAD_SIZE];
+
+    payload[READY_POSITION_INDEX] = position;
+    payload[READY_BOARDS_INDEX] = boards;
+    payload[READY_CONNECTED_INDEX] = ring_connected();
+    packet_send_to(0, PACKET_READY, payload, READY_PAYLOAD_SIZE);
+}
+
+
+/*
+ * Function: ring_init
+ * --------------------
+ * Starts connecting a board to the others, unnumbered
+ *
+ * uint8_t new_boards: Number of boards in the ring, 2 for a game between two
+ * boards, which is always connected as board 0
+ *
+*/
+void ring_init(uint8_t new_boards)
+{
+    boards = new_boards;
+    position = boards > 2 ? RING_UNNUMBERED : 0;
+    next_connected = 0;
+    packet_address_set(0);
+}
+
+
+/*
+ * Function: ring_number
+ * --------------------
+ * Numbers this board and tells the next board along, which takes the
+ * number after it. Numbering board 0 again, if a packet was lost on the
+ * way, tells every board along again.
+ *
+ * uint8_t new_position: Number of this board, 0 for the board whose player
+ * pressed the navswitch
+ *
+*/
+void ring_number(uint8_t new_position)
+{
+    position = new_position;
+    packet_address_set(ring_address(ring_border_side()));
+    announce();
+}
+
+
+/*
+ * Function: ring_connect
+ * --------------------
+ * Takes a PACKET_READY from a neighbour, numbering this board if it
+ * isn't yet. Hearing the board before again, which isn't connected yet,
+ * this board tells both neighbours again; once the boards after this
+ * one are all numbered, it tells the board before.
+ *
+ * const packet_t *packet: Packet received
+ *
+*/
+void ring_connect(const packet_t *packet)
+{
+    uint8_t from;
+    uint8_t from_boards;
+
+    if (boards <= 2 || packet->type != PACKET_READY || packet->length != READY_PAYLOAD_SIZE) {
+        return;
+    }
+    from = packet->payload[READY_POSITION_INDEX];
+    from_boards = packet->payload[READY_BOARDS_INDEX];
+    if (position == RING_UNNUMBERED) {
+        // Only board 0's player needs to say how many boards there are
+        if (from_boards <= RING_BOARDS_MAX && from + 1 < from_boards) {
+            boards = from_boards;
+            ring_number(from + 1);
+        }
+    } else if (from + 1 == position) {
+        announce();
+    } else if (from == position + 1 && packet->payload[READY_CONNECTED_INDEX] && !next_connected) {
+        next_connected = 1;
+        announce();
+    }
+}
+
+
+/*
+ * Function: ring_connected
+ * --------------------
+ * Returns: an int, 1 once this board and every board after it are
+ * numbered, 0 otherwise
+*/
+int ring_connected(void)
+{
+    return (position != RING_UNNUMBERED && (next_connected || position == boards - 1));
+}
+
+
+/*
+ * Function: ring_position
+ * --------------------
+ * Returns: the number of this board, RING_UNNUMBERED until it has one
+*/
+uint8_t ring_position(void)
+{
+    return position;
+}
+
+
+/*
+ * Function: ring_boards
+ * --------------------
+ * Returns: the number of boards in the ring
+*/
+uint8_t ring_boards(void)
+{
+    return boards;
+}
+
+
+/*
+ * Function: ring_is_court
+ * --------------------
+ * Returns: an int, 1 if this board is between the players' boards, with
+ * no paddle, 0 if it is a player's
+*/
+int ring_is_court(void)
+{
+    return (position != 0 && position != boards - 1 && position != RING_UNNUMBERED);
+}
+
+
+/*
+ * Function: ring_border_side
+ * --------------------
+ * Returns: the side this board's border is on, RING_RIGHT for board 0
+ * and RING_LEFT for the rest
+*/
+uint8_t ring_border_side(void)
+{
+    return position == 0 ? RING_RIGHT : RING_LEFT;
+}
+
+
+/*
+ * Function: ring_side_of
+ * --------------------
+ * Finds which neighbour a packet came from
+ *
+ * const packet_t *packet: Packet received
+ *
+ * Returns: RING_LEFT or RING_RIGHT, RING_LEFT between two boards
+*/
+uint8_t ring_side_of(const packet_t *packet)
+{
+    return PACKET_SIDE_FROM(packet->address);
+}
+
+
+/*
+ * Function: ring_address
+ * --------------------
+ * Finds the address of the frames to a neighbour
+ *
+ * uint8_t side: RING_LEFT or RING_RIGHT
+ *
+ * Returns: the PACKET_ADDRESS() to send to the neighbour with, 0 between
+ * two boards
+*/
+uint8_t ring_address(uint8_t side)
+{
+    if (boards <= 2) {
+        return 0;
+    }
+    return PACKET_ADDRESS(position, side == RING_RIGHT ? position + 1 : position - 1);
+}
+
+
+/*
+ * Function: ring_handoff
+ * --------------------
+ * Finds how a ball is handed to a neighbour, see ball_pack_to()
+ *
+ * uint8_t side: RING_LEFT or RING_RIGHT
+ *
+ * Returns: BALL_FACING, BALL_BEHIND or BALL_AHEAD
+*/
+uint8_t ring_handoff(uint8_t side)
+{
+    // Only boards 0 and 1 face each other
+    if (boards <= 2 || position == 0 || (position == 1 && side == RING_LEFT)) {
+        return BALL_FACING;
+    }
+    return side == RING_RIGHT ? BALL_AHEAD : BALL_BEHIND;
+}
@@ -0,0 +1,176 @@
+/** @file   ring.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for playing across more than two
+            boards, set side by side in a row so their screens make one
+            long court. The boards are numbered from 0 along the row and
+            each one only talks to its neighbours, over IR. The players
+            are at the two ends; the boards between them have no paddle
+            and pass the ball on from one neighbour to the other, with
+            the scores, the same way the ends send it across the border.
+
+            Board 0's border faces board 1, as two boards face each other
+            now. Every other board faces the same way as the last one,
+            its border towards board 0, so a ball is only mirrored
+            between boards 0 and 1 and just moved along by a screen width
+            between the rest (see ball_pack_to()).
+
+            Each board is given its number as the boards connect: the
+            player at one end presses the navswitch down and becomes
+            board 0, and every other board takes the number after the
+            neighbour it hears from first. Word that the boards are all
+            numbered comes back from the last board, so board 0 is the
+            last to connect; if it doesn't, its player presses the
+            navswitch down again. With two boards none of this is used,
+            and the game plays as it always has.
+*/
+
+#ifndef RING_H
+#define RING_H
+
+#include "system.h"
+#include "packet.h"
+#include "geometry.h"
+
+#ifndef RING_BOARDS // Can be overridden to build for a longer court
+#define RING_BOARDS 2
+#endif
+// A board number fits a nibble of a PACKET_ADDRESS(), and a ball hit at
+// one end is sent the whole length of the court behind the border, in 8.8
+// fixed-point
+#if 127 / GRID_WIDTH < 16
+#define RING_BOARDS_MAX (127 / GRID_WIDTH)
+#else
+#define RING_BOARDS_MAX 16
+#endif
+#define RING_UNNUMBERED 0xFF // Position of a board still to be numbered
+
+// Sides of a board, as PACKET_SIDE_FROM() and PACKET_SIDE_TO() give them
+#define RING_LEFT 0 // Towards board 0
+#define RING_RIGHT 1 // Away from board 0
+
+#if RING_BOARDS < 2 || RING_BOARDS > RING_BOARDS_MAX
+#error "RING_BOARDS is not a number of boards a ring can have"
+#endif
+
+
+/*
+ * Function: ring_init
+ * --------------------
+ * Starts connecting a board to the others, unnumbered
+ *
+ * uint8_t new_boards: Number of boards in the ring, 2 for a game between two
+ * boards, which is always connected as board 0
+ *
+*/
+void ring_init(uint8_t new_boards);
+
+
+/*
+ * Function: ring_number
+ * --------------------
+ * Numbers this board and tells the next board along, which takes the
+ * number after it. Numbering board 0 again, if a packet was lost on the
+ * way, tells every board along again.
+ *
+ * uint8_t new_position: Number of this board, 0 for the board whose player
+ * pressed the navswitch
+ *
+*/
+void ring_number(uint8_t new_position);
+
+
+/*
+ * Function: ring_connect
+ * --------------------
+ * Takes a PACKET_READY from a neighbour, numbering this board if it
+ * isn't yet. Hearing the board before again, which isn't connected yet,
+ * this board tells both neighbours again; once the boards after this
+ * one are all numbered, it tells the board before.
+ *
+ * const packet_t *packet: Packet received
+ *
+*/
+void ring_connect(const packet_t *packet);
+
+
+/*
+ * Function: ring_connected
+ * --------------------
+ * Returns: an int, 1 once this board and every board after it are
+ * numbered, 0 otherwise
+*/
+int ring_connected(void);
+
+
+/*
+ * Function: ring_position
+ * --------------------
+ * Returns: the number of this board, RING_UNNUMBERED until it has one
+*/
+uint8_t ring_position(void);
+
+
+/*
+ * Function: ring_boards
+ * --------------------
+ * Returns: the number of boards in the ring
+*/
+uint8_t ring_boards(void);
+
+
+/*
+ * Function: ring_is_court
+ * --------------------
+ * Returns: an int, 1 if this board is between the players' boards, with
+ * no paddle, 0 if it is a player's
+*/
+int ring_is_court(void);
+
+
+/*
+ * Function: ring_border_side
+ * --------------------
+ * Returns: the side this board's border is on, RING_RIGHT for board 0
+ * and RING_LEFT for the rest
+*/
+uint8_t ring_border_side(void);
+
+
+/*
+ * Function: ring_side_of
+ * --------------------
+ * Finds which neighbour a packet came from
+ *
+ * const packet_t *packet: Packet received
+ *
+ * Returns: RING_LEFT or RING_RIGHT, RING_LEFT between two boards
+*/
+uint8_t ring_side_of(const packet_t *packet);
+
+
+/*
+ * Function: ring_address
+ * --------------------
+ * Finds the address of the frames to a neighbour
+ *
+ * uint8_t side: RING_LEFT or RING_RIGHT
+ *
+ * Returns: the PACKET_ADDRESS() to send to the neighbour with, 0 between
+ * two boards
+*/
+uint8_t ring_address(uint8_t side);
+
+
+/*
+ * Function: ring_handoff
+ * --------------------
+ * Finds how a ball is handed to a neighbour, see ball_pack_to()
+ *
+ * uint8_t side: RING_LEFT or RING_RIGHT
+ *
+ * Returns: BALL_FACING, BALL_BEHIND or BALL_AHEAD
+*/
+uint8_t ring_handoff(uint8_t side);
+
+#endif
@@ -0,0 +1,270 @@
+/** @file   sched.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module handles running the tasks of the pong game,
+            sleeping whenever none of them are due.
+*/
+
+
+#include "system.h"
+#include "timer.h"
+#include "hal.h"
+#include "probe.h"
+#include "sched.h"
+
+
+#define SCHED_MAX_SLEEP INT16_MAX // Longest sleep when only events are waited on
+
+
+static volatile uint8_t pending_events; // Events posted and not yet handled
+static uint8_t stopping; // True once sched_stop() has been called
+static sched_stats_t run_stats; // How the CPU has spent its time
+static sched_task_t *interrupt_task; // Task run from the timer interrupt, if any
+
+
+/*
+ * Function: is_due
+ * --------------------
+ * Determines whether a tick has been reached, allowing for the timer
+ * wrapping around
+ *
+ * Returns: an int, 1 if when is now or in the past, 0 otherwise
+*/
+static int is_due(sched_tick_t when, sched_tick_t now)
+{
+    return (int16_t) (now - when) >= 0;
+}
+
+
+/*
+ * Function: take_events
+ * --------------------
+ * Takes the events posted so far, leaving none pending
+ *
+ * Returns: a bitmask of the events posted
+*/
+static uint8_t take_events(void)
+{
+    uint8_t state = hal_interrupts_disable();
+    uint8_t events = pending_events;
+
+    pending_events = 0;
+    hal_interrupts_restore(state);
+    return events;
+}
+
+
+/*
+ * Function: next_task
+ * --------------------
+ * Picks the task to run next: of those that are due or have been woken
+ * by an event, the one with the highest priority, the first of them in
+ * the array if several have it. Its next periodic call is scheduled.
+ *
+ * sched_task_t *tasks: Array of tasks to pick from
+ * uint8_t num_tasks: Number of tasks in the array
+ *
+ * Returns: the task, or 0 if none are ready to run
+*/
+static sched_task_t *next_task(sched_task_t *tasks, uint8_t num_tasks)
+{
+    uint8_t events = take_events();
+    sched_tick_t now = hal_timer_get();
+    sched_task_t *next = 0;
+    sched_task_t *task;
+
+    for (task = tasks; task < tasks + num_tasks; task++) {
+        if (task->suspended || task->priority == SCHED_PRIORITY_INTERRUPT) {
+            continue;
+        }
+        if (task->events & events) {
+            task->woken = 1;
+        }
+        if ((task->woken || (task->period && is_due(task->reschedule, now)))
+            && (!next || task->priority > next->priority)) {
+            next = task;
+        }
+    }
+    if (next && next->period && is_due(next->reschedule, now)) {
+        next->reschedule += next->period;
+        // Don't try to catch up on calls missed by a long overrun
+        if (is_due(next->reschedule, now)) {
+            next->reschedule = now + next->period;
+        }
+    }
+    return next;
+}
+
+
+/*
+ * Function: sched_run
+ * --------------------
+ * Runs the tasks forever: each periodic task when its period is up and
+ * each task straight away when one of its events is posted, sleeping in
+ * between, and any SCHED_PRIORITY_INTERRUPT task from the timer
+ * interrupt. Only returns after sched_stop().
+ *
+ * sched_task_t *tasks: Array of tasks to run
+ * uint8_t num_tasks: Number of tasks in the array
+ *
+*/
+void sched_run(sched_task_t *tasks, uint8_t num_tasks)
+{
+    sched_tick_t now;
+    sched_tick_t last;
+    sched_tick_t next;
+    sched_task_t *task;
+    uint8_t has_next;
+    uint8_t i;
+
+    timer_init();
+    now = last = hal_timer_get();
+    interrupt_task = 0;
+    for (i = 0; i < num_tasks; i++) {
+        tasks[i].reschedule = now;
+        tasks[i].woken = 0;
+        if (tasks[i].priority == SCHED_PRIORITY_INTERRUPT) {
+            interrupt_task = &tasks[i];
+        }
+    }
+    if (interrupt_task) {
+        hal_tick_interrupt_enable(interrupt_task->period);
+    }
+
+    stopping = 0;
+    while (!stopping) {
+        // Looking the tasks over again after each one runs, so a task
+        // only ever waits for the one running when it became due
+        while (!stopping && (task = next_task(tasks, num_tasks))) {
+            task->woken = 0;
+            task->func(task->data);
+            run_stats.runs++;
+        }
+
+        // Sleep until the earliest deadline, or an interrupt
+        has_next = 0;
+        next = 0;
+        now = hal_timer_get();
+        for (i = 0; i < num_tasks; i++) {
+            task = &tasks[i];
+            if (!task->suspended && task->period && task->priority != SCHED_PRIORITY_INTERRUPT
+                && (!has_next || (int16_t) (task->reschedule - next) < 0)) {
+                next = task->reschedule;
+                has_next = 1;
+            }
+        }
+        run_stats.ticks += (sched_tick_t) (now - last);
+        last = now;
+        if (!stopping && !pending_events && (!has_next || !is_due(next, now))) {
+            hal_sleep_until(has_next ? next : now + SCHED_MAX_SLEEP, &pending_events);
+            now = hal_timer_get();
+            run_stats.sleeps++;
+            run_stats.idle_ticks += (sched_tick_t) (now - last);
+            run_stats.ticks += (sched_tick_t) (now - last);
+            last = now;
+            if (has_next && !is_due(next, now)) {
+                run_stats.early_wakes++;
+            }
+        }
+    }
+    hal_tick_interrupt_disable();
+}
+
+
+/*
+ * Function: sched_task_suspend
+ * --------------------
+ * Stops a task being run until sched_task_resume(), so the CPU isn't
+ * woken for a task with nothing to do
+ *
+*/
+void sched_task_suspend(sched_task_t *task)
+{
+    task->suspended = 1;
+}
+
+
+/*
+ * Function: sched_task_resume
+ * --------------------
+ * Resumes a suspended task, which is run straight away
+ *
+*/
+void sched_task_resume(sched_task_t *task)
+{
+    if (task->suspended) {
+        task->suspended = 0;
+        task->reschedule = hal_timer_get();
+    }
+}
+
+
+/*
+ * Function: sched_event_post
+ * --------------------
+ * Posts events, waking the scheduler to run the tasks waiting for them.
+ * Safe to call from interrupts.
+ *
+ * uint8_t events: Bitmask of SCHED_EVENT_* events
+ *
+*/
+void sched_event_post(uint8_t events)
+{
+    uint8_t state = hal_interrupts_disable();
+
+    pending_events |= events;
+    hal_interrupts_restore(state);
+}
+
+
+/*
+ * Function: sched_tick_isr
+ * --------------------
+ * Runs the SCHED_PRIORITY_INTERRUPT task, unless it is suspended, and
+ * records how late it is. Called from the timer interrupt, see
+ * hal_tick_interrupt_enable().
+ *
+ * sched_tick_t due: Tick the interrupt was due at
+ *
+*/
+void sched_tick_isr(sched_tick_t due)
+{
+    sched_task_t *task = interrupt_task;
+
+    if (!task || task->suspended) {
+        return;
+    }
+    PROBE_RECORD(PROBE_REFRESH_JITTER, (sched_tick_t) (hal_timer_get() - due));
+    task->func(task->data);
+    run_stats.interrupt_runs++;
+}
+
+
+/*
+ * Function: sched_stop
+ * --------------------
+ * Makes sched_run() return once the task currently running finishes
+ *
+*/
+void sched_stop(void)
+{
+    stopping = 1;
+}
+
+
+/*
+ * Function: sched_stats_get
+ * --------------------
+ * Gets how the CPU has spent its time, from which the duty cycle is
+ * 1 - idle_ticks / ticks
+ *
+ * sched_stats_t *stats: Filled in with the statistics
+ *
+*/
+void sched_stats_get(sched_stats_t *stats)
+{
+    uint8_t state = hal_interrupts_disable();
+
+    *stats = run_stats;
+    hal_interrupts_restore(state);
+}
@@ -0,0 +1,144 @@
+/** @file   sched.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for the task scheduler of the pong
+            game. Between deadlines the CPU sleeps instead of spinning,
+            waking for the next deadline or any interrupt, and tasks
+            can be suspended while they have nothing to do or woken
+            early by events posted from interrupts.
+
+            When several tasks are due the one with the highest priority
+            runs first, and the tasks are looked over again after each
+            one, so an important task only ever waits for the one task
+            already running. One task can instead be run from a timer
+            interrupt at a fixed period, preempting all the others: the
+            display refresh, which would flicker if it waited behind a
+            slow game update. How late each of its runs is, its jitter,
+            is kept by the PROBE_REFRESH_JITTER probe.
+*/
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "system.h"
+#include "timer.h"
+
+#define SCHED_RATE TIMER_RATE
+
+// Events posted from interrupts
+#define SCHED_EVENT_IR_RX BIT(0) // IR byte received
+#define SCHED_EVENT_INPUT BIT(1) // Navswitch pushed or released
+
+// Task priorities, higher run first
+#define SCHED_PRIORITY_NORMAL 0
+#define SCHED_PRIORITY_HIGH 1
+#define SCHED_PRIORITY_INTERRUPT 2 // Run from the timer interrupt, at most one task
+
+
+typedef timer_tick_t sched_tick_t;
+
+typedef void (* sched_func_t)(void *data);
+
+typedef struct sched_task_struct
+{
+    sched_func_t func; // Function to call
+    void *data; // Data to pass to func
+    sched_tick_t period; // Ticks between calls, 0 to only run on events
+    uint8_t events; // Events that run the task straight away
+    uint8_t priority; // SCHED_PRIORITY_*, which of the tasks due runs first
+    uint8_t suspended; // True if the task isn't run at all
+    uint8_t woken; // True once one of its events has been posted, until it runs
+    sched_tick_t reschedule; // Tick of the next periodic call
+} sched_task_t;
+
+typedef struct sched_stats_struct
+{
+    uint32_t ticks; // Ticks since the scheduler started
+    uint32_t idle_ticks; // Ticks spent asleep
+    uint32_t runs; // Number of task calls, not counting those from the timer interrupt
+    uint32_t interrupt_runs; // Number of calls of the task run from the timer interrupt
+    uint32_t sleeps; // Number of times the CPU went to sleep
+    uint32_t early_wakes; // Sleeps ended by an interrupt before the deadline
+} sched_stats_t;
+
+
+/*
+ * Function: sched_run
+ * --------------------
+ * Runs the tasks forever: each periodic task when its period is up and
+ * each task straight away when one of its events is posted, sleeping in
+ * between, and any SCHED_PRIORITY_INTERRUPT task from the timer
+ * interrupt. Only returns after sched_stop().
+ *
+ * sched_task_t *tasks: Array of tasks to run
+ * uint8_t num_tasks: Number of tasks in the array
+ *
+*/
+void sched_run(sched_task_t *tasks, uint8_t num_tasks);
+
+
+/*
+ * Function: sched_task_suspend
+ * --------------------
+ * Stops a task being run until sched_task_resume(), so the CPU isn't
+ * woken for a task with nothing to do
+ *
+*/
+void sched_task_suspend(sched_task_t *task);
+
+
+/*
+ * Function: sched_task_resume
+ * --------------------
+ * Resumes a suspended task, which is run straight away
+ *
+*/
+void sched_task_resume(sched_task_t *task);
+
+
+/*
+ * Function: sched_event_post
+ * --------------------
+ * Posts events, waking the scheduler to run the tasks waiting for them.
+ * Safe to call from interrupts.
+ *
+ * uint8_t events: Bitmask of SCHED_EVENT_* events
+ *
+*/
+void sched_event_post(uint8_t events);
+
+
+/*
+ * Function: sched_tick_isr
+ * --------------------
+ * Runs the SCHED_PRIORITY_INTERRUPT task, unless it is suspended, and
+ * records how late it is. Called from the timer interrupt, see
+ * hal_tick_interrupt_enable().
+ *
+ * sched_tick_t due: Tick the interrupt was due at
+ *
+*/
+void sched_tick_isr(sched_tick_t due);
+
+
+/*
+ * Function: sched_stop
+ * --------------------
+ * Makes sched_run() return once the task currently running finishes
+ *
+*/
+void sched_stop(void);
+
+
+/*
+ * Function: sched_stats_get
+ * --------------------
+ * Gets how the CPU has spent its time, from which the duty cycle is
+ * 1 - idle_ticks / ticks
+ *
+ * sched_stats_t *stats: Filled in with the statistics
+ *
+*/
+void sched_stats_get(sched_stats_t *stats);
+
+#endif
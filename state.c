@@ -0,0 +1,57 @@
+/** @file   state.c
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This module packs and unpacks snapshots of the state of the
+            pong game.
+*/
+
+
+#include "system.h"
+#include "state.h"
+
+
+/*
+ * Function: state_pack
+ * --------------------
+ * Packs a snapshot into bytes, the same on any compiler whatever order
+ * it gives the fields in
+ *
+ * const game_state_t *state: Snapshot to pack
+ * uint8_t *bytes: Filled in with STATE_SIZE bytes
+ *
+*/
+void state_pack(const game_state_t *state, uint8_t *bytes)
+{
+    bytes[0] = state->phase | state->this_score << 2 | state->their_score << 5;
+    bytes[1] = state->ball_visible | state->ball_incoming << 4;
+    bytes[2] = state->just_scored | state->paddle_bottom << 5;
+    bytes[3] = state->player_num | state->cpu_opponent << 1;
+}
+
+
+/*
+ * Function: state_unpack
+ * --------------------
+ * Unpacks a snapshot packed by state_pack()
+ *
+ * const uint8_t *bytes: STATE_SIZE bytes to unpack
+ * game_state_t *state: Filled in with the snapshot
+ *
+ * Returns: 1 if the bytes hold a snapshot, 0 if they can't
+*/
+int state_unpack(const uint8_t *bytes, game_state_t *state)
+{
+    if ((bytes[0] & 0b11) > END_STATE || bytes[3] >> 2) {
+        return 0;
+    }
+    state->phase = bytes[0] & 0b11;
+    state->this_score = bytes[0] >> 2;
+    state->their_score = bytes[0] >> 5;
+    state->ball_visible = bytes[1];
+    state->ball_incoming = bytes[1] >> 4;
+    state->just_scored = bytes[2];
+    state->paddle_bottom = bytes[2] >> 5;
+    state->player_num = bytes[3];
+    state->cpu_opponent = bytes[3] >> 1;
+    return 1;
+}
@@ -0,0 +1,71 @@
+/** @file   state.h
+    @author Kye Oldham (kno42) and Jack Ryan (jwr87) of ENCE260 Group 535
+    @date   13 October 2020
+    @brief  This is the interface for the packed state of the pong game:
+            the phase of the game, the scores, which balls are on which
+            screen and the paddle, in four bytes. game.c keeps the live
+            state in one of these, and a copy of it is a snapshot of the
+            whole game that can be stored or sent over IR in one packet
+            (see resync.h). The balls' trajectories are not part of it; they
+            are sent in their own packets as the balls change screen.
+*/
+
+#ifndef STATE_H
+#define STATE_H
+
+#include "system.h"
+
+#define STATE_SIZE 4 // Bytes in a packed snapshot
+#define STATE_SCORE_MAX 7 // Highest score the fields can hold
+#define STATE_BALLS 4 // Balls the ball bitmasks can hold
+#define STATE_FLASH_MAX 31 // Most updates LED1 can be left to flash for
+
+// Phases of the game
+#define INITIALIZATION_STATE 0
+#define PLAYING_STATE 1
+#define END_STATE 2
+
+// Letters for the phases, for traces
+#define STATE_PHASE_NAMES "IPE"
+
+
+typedef struct game_state_struct
+{
+    uint8_t phase : 2; // INITIALIZATION_STATE, PLAYING_STATE or END_STATE
+    uint8_t this_score : 3; // Score of this player
+    uint8_t their_score : 3; // Score of the other player
+    uint8_t ball_visible : 4; // Balls on this screen, BIT(id) for each
+    uint8_t ball_incoming : 4; // Balls on their way from the other screen
+    uint8_t just_scored : 5; // Game updates left to flash LED1 after a score
+    uint8_t paddle_bottom : 3; // Row of the bottom of the paddle, see game_state_get()
+    uint8_t player_num : 1; // 1 if this player started the game
+    uint8_t cpu_opponent : 1; // True if playing against the computer
+} game_state_t;
+
+
+/*
+ * Function: state_pack
+ * --------------------
+ * Packs a snapshot into bytes, the same on any compiler whatever order
+ * it gives the fields in
+ *
+ * const game_state_t *state: Snapshot to pack
+ * uint8_t *bytes: Filled in with STATE_SIZE bytes
+ *
+*/
+void state_pack(const game_state_t *state, uint8_t *bytes);
+
+
+/*
+ * Function: state_unpack
+ * --------------------
+ * Unpacks a snapshot packed by state_pack()
+ *
+ * const uint8_t *bytes: STATE_SIZE bytes to unpack
+ * game_state_t *state: Filled in with the snapshot
+ *
+ * Returns: 1 if the bytes hold a snapshot, 0 if they can't
+*/
+int state_unpack(const uint8_t *bytes, game_state_t *state);
+
+#endif